@@ -0,0 +1,64 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Arena.hpp"
+#include "Intersect.hpp"
+#include "MatrixImpl.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <vector>
+
+using namespace raytracer;
+
+namespace {
+    constexpr int rays{100000};
+
+    // what a ray does with an intersection list: a few hits pushed, the nearest kept
+    template<typename List>
+    float nearest_hit(List &hits, const int ray) {
+        for (int i = 0; i < 4; ++i) {
+            hits.push_back(static_cast<float>((ray * 7 + i * 13) % 29));
+        }
+        float nearest{hits[0]};
+        for (const float t: hits) {
+            nearest = std::min(nearest, t);
+        }
+        return nearest;
+    }
+}
+
+TEST_CASE("Per-ray transient allocations", "[arena]") {
+    BENCHMARK("100k intersection lists, std::vector") {
+        float sum{0};
+        for (int ray = 0; ray < rays; ++ray) {
+            std::vector<float> hits;
+            sum += nearest_hit(hits, ray);
+        }
+        return sum;
+    };
+
+    BENCHMARK("100k intersection lists, thread arena reset every 256 rays") {
+        Arena &arena{thread_arena()};
+        float sum{0};
+        for (int tile = 0; tile < rays; tile += 256) {
+            const ArenaScope scope{arena};
+            for (int ray = tile; ray < std::min(tile + 256, rays); ++ray) {
+                std::pmr::vector<float> hits{&arena};
+                sum += nearest_hit(hits, ray);
+            }
+        }
+        return sum;
+    };
+
+    const Container<double> matrix{multiply(translation(1.0, 2.0, 3.0), scale(2.0, 2.0, 2.0))};
+    BENCHMARK("100k ray transforms by a Container") {
+        float sum{0};
+        for (int ray = 0; ray < rays; ++ray) {
+            sum += transform(Ray{Point(0, 0, static_cast<float>(ray)), Vector{0, 0, 1}}, matrix).origin.z;
+        }
+        return sum;
+    };
+}
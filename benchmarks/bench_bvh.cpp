@@ -0,0 +1,102 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Bvh.hpp"
+#include "CompiledScene.hpp"
+#include "DynamicScene.hpp"
+#include "MatrixImpl.hpp"
+#include "SceneGenerator.hpp"
+#include "SceneGraph.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <print>
+#include <string>
+
+using namespace raytracer;
+
+namespace {
+    // Build time against tree quality for a million spheres: fewer bins build faster and give a higher SAH cost,
+    // which costs traversal time on every ray instead.
+    void bench_build(const Distribution distribution, const char *label) {
+        const CompiledScene scene{CompiledScene::compile(generate_scene({
+            .count = 1'000'000, .seed = 3, .distribution = distribution, .extent = 100
+        }).value())};
+        ThreadPool serial{{.threads = 0}};
+        for (const uint32_t bins: {4u, 16u, 32u}) {
+            const BvhStats stats{build_bvh(scene.bounds(), {.bins = bins}).stats};
+            std::println("{} {} bins: SAH cost {:.2f}, depth {}, {} leaves", label, bins, stats.sah_cost, stats.depth,
+                         stats.leaf_count);
+            const std::string name{std::string{label} + " 1M spheres, " + std::to_string(bins) + " bins"};
+            BENCHMARK(name + ", shared pool") {
+                return build_bvh(scene.bounds(), {.bins = bins}).nodes.size();
+            };
+            BENCHMARK(name + ", one thread") {
+                return build_bvh(scene.bounds(), {.pool = &serial, .bins = bins}).nodes.size();
+            };
+        }
+    }
+}
+
+TEST_CASE("BVH build", "[bvh]") {
+    bench_build(Distribution::uniform, "uniform");
+    bench_build(Distribution::clustered, "clustered");
+}
+
+// A frame of animation in which a small share of 100k spheres moves: refitting the top level costs in proportion to
+// what moved, while rebuilding or recompiling costs the same however little did.
+TEST_CASE("BVH refit", "[bvh]") {
+    DynamicScene scene{generate_scene({.count = 100'000, .seed = 3, .extent = 100}).value()};
+    for (const size_t step: {1000u, 100u, 10u}) {
+        // alternate directions so the spheres stay where the tree was built
+        double offset{0.5};
+        const auto move = [&scene, &offset, step] {
+            for (size_t i = 0; i < scene.object_count(); i += step) {
+                scene.set_transform(i, multiply(translation(offset, 0.0, 0.0), scene.object(i).transform));
+            }
+            offset = -offset;
+        };
+        const std::string name{"100k spheres, " + std::to_string(scene.object_count() / step) + " moved"};
+        BENCHMARK(name + ", refit") {
+            move();
+            return scene.update().nodes_refit;
+        };
+        BENCHMARK(name + ", rebuild") {
+            move();
+            scene.rebuild();
+            return scene.bvh_nodes().size();
+        };
+        BENCHMARK(name + ", compile") {
+            move();
+            return CompiledScene::compile(scene.scene()).object_count();
+        };
+    }
+}
+
+// Ten thousand of 100k spheres moved together: as a group, the move is one transform and update() places each sphere
+// from cached inverses; one by one, each sphere's transform is multiplied out and inverted again.
+TEST_CASE("Group move", "[bvh]") {
+    DynamicScene scene{generate_scene({.count = 100'000, .seed = 3, .extent = 100}).value()};
+    const uint32_t group{scene.groups().add_group(SceneGraph::root).value()};
+    for (size_t i = 0; i < scene.object_count(); i += 10) {
+        scene.attach(i, group);
+    }
+    scene.update();
+    DynamicScene flat{generate_scene({.count = 100'000, .seed = 3, .extent = 100}).value()};
+    float offset{0.5f};
+    BENCHMARK("10k of 100k spheres, group transform") {
+        offset = -offset;
+        scene.groups().set_transform(group, Matrix4::from(translation(static_cast<double>(offset), 0.0, 0.0)));
+        return scene.update().nodes_refit;
+    };
+    BENCHMARK("10k of 100k spheres, each transform") {
+        offset = -offset;
+        for (size_t i = 0; i < flat.object_count(); i += 10) {
+            const Container<double> move{translation(static_cast<double>(offset), 0.0, 0.0)};
+            flat.set_transform(i, multiply(move, flat.object(i).transform));
+        }
+        return flat.update().nodes_refit;
+    };
+}
@@ -0,0 +1,78 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "ImageCodecs.hpp"
+#include "ThreadPool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+
+using namespace raytracer;
+
+namespace {
+    // what a tile renderer does: the pool hands out 16x16 tiles and every pixel in them is shaded
+    template<bool through_tile_span>
+    void render_tiles(Canvas &canvas) {
+        ThreadPool::shared().parallel_for(
+            Range2D{0, canvas.width, 0, canvas.height}, Canvas::tile_size, Canvas::tile_size, [&](const Range2D &tile) {
+                if constexpr (through_tile_span) {
+                    // write the tile's own bytes in order, skipping the per-pixel offset calculation
+                    const uint32_t tile_w{tile.x_begin / Canvas::tile_size};
+                    uint8_t *out{canvas.tile(tile_w, tile.y_begin / Canvas::tile_size).data()};
+                    for (uint32_t y = tile.y_begin; y < tile.y_begin + Canvas::tile_size; ++y) {
+                        for (uint32_t x = tile.x_begin; x < tile.x_begin + Canvas::tile_size; ++x) {
+                            out[0] = to_byte(static_cast<float>(x) / static_cast<float>(canvas.width));
+                            out[1] = to_byte(static_cast<float>(y) / static_cast<float>(canvas.height));
+                            out[2] = to_byte(0.5f);
+                            out += Canvas::channels;
+                        }
+                    }
+                    return;
+                }
+                for (uint32_t y = tile.y_begin; y < tile.y_end; ++y) {
+                    for (uint32_t x = tile.x_begin; x < tile.x_end; ++x) {
+                        canvas.write_pixel(x, y, Colour{
+                                               static_cast<float>(x) / static_cast<float>(canvas.width),
+                                               static_cast<float>(y) / static_cast<float>(canvas.height), 0.5f
+                                           });
+                    }
+                }
+            });
+    }
+
+    void bench_layouts(const uint32_t width, const uint32_t height, const char *label) {
+        Canvas linear{width, height};
+        Canvas tiled{width, height, PixelLayout::tiled};
+
+        BENCHMARK(std::string{"parallel tile writes, linear "} + label) {
+            render_tiles<false>(linear);
+            return linear.storage[0];
+        };
+        BENCHMARK(std::string{"parallel tile writes, tiled "} + label) {
+            render_tiles<false>(tiled);
+            return tiled.storage[0];
+        };
+        BENCHMARK(std::string{"parallel tile writes, tiled through tile spans "} + label) {
+            render_tiles<true>(tiled);
+            return tiled.storage[0];
+        };
+        BENCHMARK(std::string{"linearise tiled "} + label) {
+            return convert_layout(tiled, PixelLayout::linear).storage[0];
+        };
+        BENCHMARK(std::string{"encode QOI, linear "} + label) {
+            return encode_qoi(linear).size();
+        };
+        BENCHMARK(std::string{"encode QOI, tiled "} + label) {
+            return encode_qoi(tiled).size();
+        };
+    }
+}
+
+TEST_CASE("Canvas layouts", "[canvas]") {
+    bench_layouts(3840, 2160, "4K");
+    bench_layouts(7680, 4320, "8K");
+}
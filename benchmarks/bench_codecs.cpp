@@ -0,0 +1,79 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "ImageCodecs.hpp"
+#include "ImageDiff.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <filesystem>
+
+using namespace raytracer;
+
+namespace {
+    // a shaded disc on a black background, roughly what the simulations produce
+    Canvas disc_image(const uint32_t width, const uint32_t height) {
+        Canvas canvas{width, height};
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                const float dx{(static_cast<float>(x) - width / 2.0f) / (height / 2.5f)};
+                const float dy{(static_cast<float>(y) - height / 2.0f) / (height / 2.5f)};
+                const float d{dx * dx + dy * dy};
+                canvas.write_pixel(x, y, d < 1 ? Colour{0.9f * (1 - d) + 0.1f, 0.2f * (1 - d), 0.9f * (1 - d) + 0.1f}
+                                              : Colour{0, 0, 0});
+            }
+        }
+        return canvas;
+    }
+}
+
+TEST_CASE("Image encoders", "[codecs]") {
+    const Canvas canvas{disc_image(1920, 1080)};
+    const auto path{std::filesystem::temp_directory_path() / "raytracer_bench.ppm"};
+
+    ThreadPool serial{{.threads = 0}};
+    BENCHMARK("P3 PPM 1080p") {
+        return canvas_to_ppm(canvas, path.string()).has_value();
+    };
+    BENCHMARK("P6 PPM 1080p") {
+        return canvas_to_ppm(canvas, path.string(), PpmFormat::binary).has_value();
+    };
+    BENCHMARK("PNG 1080p, one thread") {
+        return encode_png(canvas, {.pool = &serial}).size();
+    };
+    BENCHMARK("PNG 1080p, all threads") {
+        return encode_png(canvas).size();
+    };
+    BENCHMARK("QOI 1080p, one thread") {
+        return encode_qoi(canvas, {.pool = &serial}).size();
+    };
+    BENCHMARK("QOI 1080p, all threads") {
+        return encode_qoi(canvas).size();
+    };
+}
+
+TEST_CASE("Reading and comparing images", "[diff]") {
+    const Canvas expected{disc_image(3840, 2160)};
+    Canvas actual{expected};
+    actual.write_pixel(100, 100, Colour{1, 1, 1});
+    const auto ascii_path{std::filesystem::temp_directory_path() / "raytracer_bench_p3.ppm"};
+    const auto binary_path{std::filesystem::temp_directory_path() / "raytracer_bench_p6.ppm"};
+    REQUIRE(canvas_to_ppm(expected, ascii_path.string()).has_value());
+    REQUIRE(canvas_to_ppm(expected, binary_path.string(), PpmFormat::binary).has_value());
+
+    BENCHMARK("read P3 4K") {
+        return ppm_to_canvas(ascii_path.string()).has_value();
+    };
+    BENCHMARK("read P6 4K") {
+        return ppm_to_canvas(binary_path.string()).has_value();
+    };
+    BENCHMARK("compare 4K") {
+        return compare(expected, actual)->max_abs_error;
+    };
+    BENCHMARK("diff image 4K") {
+        return diff_image(expected, actual, 8)->width;
+    };
+}
@@ -0,0 +1,52 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "Framebuffer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+using namespace raytracer;
+
+namespace {
+    template<typename Sink>
+    void fill_gradient(const uint32_t width, const uint32_t height, Sink &&sink) {
+        for (uint32_t h = 0; h < height; ++h) {
+            for (uint32_t w = 0; w < width; ++w) {
+                sink(w, h, Colour{
+                         static_cast<float>(w) / static_cast<float>(width),
+                         static_cast<float>(h) / static_cast<float>(height),
+                         0.5f
+                     });
+            }
+        }
+    }
+
+    void bench_frame(const uint32_t width, const uint32_t height, const char *label) {
+        Canvas canvas{width, height};
+        AccumulationBuffer buffer{width, height};
+        fill_gradient(width, height, [&](auto w, auto h, const Colour &c) { buffer.add_sample(w, h, c); });
+
+        BENCHMARK(std::string{"write_pixel per sample "} + label) {
+            fill_gradient(width, height, [&](auto w, auto h, const Colour &c) { canvas.write_pixel(w, h, c); });
+            return canvas.storage[0];
+        };
+        BENCHMARK(std::string{"add_sample "} + label) {
+            fill_gradient(width, height, [&](auto w, auto h, const Colour &c) { buffer.add_sample(w, h, c); });
+            return buffer.samples[0];
+        };
+        BENCHMARK(std::string{"resolve linear "} + label) {
+            return resolve(buffer, ToneMap{.transfer = TransferFunction::linear}, canvas).has_value();
+        };
+        BENCHMARK(std::string{"resolve sRGB "} + label) {
+            return resolve(buffer, ToneMap{}, canvas).has_value();
+        };
+    }
+}
+
+TEST_CASE("Framebuffer resolve", "[framebuffer]") {
+    bench_frame(3840, 2160, "4K");
+    bench_frame(7680, 4320, "8K");
+}
@@ -0,0 +1,79 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "CompiledScene.hpp"
+#include "InstancedScene.hpp"
+#include "Mesh.hpp"
+#include "ObjLoader.hpp"
+#include "Render.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cmath>
+#include <numbers>
+#include <print>
+#include <string>
+
+using namespace raytracer;
+
+namespace {
+    // a size by size grid of quads in the z = 0 plane over [-1, 1], written as OBJ text
+    std::string grid_obj(const uint32_t size) {
+        std::string text;
+        text.reserve(size_t{size} * size * 48);
+        for (uint32_t y = 0; y <= size; ++y) {
+            for (uint32_t x = 0; x <= size; ++x) {
+                text += "v " + std::to_string(2.0 * x / size - 1) + " " + std::to_string(2.0 * y / size - 1) +
+                        " 0\n";
+            }
+        }
+        const uint32_t row{size + 1};
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                const uint32_t corner{y * row + x + 1};
+                text += "f " + std::to_string(corner) + " " + std::to_string(corner + 1) + " " +
+                        std::to_string(corner + row + 1) + " " + std::to_string(corner + row) + "\n";
+            }
+        }
+        return text;
+    }
+}
+
+// Two million triangles of OBJ text parsed in chunks on the shared pool against the same chunks on one thread.
+TEST_CASE("OBJ loading", "[mesh]") {
+    const std::string text{grid_obj(1000)};
+    ThreadPool serial{{.threads = 0}};
+    std::println("{} MB of OBJ text, {} triangles", text.size() >> 20, parse_obj(text)->triangle_count());
+    BENCHMARK("2M triangles, shared pool") {
+        return parse_obj(text)->triangle_count();
+    };
+    BENCHMARK("2M triangles, one thread") {
+        return parse_obj(text, {.pool = &serial})->triangle_count();
+    };
+}
+
+// The grid as one mesh filling the view: the tree over its triangles against testing all of them a block at a time.
+TEST_CASE("Mesh rendering", "[mesh]") {
+    const Mesh grid{parse_obj(grid_obj(300)).value()};
+    const MeshBvh bvh{build_mesh_bvh(grid)};
+    const Ray ray{Point{0.1f, 0.2f, -5}, Vector{0, 0, 1}};
+    std::println("{} triangles, {} nodes", grid.triangle_count(), bvh.bvh.nodes.size());
+    BENCHMARK("180k triangles, one ray through the tree") {
+        return nearest_triangle(bvh.bvh.nodes, bvh.columns(), ray, INFINITY).t;
+    };
+    BENCHMARK("180k triangles, one ray against every triangle") {
+        return hit(intersect(grid, ray))->t;
+    };
+
+    InstancedScene scene;
+    scene.camera = Camera{320, 240, std::numbers::pi / 3};
+    scene.camera.set_transform(view_transform(Point{0, 0, -2}, Point{0, 0, 0}, Vector{0, 1, 0}));
+    scene.lights.push_back(PointLight{Point{-10, 10, -10}, Colour{1, 1, 1}});
+    scene.add_instance(scene.add_mesh(grid), scene.add_transform(Matrix4{}), Material{});
+    const CompiledScene compiled{CompiledScene::compile(scene)};
+    BENCHMARK("180k triangles, 320x240 render") {
+        return render(compiled).storage.size();
+    };
+}
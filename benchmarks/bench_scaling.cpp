@@ -0,0 +1,36 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "CompiledScene.hpp"
+#include "Render.hpp"
+#include "SceneGenerator.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+
+using namespace raytracer;
+
+namespace {
+    // Render time against object count for one distribution, quadrupling the count each step. Through the BVH each
+    // step should add roughly the same time for scattered spheres; overlapping ones are the worst case, since every
+    // ray has to test most of them whatever the tree.
+    void bench_scaling(const Distribution distribution, const char *label) {
+        for (uint32_t count = 64; count <= 65536; count *= 4) {
+            const CompiledScene scene{CompiledScene::compile(generate_scene({
+                .count = count, .seed = 7, .distribution = distribution, .width = 64, .height = 48
+            }).value())};
+            BENCHMARK(std::string{"render "} + label + " " + std::to_string(count) + " spheres") {
+                return render(scene).storage[0];
+            };
+        }
+    }
+}
+
+TEST_CASE("Render time versus object count", "[scaling]") {
+    bench_scaling(Distribution::uniform, "uniform");
+    bench_scaling(Distribution::clustered, "clustered");
+    bench_scaling(Distribution::overlapping, "overlapping");
+}
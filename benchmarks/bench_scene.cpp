@@ -0,0 +1,287 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Camera.hpp"
+#include "CompiledScene.hpp"
+#include "InstancedScene.hpp"
+#include "Material.hpp"
+#include "MatrixImpl.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "SceneGenerator.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+#include <print>
+#include <string>
+#include <vector>
+
+using namespace raytracer;
+
+TEST_CASE("Scene parsing", "[scene]") {
+    const std::string text{generate_scene_text({.count = 1'000'000})};
+    BENCHMARK("parse one million spheres") {
+        return parse_scene(text)->spheres.size();
+    };
+
+    const auto scene{parse_scene(text)};
+    BENCHMARK("compile one million spheres") {
+        return CompiledScene::compile(scene.value()).object_count();
+    };
+
+    const auto cache_path{std::filesystem::temp_directory_path() / "raytracer_bench.scene.cache"};
+    if (CompiledScene::compile(scene.value()).write(cache_path.string()).has_value()) {
+        BENCHMARK("map a cache of one million spheres") {
+            return CompiledScene::map(cache_path.string())->object_count();
+        };
+        std::filesystem::remove(cache_path);
+    }
+}
+
+// A million copies of one sphere in 16 materials, held once as Sphere objects with their own heap-allocated double
+// transforms and materials, and once as instances of shared geometry and materials
+TEST_CASE("Instanced scenes", "[scene]") {
+    const Scene scene{generate_scene({.count = 1'000'000, .materials = 16}).value()};
+    size_t scene_bytes{scene.spheres.capacity() * sizeof(Sphere)};
+    for (const auto &sphere: scene.spheres) {
+        scene_bytes += sphere.transform.m_data.capacity() * sizeof(double);
+    }
+    const InstancedScene instanced{instance_scene(scene)};
+    const size_t instanced_bytes{
+        instanced.instances.capacity() * sizeof(Instance) + instanced.transforms.capacity() * sizeof(Matrix4) +
+        instanced.materials.size() * sizeof(Material)
+    };
+    std::println("{} bytes per sphere, {} per instance", scene_bytes / scene.spheres.size(),
+                 instanced_bytes / instanced.instances.size());
+    std::println("compiled: {} bytes per object", CompiledScene::compile(instanced).bytes().size() / 1'000'000);
+
+    BENCHMARK("compile one million spheres") {
+        return CompiledScene::compile(scene).object_count();
+    };
+    BENCHMARK("compile one million instances") {
+        return CompiledScene::compile(instanced).object_count();
+    };
+}
+
+// Every ray of a 1920x1080 frame, each from its pixel's coordinates, a row at a time by stepping along it, and in
+// SoA packets.
+TEST_CASE("Ray generation", "[scene]") {
+    Camera camera{1920, 1080, std::numbers::pi / 3};
+    camera.set_transform(view_transform(Point{0, 1.5, -5}, Point{0, 1, 0}, Vector{0, 1, 0}));
+    BENCHMARK("1920x1080, ray per pixel") {
+        float sum{0};
+        for (uint32_t y = 0; y < camera.vsize; ++y) {
+            for (uint32_t x = 0; x < camera.hsize; ++x) {
+                sum += camera.ray_for_pixel(x, y).direction.x;
+            }
+        }
+        return sum;
+    };
+    std::vector<Ray> rays(camera.hsize);
+    BENCHMARK("1920x1080, rays by row") {
+        float sum{0};
+        for (uint32_t y = 0; y < camera.vsize; ++y) {
+            camera.rays_for_row(y, 0, rays);
+            sum += rays.back().direction.x;
+        }
+        return sum;
+    };
+    RayPacket packet;
+    BENCHMARK("1920x1080, ray packets") {
+        float sum{0};
+        for (uint32_t y = 0; y < camera.vsize; ++y) {
+            for (uint32_t x = 0; x < camera.hsize; x += RayPacket::width) {
+                camera.packet_for_row(y, x, packet);
+                sum += packet.x[0];
+            }
+        }
+        return sum;
+    };
+}
+
+// A million points on a unit sphere lit by one light, shaded one at a time and sixteen lanes at a time.
+TEST_CASE("Lighting", "[scene]") {
+    constexpr size_t count{1'000'000};
+    const std::vector<Material> materials{Material{}, Material{.shininess = 50}};
+    const PointLight light{Point{-10, 10, -10}, Colour{1, 1, 1}};
+    const Vector eye{0, 0, -1};
+    std::vector<Point> points;
+    std::vector<Vector> normals;
+    for (size_t i = 0; i < count; ++i) {
+        const float theta{static_cast<float>(i) * 2.399963f};
+        const float z{1 - 2 * (static_cast<float>(i) + 0.5f) / count};
+        const float r{std::sqrt(1 - z * z)};
+        points.push_back(Point{r * std::cos(theta), r * std::sin(theta), z});
+        normals.push_back(Vector{r * std::cos(theta), r * std::sin(theta), z});
+    }
+    BENCHMARK("one million points, one at a time") {
+        float sum{0};
+        for (size_t i = 0; i < count; ++i) {
+            sum += lighting(materials[i & 1], light, points[i], eye, normals[i]).r;
+        }
+        return sum;
+    };
+    BENCHMARK("one million points, batched") {
+        float sum{0};
+        for (size_t i = 0; i < count; i += ShadingBatch::width) {
+            ShadingBatch batch;
+            for (size_t j = i; j < std::min(count, i + ShadingBatch::width); ++j) {
+                batch.add(points[j], normals[j], eye, static_cast<uint32_t>(j & 1));
+            }
+            ColourBatch colours;
+            lighting(materials, light, batch, colours);
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+}
+
+// The near half of a unit sphere seen from -z, a hundred thousand points in rows as a render would shade them, with
+// the material changing from row to row, lit by 256 lights spread over every side of it with brightness falling off
+// from 1 down to 1/10000: a light at a time, the whole set at once, the same from a shading table built beforehand,
+// and the table with the lights that cannot add half an 8-bit step left out.
+TEST_CASE("Many lights", "[scene]") {
+    constexpr size_t count{100'000};
+    const std::vector<Material> materials{Material{}, Material{.shininess = 50}};
+    std::vector<PointLight> lights;
+    for (uint32_t i = 0; i < 256; ++i) {
+        const float theta{static_cast<float>(i) * 2.399963f};
+        const float z{1 - 2 * (static_cast<float>(i) + 0.5f) / 256};
+        const float r{std::sqrt(1 - z * z)};
+        const float brightness{std::pow(10000.0f, -static_cast<float>(i % 16) / 15)};
+        lights.push_back({Point{10 * r * std::cos(theta), 10 * r * std::sin(theta), 10 * z},
+                          Colour{brightness, brightness, brightness}});
+    }
+    const LightSet set{LightSet::from(lights)};
+    const Vector eye{0, 0, -1};
+    std::vector<ShadingBatch> batches;
+    for (size_t i = 0; i < count; i += ShadingBatch::width) {
+        ShadingBatch batch;
+        for (size_t j = i; j < std::min(count, i + ShadingBatch::width); ++j) {
+            const float x{static_cast<float>(j % 400) / 200 - 1};
+            const float y{static_cast<float>(j / 400) / 125 - 1};
+            const float r{std::min(std::sqrt(x * x + y * y), 1.0f)};
+            const Point point{x / std::max(r, 1.0f), y / std::max(r, 1.0f), -std::sqrt(1 - r * r)};
+            batch.add(point, point - Point{0, 0, 0}, eye, static_cast<uint32_t>(j / 400 % 2));
+        }
+        batches.push_back(batch);
+    }
+    BENCHMARK("100k points, 256 lights, one at a time") {
+        float sum{0};
+        for (const auto &batch: batches) {
+            ColourBatch colours;
+            for (const auto &light: lights) {
+                lighting(materials, light, batch, colours);
+            }
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+    BENCHMARK("100k points, 256 lights, as a set") {
+        float sum{0};
+        for (const auto &batch: batches) {
+            ColourBatch colours;
+            lighting(materials, set, batch, colours);
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+    const ShadingTable table{ShadingTable::build(materials, set)};
+    BENCHMARK("100k points, 256 lights, from a shading table") {
+        float sum{0};
+        for (const auto &batch: batches) {
+            ColourBatch colours;
+            lighting(table, batch, colours);
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+    const ShadingTable per_lane{ShadingTable::build(materials, set, 0)};
+    BENCHMARK("100k points, 256 lights, from a shading table without per-light columns") {
+        float sum{0};
+        for (const auto &batch: batches) {
+            ColourBatch colours;
+            lighting(per_lane, batch, colours);
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+    BENCHMARK("100k points, 256 lights, from a shading table with a cutoff") {
+        float sum{0};
+        for (const auto &batch: batches) {
+            ColourBatch colours;
+            lighting(table, batch, colours, 1.0f / 512);
+            sum += colours.r[0];
+        }
+        return sum;
+    };
+}
+
+// What shadows cost on a render: every lit point casts a ray per light, answered by an any-hit walk that stops at the
+// first sphere in the way, after first trying the sphere that last blocked that light.
+TEST_CASE("Shadows", "[scene]") {
+    const CompiledScene scene{CompiledScene::compile(generate_scene({
+        .count = 10'000, .seed = 5, .distribution = Distribution::clustered, .lights = 4, .width = 320, .height = 240
+    }).value())};
+    BENCHMARK("10k spheres, 4 lights, 320x240, no shadows") {
+        return render(scene).storage[0];
+    };
+    BENCHMARK("10k spheres, 4 lights, 320x240, shadows") {
+        return render(scene, {.shadows = true}).storage[0];
+    };
+}
+
+// Secondary rays on a render where every sphere reflects half of the light, inside a mirror sphere around the whole
+// scene so that no ray escapes: the depth limit alone, the default weight threshold and a higher one, and Russian
+// roulette in place of dropping faint rays.
+TEST_CASE("Reflections", "[scene]") {
+    Scene mirrors{generate_scene({.count = 1'000, .seed = 5, .width = 320, .height = 240}).value()};
+    Sphere enclosure{Sphere::make_sphere()};
+    enclosure.transform = scale<double>(1000, 1000, 1000);
+    mirrors.spheres.push_back(enclosure);
+    for (auto &sphere: mirrors.spheres) {
+        sphere.material.reflective = 0.5f;
+    }
+    const CompiledScene scene{CompiledScene::compile(mirrors)};
+    const auto bench = [&](const std::string &name, RenderOptions options) {
+        RenderStats stats;
+        options.stats = &stats;
+        static_cast<void>(render(scene, options));
+        std::println("{}: {} secondary rays, average depth {:.2f}", name, stats.secondary_rays,
+                     stats.average_depth());
+        options.stats = nullptr;
+        BENCHMARK("1k spheres, 320x240, " + name) {
+            return render(scene, options).storage[0];
+        };
+    };
+    bench("no bounces", {.max_depth = 0});
+    bench("depth 10", {.max_depth = 10, .min_weight = 0});
+    bench("depth 10, weight 1/512", {.max_depth = 10});
+    bench("depth 10, weight 1/64", {.max_depth = 10, .min_weight = 1.0f / 64});
+    bench("depth 10, weight 1/64, roulette", {.max_depth = 10, .min_weight = 1.0f / 64, .russian_roulette = true});
+}
+
+// Adaptive anti-aliasing against one sample a pixel, and with a contrast of 0, which refines every pixel that is not
+// exactly like its neighbours until its samples agree.
+TEST_CASE("Anti-aliasing", "[scene]") {
+    const CompiledScene scene{CompiledScene::compile(generate_scene({.count = 1'000, .seed = 5, .width = 320,
+                                                                     .height = 240}).value())};
+    const auto bench = [&](const std::string &name, RenderOptions options) {
+        RenderStats stats;
+        options.stats = &stats;
+        static_cast<void>(render(scene, options));
+        std::println("{}: {:.2f} samples a pixel", name, stats.average_samples());
+        options.stats = nullptr;
+        BENCHMARK("1k spheres, 320x240, " + name) {
+            return render(scene, options).storage[0];
+        };
+    };
+    bench("one sample", {});
+    bench("up to 16 samples, contrast 0.05", {.max_samples = 16});
+    bench("up to 16 samples, contrast 0", {.max_samples = 16, .contrast = 0});
+}
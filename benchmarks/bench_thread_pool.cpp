@@ -0,0 +1,56 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "ThreadPool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace raytracer;
+
+// Scheduling overhead per task: each benchmark runs 1024 tasks that do next to nothing, so the time divided by 1024
+// is roughly what the pool costs per task, compared with starting a thread for each piece of work.
+TEST_CASE("Thread pool scheduling overhead", "[thread_pool]") {
+    constexpr size_t tasks{1024};
+    ThreadPool &pool{ThreadPool::shared()};
+    std::atomic<size_t> counter{0};
+
+    BENCHMARK("1024 empty tasks through a task group") {
+        TaskGroup group{pool};
+        for (size_t i = 0; i < tasks; ++i) {
+            group.run([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        group.wait();
+        return counter.load();
+    };
+
+    BENCHMARK("parallel_for over 1024 indices, grain 1") {
+        pool.parallel_for(0, tasks, 1, [&counter](const size_t begin, const size_t end) {
+            counter.fetch_add(end - begin, std::memory_order_relaxed);
+        });
+        return counter.load();
+    };
+
+    BENCHMARK("parallel_for over 1024x1024 tiles of 16x16") {
+        pool.parallel_for(Range2D{0, 1024, 0, 1024}, 16, 16, [&counter](const Range2D &tile) {
+            counter.fetch_add(tile.x_end - tile.x_begin, std::memory_order_relaxed);
+        });
+        return counter.load();
+    };
+
+    BENCHMARK("1024 empty tasks on their own jthreads, 16 at a time") {
+        for (size_t i = 0; i < tasks; i += 16) {
+            std::vector<std::jthread> threads;
+            threads.reserve(16);
+            for (size_t t = 0; t < 16; ++t) {
+                threads.emplace_back([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+        }
+        return counter.load();
+    };
+}
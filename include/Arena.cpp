@@ -0,0 +1,84 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include "Arena.hpp"
+
+namespace raytracer {
+    namespace {
+        constexpr size_t max_block_size{size_t{1} << 24};
+
+        size_t align_up(const std::byte *base, const size_t offset, const size_t alignment) {
+            const auto address{reinterpret_cast<uintptr_t>(base) + offset};
+            return offset + ((alignment - address % alignment) % alignment);
+        }
+    }
+
+    Arena::Arena(const size_t block_size, std::pmr::memory_resource *upstream) : upstream(upstream),
+        next_block_size(std::max<size_t>(block_size, 64)) {
+    }
+
+    Arena::~Arena() {
+        release();
+    }
+
+    void Arena::rewind(const Marker &marker) {
+        current = marker.block;
+        offset = marker.offset;
+        bytes_before = marker.bytes_before;
+    }
+
+    void Arena::release() {
+        for (const auto &block: blocks) {
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+        blocks.clear();
+        reset();
+    }
+
+    size_t Arena::capacity() const {
+        size_t total{0};
+        for (const auto &block: blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+
+    void *Arena::do_allocate(const size_t bytes, const size_t alignment) {
+        if (current < blocks.size()) {
+            if (const size_t start{align_up(blocks[current].data, offset, alignment)};
+                start + bytes <= blocks[current].size) {
+                offset = start + bytes;
+                return blocks[current].data + start;
+            }
+        }
+        // the current block is full; everything after it is free, so move on to the first of those that fits,
+        // bringing it forward so later blocks stay in the order they will be used
+        const size_t next{current < blocks.size() ? current + 1 : current};
+        const size_t needed{bytes + alignment};
+        auto fits{std::find_if(blocks.begin() + static_cast<std::ptrdiff_t>(next), blocks.end(),
+                               [needed](const Block &block) { return block.size >= needed; })};
+        if (fits == blocks.end()) {
+            const size_t size{std::max(needed, next_block_size)};
+            next_block_size = std::min(next_block_size * 2, max_block_size);
+            blocks.push_back({static_cast<std::byte *>(upstream->allocate(size, alignof(std::max_align_t))), size});
+            ++allocations;
+            fits = blocks.end() - 1;
+        }
+        std::rotate(blocks.begin() + static_cast<std::ptrdiff_t>(next), fits, fits + 1);
+        if (current < blocks.size() && next != current) {
+            bytes_before += blocks[current].size;
+        }
+        current = next;
+        const size_t start{align_up(blocks[current].data, 0, alignment)};
+        offset = start + bytes;
+        return blocks[current].data + start;
+    }
+
+    Arena &thread_arena() {
+        thread_local Arena arena;
+        return arena;
+    }
+}
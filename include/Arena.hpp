@@ -0,0 +1,96 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_ARENA_HPP
+#define THE_RAYTRACER_CHALLENGE_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace raytracer {
+    // Bump allocator for short-lived data, usable anywhere a std::pmr::memory_resource is. Allocation moves a cursor
+    // through blocks taken from the upstream resource; deallocate does nothing and memory comes back all at once
+    // through rewind or reset. Blocks are kept across resets, so once an arena has grown to what a tile or frame
+    // needs it stops calling upstream at all. Not thread safe: each thread uses its own, see thread_arena().
+    class Arena final : public std::pmr::memory_resource {
+    public:
+        // a point to rewind to; everything allocated after it is released together
+        struct Marker {
+            size_t block{0};
+            size_t offset{0};
+            size_t bytes_before{0};
+        };
+
+        explicit Arena(size_t block_size = size_t{1} << 16,
+                       std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena() override;
+
+        [[nodiscard]] Marker mark() const { return {current, offset, bytes_before}; }
+
+        void rewind(const Marker &marker);
+
+        // release every allocation but keep the blocks for reuse
+        void reset() { rewind({}); }
+
+        // hand every block back to upstream
+        void release();
+
+        // bytes between the start of the arena and the cursor, alignment padding and block tails included
+        [[nodiscard]] size_t bytes_used() const { return bytes_before + offset; }
+
+        [[nodiscard]] size_t capacity() const;
+
+        // how many blocks have been taken from upstream over the arena's lifetime
+        [[nodiscard]] size_t upstream_allocations() const { return allocations; }
+
+    private:
+        struct Block {
+            std::byte *data;
+            size_t size;
+        };
+
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *, size_t, size_t) override {
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+
+        std::pmr::memory_resource *upstream;
+        size_t next_block_size;
+        std::vector<Block> blocks;
+        size_t current{0};
+        size_t offset{0};
+        // sizes of the blocks before current, which are considered full
+        size_t bytes_before{0};
+        size_t allocations{0};
+    };
+
+    // rewinds an arena to where it was when the scope was opened
+    class ArenaScope {
+    public:
+        explicit ArenaScope(Arena &arena) : arena(arena), marker(arena.mark()) {
+        }
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        ~ArenaScope() { arena.rewind(marker); }
+
+    private:
+        Arena &arena;
+        Arena::Marker marker;
+    };
+
+    // this thread's arena for frame-transient data. The renderer opens an ArenaScope on it around every tile, so
+    // anything shading allocates from it lives until the end of the tile.
+    Arena &thread_arena();
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_ARENA_HPP
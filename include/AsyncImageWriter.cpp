@@ -0,0 +1,76 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "AsyncImageWriter.hpp"
+
+namespace raytracer {
+    AsyncImageWriter::AsyncImageWriter(const uint32_t width, const uint32_t height, const size_t buffers,
+                                       const EncodeOptions options)
+        : options(options), free_buffers(std::max<size_t>(buffers, 1), Canvas{width, height}),
+          writer([this](const std::stop_token &stop) { run(stop); }) {
+    }
+
+    AsyncImageWriter::~AsyncImageWriter() {
+        [[maybe_unused]] const auto flushed{flush()};
+        writer.request_stop();
+    }
+
+    Canvas AsyncImageWriter::acquire() {
+        std::unique_lock lock{mutex};
+        changed.wait(lock, [this] { return !free_buffers.empty(); });
+        Canvas canvas{std::move(free_buffers.back())};
+        free_buffers.pop_back();
+        return canvas;
+    }
+
+    void AsyncImageWriter::submit(Canvas &&canvas, std::string file_path) {
+        {
+            std::scoped_lock lock{mutex};
+            queue.push_back({std::move(canvas), std::move(file_path)});
+        }
+        changed.notify_all();
+    }
+
+    std::expected<bool, CanvasError> AsyncImageWriter::flush() {
+        std::unique_lock lock{mutex};
+        changed.wait(lock, [this] { return queue.empty() && !writing; });
+        if (first_error.has_value()) {
+            const CanvasError error{*first_error};
+            first_error.reset();
+            return std::unexpected(error);
+        }
+        return true;
+    }
+
+    size_t AsyncImageWriter::frames_written() const {
+        std::scoped_lock lock{mutex};
+        return written;
+    }
+
+    void AsyncImageWriter::run(const std::stop_token &stop) {
+        std::unique_lock lock{mutex};
+        while (true) {
+            // the destructor flushes before stopping, so the queue is always drained
+            if (!changed.wait(lock, stop, [this] { return !queue.empty(); })) {
+                return;
+            }
+            Job job{std::move(queue.front())};
+            queue.pop_front();
+            writing = true;
+            lock.unlock();
+
+            const auto saved{save_image(job.canvas, job.file_path, options)};
+
+            lock.lock();
+            writing = false;
+            if (saved.has_value()) {
+                ++written;
+            } else if (!first_error.has_value()) {
+                first_error = saved.error();
+            }
+            free_buffers.push_back(std::move(job.canvas));
+            changed.notify_all();
+        }
+    }
+}
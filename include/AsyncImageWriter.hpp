@@ -0,0 +1,68 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_ASYNC_IMAGE_WRITER_HPP
+#define THE_RAYTRACER_CHALLENGE_ASYNC_IMAGE_WRITER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Canvas.hpp"
+#include "ImageCodecs.hpp"
+
+namespace raytracer {
+    // Encodes and writes frames on a dedicated thread while the caller renders the next one. Frames are drawn from a
+    // fixed pool of canvases: acquire() hands one out, submit() queues it for writing and the writer returns it to the
+    // pool once it is on disk. With two buffers this is double buffering; when the disk falls behind, acquire() blocks
+    // until a buffer comes back, so memory use stays bounded.
+    class AsyncImageWriter {
+    public:
+        AsyncImageWriter(uint32_t width, uint32_t height, size_t buffers = 2, EncodeOptions options = {});
+
+        AsyncImageWriter(const AsyncImageWriter &) = delete;
+        AsyncImageWriter &operator=(const AsyncImageWriter &) = delete;
+
+        // writes everything still queued before returning
+        ~AsyncImageWriter();
+
+        // a canvas from the pool, waiting for the writer to release one if all are in use; its previous contents are
+        // left in place
+        Canvas acquire();
+
+        // queue a canvas obtained from acquire() to be written to file_path, in any format save_image supports
+        void submit(Canvas &&canvas, std::string file_path);
+
+        // wait until every submitted frame has been written; reports the first failure since the last flush
+        std::expected<bool, CanvasError> flush();
+
+        [[nodiscard]] size_t frames_written() const;
+
+    private:
+        struct Job {
+            Canvas canvas;
+            std::string file_path;
+        };
+
+        void run(const std::stop_token &stop);
+
+        EncodeOptions options;
+        mutable std::mutex mutex;
+        std::condition_variable_any changed;
+        std::vector<Canvas> free_buffers;
+        std::deque<Job> queue;
+        bool writing{false};
+        size_t written{0};
+        std::optional<CanvasError> first_error;
+        // declared last so the thread starts after everything it uses has been constructed
+        std::jthread writer;
+    };
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_ASYNC_IMAGE_WRITER_HPP
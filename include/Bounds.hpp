@@ -0,0 +1,70 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_BOUNDS_HPP
+#define THE_RAYTRACER_CHALLENGE_BOUNDS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Matrix4.hpp"
+#include "Point.hpp"
+
+namespace raytracer {
+    // axis-aligned box; the default is empty, so merging anything into it gives that thing's bounds
+    struct Bounds {
+        Point min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+                  std::numeric_limits<float>::infinity()};
+        Point max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                  -std::numeric_limits<float>::infinity()};
+
+        [[nodiscard]] constexpr bool empty() const {
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        constexpr void merge(const Bounds &other) {
+            min = {std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)};
+            max = {std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)};
+        }
+
+        constexpr void merge(const Point &p) {
+            min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+            max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+        }
+
+        constexpr bool operator==(const Bounds &) const = default;
+    };
+
+    // Tight box around the unit sphere under transform. Each world axis is a linear function of the object point,
+    // whose extreme over the unit sphere is the length of that row of the transform.
+    inline Bounds sphere_bounds(const Matrix4 &transform) {
+        const auto &m{transform.m};
+        const float ex{std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2])};
+        const float ey{std::sqrt(m[4] * m[4] + m[5] * m[5] + m[6] * m[6])};
+        const float ez{std::sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10])};
+        return Bounds{{m[3] - ex, m[7] - ey, m[11] - ez}, {m[3] + ex, m[7] + ey, m[11] + ez}};
+    }
+
+    // Box around box under transform. Each world axis is a linear function of the object point, so its extreme is
+    // where every term is at its own extreme: the centre maps to the centre and the half size along each axis is
+    // the absolute row of the transform applied to the half sizes.
+    inline Bounds transformed_bounds(const Bounds &box, const Matrix4 &transform) {
+        if (box.empty()) {
+            return box;
+        }
+        const auto &m{transform.m};
+        const Point centre{transform.transform_point(Point{
+            (box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f
+        })};
+        const float hx{(box.max.x - box.min.x) * 0.5f};
+        const float hy{(box.max.y - box.min.y) * 0.5f};
+        const float hz{(box.max.z - box.min.z) * 0.5f};
+        const float ex{std::abs(m[0]) * hx + std::abs(m[1]) * hy + std::abs(m[2]) * hz};
+        const float ey{std::abs(m[4]) * hx + std::abs(m[5]) * hy + std::abs(m[6]) * hz};
+        const float ez{std::abs(m[8]) * hx + std::abs(m[9]) * hy + std::abs(m[10]) * hz};
+        return Bounds{{centre.x - ex, centre.y - ey, centre.z - ez}, {centre.x + ex, centre.y + ey, centre.z + ez}};
+    }
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_BOUNDS_HPP
@@ -0,0 +1,457 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <type_traits>
+#include "Bvh.hpp"
+
+namespace raytracer {
+    namespace {
+        // primitives are binned in chunks of this many when a range is processed in parallel
+        constexpr uint32_t chunk_size{2048};
+
+        float surface_area(const Bounds &b) {
+            if (b.empty()) {
+                return 0;
+            }
+            const float dx{b.max.x - b.min.x};
+            const float dy{b.max.y - b.min.y};
+            const float dz{b.max.z - b.min.z};
+            return 2 * (dx * dy + dy * dz + dz * dx);
+        }
+
+        float axis_of(const Point &p, const int axis) {
+            return axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+        }
+
+        Point centre(const Bounds &b) {
+            return {(b.min.x + b.max.x) * 0.5f, (b.min.y + b.max.y) * 0.5f, (b.min.z + b.max.z) * 0.5f};
+        }
+
+        // bounds of a range and of the centres in it; the centres decide where split planes can go
+        struct Extent {
+            Bounds bounds;
+            Bounds centres;
+
+            void merge(const Extent &other) {
+                bounds.merge(other.bounds);
+                centres.merge(other.centres);
+            }
+        };
+
+        // No member initialisers, so a set of bins costs nothing to create and only the bins a node uses are
+        // cleared; a million small nodes would otherwise spend most of the build zeroing bins. The centres are
+        // tracked too, so the chosen split hands each child its extent without another pass over it.
+        struct Bin {
+            std::array<float, 3> low;
+            std::array<float, 3> high;
+            std::array<float, 3> centre_low;
+            std::array<float, 3> centre_high;
+            uint32_t count;
+
+            void clear() {
+                low.fill(std::numeric_limits<float>::infinity());
+                high.fill(-std::numeric_limits<float>::infinity());
+                centre_low.fill(std::numeric_limits<float>::infinity());
+                centre_high.fill(-std::numeric_limits<float>::infinity());
+                count = 0;
+            }
+
+            void add(const Bounds &b, const Point &c) {
+                low[0] = std::min(low[0], b.min.x);
+                low[1] = std::min(low[1], b.min.y);
+                low[2] = std::min(low[2], b.min.z);
+                high[0] = std::max(high[0], b.max.x);
+                high[1] = std::max(high[1], b.max.y);
+                high[2] = std::max(high[2], b.max.z);
+                centre_low[0] = std::min(centre_low[0], c.x);
+                centre_low[1] = std::min(centre_low[1], c.y);
+                centre_low[2] = std::min(centre_low[2], c.z);
+                centre_high[0] = std::max(centre_high[0], c.x);
+                centre_high[1] = std::max(centre_high[1], c.y);
+                centre_high[2] = std::max(centre_high[2], c.z);
+                ++count;
+            }
+
+            void add(const Bin &other) {
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    low[axis] = std::min(low[axis], other.low[axis]);
+                    high[axis] = std::max(high[axis], other.high[axis]);
+                    centre_low[axis] = std::min(centre_low[axis], other.centre_low[axis]);
+                    centre_high[axis] = std::max(centre_high[axis], other.centre_high[axis]);
+                }
+                count += other.count;
+            }
+
+            [[nodiscard]] Bounds bounds() const {
+                return Bounds{{low[0], low[1], low[2]}, {high[0], high[1], high[2]}};
+            }
+
+            [[nodiscard]] Extent extent() const {
+                return Extent{
+                    bounds(), Bounds{
+                        {centre_low[0], centre_low[1], centre_low[2]}, {centre_high[0], centre_high[1], centre_high[2]}
+                    }
+                };
+            }
+        };
+
+        // where along each axis a centre falls among a node's bins
+        struct Binning {
+            Binning(const Bounds &centres, const uint32_t bins) : centres(centres), bins(bins) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    const float width{axis_of(centres.max, axis) - axis_of(centres.min, axis)};
+                    usable[axis] = width > 0;
+                    scale[axis] = usable[axis] ? static_cast<float>(bins) / width : 0;
+                }
+            }
+
+            [[nodiscard]] uint32_t bin_of(const int axis, const Point &c) const {
+                const auto bin{static_cast<uint32_t>((axis_of(c, axis) - axis_of(centres.min, axis)) * scale[axis])};
+                return std::min(bin, bins - 1);
+            }
+
+            Bounds centres;
+            uint32_t bins;
+            std::array<bool, 3> usable{};
+            std::array<float, 3> scale{};
+        };
+
+        struct Bins {
+            explicit Bins(const uint32_t used = 0) : used(used) {
+                for (auto &axis: bins) {
+                    for (uint32_t b = 0; b < used; ++b) {
+                        axis[b].clear();
+                    }
+                }
+            }
+
+            void merge(const Bins &other) {
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    for (uint32_t b = 0; b < used; ++b) {
+                        bins[axis][b].add(other.bins[axis][b]);
+                    }
+                }
+            }
+
+            uint32_t used;
+            std::array<std::array<Bin, 64>, 3> bins;
+        };
+
+        // a primitive's bounds kept next to its number, so the passes over a range read memory in order rather than
+        // jumping through the index array into the caller's bounds
+        struct Reference {
+            Bounds bounds;
+            uint32_t index;
+        };
+
+        class Builder {
+        public:
+            Builder(std::vector<Reference> &references, const BvhOptions &options, ThreadPool &pool, Bvh &bvh)
+                : references(references), options(options), bins(std::clamp(options.bins, 2u, 64u)),
+                  max_depth(std::min(options.max_depth, bvh_stack_depth)), pool(pool), bvh(bvh) {
+            }
+
+            // extent is that of [begin, end), passed down from the parent's bins
+            void build(const uint32_t node, const uint32_t begin, const uint32_t end, const uint32_t depth,
+                       const Extent &extent, TaskGroup &group) {
+                const uint32_t count{end - begin};
+                const auto make_leaf = [&] { bvh.nodes[node] = BvhNode{extent.bounds, begin, count}; };
+                if (count == 1 || depth >= max_depth) {
+                    make_leaf();
+                    return;
+                }
+
+                // small nodes get one bin per primitive at most; more would only cost time
+                const Binning binning{extent.centres, std::clamp(count, 2u, bins)};
+                const Split split{choose_split(extent, binning, begin, end)};
+                const float leaf_cost{options.intersection_cost * static_cast<float>(count)};
+                if (count <= options.max_leaf_size && leaf_cost <= split.cost) {
+                    make_leaf();
+                    return;
+                }
+                uint32_t middle{begin};
+                Extent left_extent{split.left};
+                Extent right_extent{split.right};
+                const auto first{references.begin() + begin};
+                const auto last{references.begin() + end};
+                if (split.axis >= 0) {
+                    middle = static_cast<uint32_t>(std::partition(first, last, [&](const Reference &r) {
+                        return binning.bin_of(split.axis, centre(r.bounds)) < split.bin;
+                    }) - references.begin());
+                }
+                if (middle == begin || middle == end) {
+                    // every centre in one place, or a split that fell on the edge of a bin: halve by position
+                    // along the longest axis instead
+                    const int axis{longest_axis(extent.centres)};
+                    middle = begin + count / 2;
+                    std::nth_element(first, references.begin() + middle, last,
+                                     [axis](const Reference &a, const Reference &b) {
+                                         return axis_of(centre(a.bounds), axis) < axis_of(centre(b.bounds), axis);
+                                     });
+                    left_extent = measure(begin, middle);
+                    right_extent = measure(middle, end);
+                }
+
+                const uint32_t left{next_node.fetch_add(2, std::memory_order_relaxed)};
+                bvh.nodes[node] = BvhNode{extent.bounds, left, 0};
+                if (count >= options.parallel_threshold) {
+                    group.run([this, left, begin, middle, depth, left_extent, &group] {
+                        build(left, begin, middle, depth + 1, left_extent, group);
+                    });
+                } else {
+                    build(left, begin, middle, depth + 1, left_extent, group);
+                }
+                build(left + 1, middle, end, depth + 1, right_extent, group);
+            }
+
+            [[nodiscard]] Extent measure(const uint32_t begin, const uint32_t end) const {
+                const auto make_extent = [] { return Extent{}; };
+                return reduce(begin, end, make_extent, [this](const uint32_t from, const uint32_t to, Extent &extent) {
+                    for (uint32_t i = from; i < to; ++i) {
+                        const Bounds &b{references[i].bounds};
+                        extent.bounds.merge(b);
+                        extent.centres.merge(centre(b));
+                    }
+                });
+            }
+
+            std::atomic<uint32_t> next_node{1};
+
+        private:
+            struct Split {
+                int axis{-1};
+                uint32_t bin{0};
+                float cost{std::numeric_limits<float>::infinity()};
+                // extents of the two sides
+                Extent left{};
+                Extent right{};
+            };
+
+            static int longest_axis(const Bounds &b) {
+                const float dx{b.max.x - b.min.x};
+                const float dy{b.max.y - b.min.y};
+                const float dz{b.max.z - b.min.z};
+                return dx >= dy && dx >= dz ? 0 : dy >= dz ? 1 : 2;
+            }
+
+            // splits a range into chunks handled on the pool when it is long enough, and in one go otherwise
+            template<typename Make, typename Chunk>
+            std::invoke_result_t<Make &> reduce(const uint32_t begin, const uint32_t end, Make &&make,
+                                                Chunk &&chunk) const {
+                using Result = std::invoke_result_t<Make &>;
+                const uint32_t count{end - begin};
+                if (count < options.parallel_threshold) {
+                    Result result{make()};
+                    chunk(begin, end, result);
+                    return result;
+                }
+                const uint32_t chunks{(count + chunk_size - 1) / chunk_size};
+                std::vector<Result> partial;
+                partial.reserve(chunks);
+                for (uint32_t c = 0; c < chunks; ++c) {
+                    partial.push_back(make());
+                }
+                pool.parallel_for(0, chunks, 1, [&](const size_t first, const size_t last) {
+                    for (size_t c = first; c < last; ++c) {
+                        const uint32_t from{begin + static_cast<uint32_t>(c) * chunk_size};
+                        chunk(from, std::min(from + chunk_size, end), partial[c]);
+                    }
+                });
+                Result result{std::move(partial[0])};
+                for (size_t c = 1; c < chunks; ++c) {
+                    result.merge(partial[c]);
+                }
+                return result;
+            }
+
+            // the cheapest bin boundary on any axis by the surface area heuristic
+            [[nodiscard]] Split choose_split(const Extent &extent, const Binning &binning, const uint32_t begin,
+                                             const uint32_t end) const {
+                const auto &usable{binning.usable};
+                if (!usable[0] && !usable[1] && !usable[2]) {
+                    return {};
+                }
+                const auto make_bins = [&binning] { return Bins{binning.bins}; };
+                const Bins binned{reduce(begin, end, make_bins, [&](const uint32_t from, const uint32_t to,
+                                                                    Bins &into) {
+                    for (uint32_t i = from; i < to; ++i) {
+                        const Bounds &b{references[i].bounds};
+                        const Point c{centre(b)};
+                        for (int axis = 0; axis < 3; ++axis) {
+                            if (usable[axis]) {
+                                into.bins[axis][binning.bin_of(axis, c)].add(b, c);
+                            }
+                        }
+                    }
+                })};
+
+                const float parent_area{surface_area(extent.bounds)};
+                Split best;
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (!usable[axis]) {
+                        continue;
+                    }
+                    // cost of everything right of each boundary, swept from the right
+                    const auto &axis_bins{binned.bins[axis]};
+                    std::array<float, 64> right_cost{};
+                    Bin right{};
+                    right.clear();
+                    for (uint32_t b = binning.bins - 1; b > 0; --b) {
+                        right.add(axis_bins[b]);
+                        right_cost[b] = surface_area(right.bounds()) * static_cast<float>(right.count);
+                    }
+                    Bin left{};
+                    left.clear();
+                    for (uint32_t b = 1; b < binning.bins; ++b) {
+                        left.add(axis_bins[b - 1]);
+                        const float left_cost{surface_area(left.bounds()) * static_cast<float>(left.count)};
+                        const float children{(left_cost + right_cost[b]) / parent_area};
+                        const float cost{options.traversal_cost + options.intersection_cost * children};
+                        if (cost < best.cost) {
+                            best.axis = axis;
+                            best.bin = b;
+                            best.cost = cost;
+                        }
+                    }
+                }
+                if (best.axis >= 0) {
+                    Bin left{};
+                    Bin right{};
+                    left.clear();
+                    right.clear();
+                    for (uint32_t b = 0; b < binning.bins; ++b) {
+                        (b < best.bin ? left : right).add(binned.bins[best.axis][b]);
+                    }
+                    best.left = left.extent();
+                    best.right = right.extent();
+                }
+                return best;
+            }
+
+            std::vector<Reference> &references;
+            const BvhOptions &options;
+            uint32_t bins;
+            // options.max_depth, no deeper than traverse_bvh() can follow
+            uint32_t max_depth;
+            ThreadPool &pool;
+            Bvh &bvh;
+        };
+
+        void walk(const std::span<const BvhNode> nodes, const uint32_t node, const uint32_t depth,
+                  const float root_area, const BvhOptions &options, BvhStats &stats) {
+            const BvhNode &n{nodes[node]};
+            const float area_ratio{root_area > 0 ? surface_area(n.bounds) / root_area : 1};
+            ++stats.node_count;
+            stats.depth = std::max(stats.depth, depth);
+            if (n.is_leaf()) {
+                ++stats.leaf_count;
+                stats.max_leaf_size = std::max(stats.max_leaf_size, n.count);
+                stats.sah_cost += area_ratio * options.intersection_cost * static_cast<float>(n.count);
+                return;
+            }
+            stats.sah_cost += area_ratio * options.traversal_cost;
+            walk(nodes, n.first, depth + 1, root_area, options, stats);
+            walk(nodes, n.first + 1, depth + 1, root_area, options, stats);
+        }
+
+        Bounds fitted(const Bvh &bvh, const BvhNode &node, const std::span<const Bounds> bounds) {
+            Bounds fit;
+            if (node.is_leaf()) {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    fit.merge(bounds[bvh.indices[i]]);
+                }
+            } else {
+                fit.merge(bvh.nodes[node.first].bounds);
+                fit.merge(bvh.nodes[node.first + 1].bounds);
+            }
+            return fit;
+        }
+    }
+
+    Bvh build_bvh(const std::span<const Bounds> bounds, const BvhOptions &options) {
+        const auto start{std::chrono::steady_clock::now()};
+        Bvh bvh;
+        std::vector<Reference> references;
+        for (uint32_t i = 0; i < bounds.size(); ++i) {
+            if (!bounds[i].empty()) {
+                references.push_back({bounds[i], i});
+            }
+        }
+        if (references.empty()) {
+            return bvh;
+        }
+        const auto count{static_cast<uint32_t>(references.size())};
+        bvh.nodes.resize(size_t{2} * count - 1);
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        Builder builder{references, options, pool, bvh};
+        {
+            TaskGroup group{pool};
+            const Extent root{builder.measure(0, count)};
+            group.run([&builder, &group, count, &root] { builder.build(0, 0, count, 0, root, group); });
+            group.wait();
+        }
+        bvh.indices.resize(count);
+        std::ranges::transform(references, bvh.indices.begin(), &Reference::index);
+        bvh.nodes.resize(builder.next_node.load());
+        bvh.stats = bvh_stats(bvh.nodes, options);
+        const auto elapsed{std::chrono::steady_clock::now() - start};
+        bvh.stats.build_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        return bvh;
+    }
+
+    BvhStats bvh_stats(const std::span<const BvhNode> nodes, const BvhOptions &options) {
+        BvhStats stats;
+        if (!nodes.empty()) {
+            walk(nodes, 0, 1, surface_area(nodes[0].bounds), options, stats);
+        }
+        return stats;
+    }
+
+    BvhLinks bvh_links(const Bvh &bvh, const size_t primitive_count) {
+        BvhLinks links{
+            .parents = std::vector<uint32_t>(bvh.nodes.size(), BvhLinks::none),
+            .leaves = std::vector<uint32_t>(primitive_count, BvhLinks::none)
+        };
+        for (uint32_t node = 0; node < bvh.nodes.size(); ++node) {
+            const BvhNode &n{bvh.nodes[node]};
+            if (n.is_leaf()) {
+                for (uint32_t i = n.first; i < n.first + n.count; ++i) {
+                    links.leaves[bvh.indices[i]] = node;
+                }
+            } else {
+                links.parents[n.first] = node;
+                links.parents[n.first + 1] = node;
+            }
+        }
+        return links;
+    }
+
+    void refit_bvh(Bvh &bvh, const std::span<const Bounds> bounds) {
+        // children come after their parent, so walking backwards sees both children of a node before the node
+        for (size_t node = bvh.nodes.size(); node-- > 0;) {
+            bvh.nodes[node].bounds = fitted(bvh, bvh.nodes[node], bounds);
+        }
+    }
+
+    uint32_t refit_bvh(Bvh &bvh, const BvhLinks &links, const std::span<const Bounds> bounds,
+                       const std::span<const uint32_t> moved) {
+        uint32_t refitted{0};
+        for (const uint32_t primitive: moved) {
+            // a box that comes out unchanged leaves every box above it as it was
+            for (uint32_t node{links.leaves[primitive]}; node != BvhLinks::none; node = links.parents[node]) {
+                const Bounds fit{fitted(bvh, bvh.nodes[node], bounds)};
+                ++refitted;
+                if (fit == bvh.nodes[node].bounds) {
+                    break;
+                }
+                bvh.nodes[node].bounds = fit;
+            }
+        }
+        return refitted;
+    }
+}
@@ -0,0 +1,164 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_BVH_HPP
+#define THE_RAYTRACER_CHALLENGE_BVH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "Bounds.hpp"
+#include "Intersect.hpp"
+#include "ThreadPool.hpp"
+
+namespace raytracer {
+    // One node of a flattened bounding volume hierarchy. A leaf covers count primitives starting at first in the
+    // index array; an interior node has count 0 and its children at first and first + 1.
+    struct BvhNode {
+        Bounds bounds{};
+        uint32_t first{0};
+        uint32_t count{0};
+
+        [[nodiscard]] constexpr bool is_leaf() const { return count != 0; }
+    };
+
+    // the deepest tree traverse_bvh() can walk, one stack entry per level; build_bvh() never goes deeper
+    inline constexpr uint32_t bvh_stack_depth{64};
+
+    struct BvhOptions {
+        // pool the build is spread over; nullptr for ThreadPool::shared()
+        ThreadPool *pool{nullptr};
+        // candidate split planes per axis are the boundaries between this many bins
+        uint32_t bins{16};
+        // nodes with this many primitives or fewer become leaves when splitting does not pay
+        uint32_t max_leaf_size{4};
+        // deeper nodes are made leaves whatever their size, which bounds the traversal stack; capped at
+        // bvh_stack_depth
+        uint32_t max_depth{bvh_stack_depth};
+        // ranges at least this long are binned in parallel and have their subtrees built as separate tasks
+        uint32_t parallel_threshold{4096};
+        // relative costs of visiting a node and of intersecting a primitive, for the surface area heuristic
+        float traversal_cost{1};
+        float intersection_cost{1};
+    };
+
+    // how long the build took and how good the tree is; lower SAH cost means fewer expected tests per ray
+    struct BvhStats {
+        double build_ms{0};
+        float sah_cost{0};
+        uint32_t node_count{0};
+        uint32_t leaf_count{0};
+        uint32_t depth{0};
+        uint32_t max_leaf_size{0};
+    };
+
+    struct Bvh {
+        // the root is nodes[0]; empty when there is nothing to hit
+        std::vector<BvhNode> nodes;
+        // primitive numbers in leaf order
+        std::vector<uint32_t> indices;
+        BvhStats stats;
+    };
+
+    // Binned SAH build over the given primitive bounds; primitives with empty bounds can never be hit and are left
+    // out. Large ranges are binned in parallel and both halves of every large split are built concurrently, so the
+    // tree is the same whatever the pool, only the order of its nodes differs. Children always come after their
+    // parent.
+    Bvh build_bvh(std::span<const Bounds> bounds, const BvhOptions &options = {});
+
+    // SAH cost, depth and sizes of an existing tree; build_ms is left at 0
+    BvhStats bvh_stats(std::span<const BvhNode> nodes, const BvhOptions &options = {});
+
+    // Distance at which the ray enters box, clamped to 0 when it starts inside, or infinity when it misses or only
+    // gets there beyond max_t. The far distance is widened slightly so rounding in the box or the slabs never loses
+    // a primitive that touches its own bounds.
+    inline float enter_box(const Bounds &box, const Ray &ray, const Vector &inverse_direction, const float max_t) {
+        const float x1{(box.min.x - ray.origin.x) * inverse_direction.x};
+        const float x2{(box.max.x - ray.origin.x) * inverse_direction.x};
+        const float y1{(box.min.y - ray.origin.y) * inverse_direction.y};
+        const float y2{(box.max.y - ray.origin.y) * inverse_direction.y};
+        const float z1{(box.min.z - ray.origin.z) * inverse_direction.z};
+        const float z2{(box.max.z - ray.origin.z) * inverse_direction.z};
+        const float near{std::max({std::min(x1, x2), std::min(y1, y2), std::min(z1, z2), 0.0f})};
+        const float far{std::min({std::max(x1, x2), std::max(y1, y2), std::max(z1, z2)}) * 1.00001f};
+        return near <= far && near <= max_t ? near : std::numeric_limits<float>::infinity();
+    }
+
+    // Walks the tree nearer child first, calling visit_leaf(first, count) for every leaf the ray enters no further
+    // than nearest_t, which visit_leaf lowers as it finds hits so that anything starting beyond the closest hit so
+    // far is skipped. Setting nearest_t below 0 ends the walk after the current leaf, for queries that only need to
+    // know whether anything is hit.
+    template<typename VisitLeaf>
+    void traverse_bvh(const std::span<const BvhNode> nodes, const Ray &ray, const float &nearest_t,
+                      VisitLeaf &&visit_leaf) {
+        constexpr float miss{std::numeric_limits<float>::infinity()};
+        const Vector inverse_direction{1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z};
+        if (nodes.empty() || enter_box(nodes[0].bounds, ray, inverse_direction, nearest_t) == miss) {
+            return;
+        }
+        struct Pending {
+            uint32_t node;
+            float t;
+        };
+        // one entry per level at most, and builds stop splitting at bvh_stack_depth; the bound only guards against a
+        // tree that is deeper than any build produces
+        std::array<Pending, bvh_stack_depth> stack;
+        size_t pending{0};
+        uint32_t node{0};
+        while (true) {
+            if (const BvhNode &current{nodes[node]}; current.is_leaf()) {
+                visit_leaf(current.first, current.count);
+            } else {
+                uint32_t near_child{current.first};
+                uint32_t far_child{current.first + 1};
+                float near_t{enter_box(nodes[near_child].bounds, ray, inverse_direction, nearest_t)};
+                float far_t{enter_box(nodes[far_child].bounds, ray, inverse_direction, nearest_t)};
+                if (far_t < near_t) {
+                    std::swap(near_child, far_child);
+                    std::swap(near_t, far_t);
+                }
+                if (near_t != miss) {
+                    if (far_t != miss && pending < stack.size()) {
+                        stack[pending++] = {far_child, far_t};
+                    }
+                    node = near_child;
+                    continue;
+                }
+            }
+            while (pending > 0 && stack[pending - 1].t > nearest_t) {
+                --pending;
+            }
+            if (pending == 0) {
+                return;
+            }
+            node = stack[--pending].node;
+        }
+    }
+
+    // The way back up a tree, for refitting only what is above the primitives that moved
+    struct BvhLinks {
+        static constexpr uint32_t none{UINT32_MAX};
+        // parent of every node; none for the root
+        std::vector<uint32_t> parents;
+        // leaf holding every primitive; none for those left out of the tree
+        std::vector<uint32_t> leaves;
+    };
+
+    BvhLinks bvh_links(const Bvh &bvh, size_t primitive_count);
+
+    // Recomputes every box from the primitive bounds, keeping the shape of the tree, in one pass from the last node
+    // back to the root. Much cheaper than a rebuild, but the tree gets worse the further things move from where it
+    // was built, and a primitive left out for having no bounds stays out.
+    void refit_bvh(Bvh &bvh, std::span<const Bounds> bounds);
+
+    // The same for only the boxes above the moved primitives, stopping on each path at the first box that comes out
+    // unchanged. Returns the number of boxes recomputed.
+    uint32_t refit_bvh(Bvh &bvh, const BvhLinks &links, std::span<const Bounds> bounds,
+                       std::span<const uint32_t> moved);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_BVH_HPP
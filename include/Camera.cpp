@@ -0,0 +1,125 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include "Camera.hpp"
+#include "MatrixImpl.hpp"
+
+namespace raytracer {
+    Camera::Camera(const uint32_t hsize, const uint32_t vsize, const double field_of_view)
+        : hsize(hsize), vsize(vsize), field_of_view(field_of_view) {
+        const double half_view{std::tan(field_of_view / 2)};
+        const double aspect{static_cast<double>(hsize) / static_cast<double>(vsize)};
+        if (aspect >= 1) {
+            half_width = half_view;
+            half_height = half_view / aspect;
+        } else {
+            half_width = half_view * aspect;
+            half_height = half_view;
+        }
+        pixel_size = half_width * 2 / hsize;
+        place_canvas();
+    }
+
+    bool Camera::set_transform(const Container<double> &t) {
+        const auto inverted{inverse(t)};
+        if (!inverted.has_value()) {
+            return false;
+        }
+        transform = t;
+        inverse_transform = inverted.value();
+        place_canvas();
+        return true;
+    }
+
+    void Camera::place_canvas() {
+        // camera space to world through the inverse transform; the camera looks toward -z, so +x is to the left
+        const auto &m{inverse_transform.m_data};
+        const auto to_world{[&m](const double x, const double y, const double z, const double w) {
+            std::array<double, 3> world{};
+            for (size_t row = 0; row < 3; ++row) {
+                world[row] = m[row * 4] * x + m[row * 4 + 1] * y + m[row * 4 + 2] * z + m[row * 4 + 3] * w;
+            }
+            return world;
+        }};
+        eye = to_world(0, 0, 0, 1);
+        canvas_corner = to_world(half_width, half_height, -1, 1);
+        step_x = to_world(-pixel_size, 0, 0, 0);
+        step_y = to_world(0, -pixel_size, 0, 0);
+    }
+
+    Ray Camera::ray_for_pixel(const uint32_t px, const uint32_t py) const {
+        return ray_for_pixel(px, py, SubPixel{});
+    }
+
+    Ray Camera::ray_for_pixel(const uint32_t px, const uint32_t py, const SubPixel &offset) const {
+        Ray ray;
+        rays_for_row(py, px, {&ray, 1}, offset);
+        return ray;
+    }
+
+    void Camera::rays_for_row(const uint32_t py, const uint32_t px_begin, const std::span<Ray> rays,
+                              const SubPixel &offset) const {
+        const Point origin{static_cast<float>(eye[0]), static_cast<float>(eye[1]), static_cast<float>(eye[2])};
+        const double across{px_begin + static_cast<double>(offset.x)};
+        const double down{py + static_cast<double>(offset.y)};
+        // on the canvas relative to the eye, moved one step along the row per ray
+        std::array<double, 3> to_pixel{};
+        for (size_t axis = 0; axis < 3; ++axis) {
+            to_pixel[axis] = canvas_corner[axis] + across * step_x[axis] + down * step_y[axis] - eye[axis];
+        }
+        for (Ray &ray: rays) {
+            ray = Ray{
+                origin, Vector::normalize(Vector{
+                    static_cast<float>(to_pixel[0]), static_cast<float>(to_pixel[1]), static_cast<float>(to_pixel[2])
+                })
+            };
+            for (size_t axis = 0; axis < 3; ++axis) {
+                to_pixel[axis] += step_x[axis];
+            }
+        }
+    }
+
+    void Camera::packet_for_row(const uint32_t py, const uint32_t px_begin, RayPacket &packet,
+                                const SubPixel &offset) const {
+        std::array<Ray, RayPacket::width> rays;
+        packet.count = std::min(RayPacket::width, hsize - std::min(px_begin, hsize));
+        rays_for_row(py, px_begin, {rays.data(), packet.count}, offset);
+        packet.origin = rays[0].origin;
+        for (uint32_t i = 0; i < packet.count; ++i) {
+            packet.x[i] = rays[i].direction.x;
+            packet.y[i] = rays[i].direction.y;
+            packet.z[i] = rays[i].direction.z;
+        }
+    }
+
+    SubPixel jitter(const uint32_t px, const uint32_t py, const uint32_t sample, const uint32_t seed) {
+        // one round of a 64-bit mix over everything that picks the point
+        uint64_t h{uint64_t{px} << 32 | py};
+        h ^= (uint64_t{sample} << 32 | seed) * 0x9e3779b97f4a7c15u;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9u;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebu;
+        h ^= h >> 31;
+        const uint32_t cell{sample % 16};
+        const auto unit{[](const uint64_t bits) { return static_cast<float>(bits & 0xffffff) / 0x1000000; }};
+        return SubPixel{
+            (static_cast<float>(cell % 4) + unit(h)) / 4, (static_cast<float>(cell / 4) + unit(h >> 24)) / 4
+        };
+    }
+
+    Container<double> view_transform(const Point &from, const Point &to, const Vector &up) {
+        const Vector forward{Vector::normalize(to - from)};
+        const Vector left{Vector::cross(forward, Vector::normalize(up))};
+        const Vector true_up{Vector::cross(left, forward)};
+        const Container<double> orientation{4, 4, std::vector<double>{
+            left.x, left.y, left.z, 0,
+            true_up.x, true_up.y, true_up.z, 0,
+            -forward.x, -forward.y, -forward.z, 0,
+            0, 0, 0, 1
+        }};
+        return multiply(orientation, translation<double>(-from.x, -from.y, -from.z));
+    }
+}
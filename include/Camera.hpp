@@ -0,0 +1,92 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_CAMERA_HPP
+#define THE_RAYTRACER_CHALLENGE_CAMERA_HPP
+
+#include <array>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include "Intersect.hpp"
+#include "Matrix.hpp"
+
+namespace raytracer {
+    // where in a pixel a ray passes, each from 0 to 1 across it; the default is the centre
+    struct SubPixel {
+        float x{0.5f};
+        float y{0.5f};
+    };
+
+    // Rays in SoA layout: one origin, as every ray of a pinhole camera shares it, and a column per direction
+    // component, so a kernel can load the same component of every ray in the packet at once
+    struct RayPacket {
+        static constexpr uint32_t width{16};
+
+        Point origin{};
+        std::array<float, width> x{};
+        std::array<float, width> y{};
+        std::array<float, width> z{};
+        // rays in use, from the first
+        uint32_t count{0};
+
+        [[nodiscard]] Ray ray(const uint32_t i) const { return Ray{origin, Vector{x[i], y[i], z[i]}}; }
+    };
+
+    // Pinhole camera looking down -z from the origin of its own space, with the canvas one unit in front of it.
+    // The transform moves the world relative to the camera, as produced by view_transform.
+    //
+    // The constructor and set_transform work out, once, where the camera is in the world and where its canvas is:
+    // a corner and the steps from one pixel to the next along a row and down a column. A ray is then that corner
+    // plus a multiple of each step, so generating one needs no matrix, and a row of them is the previous pixel plus
+    // a step each.
+    struct Camera {
+        uint32_t hsize{100};
+        uint32_t vsize{100};
+        double field_of_view{std::numbers::pi / 2};
+        Container<double> transform{Container<double>::identity(4)};
+        // kept alongside transform so rays do not invert a matrix per pixel
+        Container<double> inverse_transform{Container<double>::identity(4)};
+        double half_width{1};
+        double half_height{1};
+        double pixel_size{0.02};
+        // in the world, derived from the fields above: the eye, the top left corner of the canvas, and the steps
+        // to the next pixel right and down
+        std::array<double, 3> eye{};
+        std::array<double, 3> canvas_corner{};
+        std::array<double, 3> step_x{};
+        std::array<double, 3> step_y{};
+
+        Camera(uint32_t hsize, uint32_t vsize, double field_of_view);
+
+        // false, keeping the transform it had, when t cannot be inverted
+        bool set_transform(const Container<double> &t);
+
+        // ray from the camera through the centre of pixel (px, py)
+        [[nodiscard]] Ray ray_for_pixel(uint32_t px, uint32_t py) const;
+
+        // through the given point of pixel (px, py), for taking several samples of it
+        [[nodiscard]] Ray ray_for_pixel(uint32_t px, uint32_t py, const SubPixel &offset) const;
+
+        // rays through pixels px_begin, px_begin + 1, ... of row py, one for each element of rays
+        void rays_for_row(uint32_t py, uint32_t px_begin, std::span<Ray> rays, const SubPixel &offset = {}) const;
+
+        // as many rays of row py from px_begin on as fit in a packet, fewer at the end of the row
+        void packet_for_row(uint32_t py, uint32_t px_begin, RayPacket &packet, const SubPixel &offset = {}) const;
+
+    private:
+        // eye, corner and steps from the transform and canvas size
+        void place_canvas();
+    };
+
+    // A point in pixel (px, py) for sample number sample, the same every time it is asked for. Samples of a pixel
+    // fall in different cells of a 4x4 grid over it, at a hashed point in each, so the first sixteen cover the pixel
+    // evenly; the seed moves every point, for a different pattern per frame.
+    SubPixel jitter(uint32_t px, uint32_t py, uint32_t sample, uint32_t seed = 0);
+
+    // orient the world so that an eye at from looks towards to, with up roughly up
+    Container<double> view_transform(const Point &from, const Point &to, const Vector &up);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_CAMERA_HPP
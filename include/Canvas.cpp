@@ -3,53 +3,180 @@
 //
 
 #include <fstream>
-#include <print>
-#include <algorithm>
+#include <charconv>
 #include "Canvas.hpp"
 
 namespace raytracer {
     void Canvas::write_pixel(uint32_t pix_w, uint32_t pix_h, const Colour &colour) {
-        storage[pix_h * width + pix_w] = {
-            static_cast<uint8_t>(std::clamp(colour.r, 0.0f, 1.0f) * 255),
-            static_cast<uint8_t>(std::clamp(colour.g, 0.0f, 1.0f) * 255),
-            static_cast<uint8_t>(std::clamp(colour.b, 0.0f, 1.0f) * 255)
-        };
+        uint8_t *pixel{storage.data() + offset(pix_w, pix_h)};
+        pixel[0] = to_byte(colour.r);
+        pixel[1] = to_byte(colour.g);
+        pixel[2] = to_byte(colour.b);
+    }
+
+    Canvas convert_layout(const Canvas &canvas, const PixelLayout layout) {
+        Canvas converted{canvas.width, canvas.height, layout};
+        if (layout == canvas.layout) {
+            converted.storage = canvas.storage;
+            return converted;
+        }
+        // a tile_size run of pixels along a row is contiguous in both layouts, so copy those whole, clipped at the
+        // right edge of the image
+        for (uint32_t y = 0; y < canvas.height; ++y) {
+            for (uint32_t x = 0; x < canvas.width; x += Canvas::tile_size) {
+                const size_t bytes{std::min<size_t>(Canvas::tile_size, canvas.width - x) * Canvas::channels};
+                const uint8_t *from{canvas.storage.data() + canvas.offset(x, y)};
+                std::copy_n(from, bytes, converted.storage.data() + converted.offset(x, y));
+            }
+        }
+        return converted;
+    }
+
+    const Canvas &linear_view(const Canvas &canvas, Canvas &scratch) {
+        if (canvas.layout == PixelLayout::linear) {
+            return canvas;
+        }
+        scratch = convert_layout(canvas, PixelLayout::linear);
+        return scratch;
+    }
+
+    std::string ppm_header(const PpmFormat format, const uint32_t width, const uint32_t height) {
+        return std::string{format == PpmFormat::ascii ? "P3\n" : "P6\n"} + std::to_string(width) + " " +
+               std::to_string(height) + "\n255\n";
     }
 
-    std::expected<bool, CanvasError> canvas_to_ppm(const Canvas &canvas, const std::string &file_path) {
-        std::ofstream out_file(file_path, std::ios::trunc);
+    void write_ppm_rows(std::ostream &out, const PpmFormat format, const uint32_t width,
+                        const std::span<const uint8_t> rgb) {
+        if (format == PpmFormat::binary) {
+            out.write(reinterpret_cast<const char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+            return;
+        }
+        // one pixel per line, "r g b"; at most 12 characters each, so format a whole row at a time
+        const size_t row_bytes{size_t{width} * Canvas::channels};
+        if (row_bytes == 0) {
+            return;
+        }
+        std::string out_str(size_t{width} * 12, '\0');
+        for (size_t start = 0; start + row_bytes <= rgb.size(); start += row_bytes) {
+            char *cursor{out_str.data()};
+            for (size_t i = 0; i < row_bytes; ++i) {
+                cursor = std::to_chars(cursor, out_str.data() + out_str.size(), rgb[start + i]).ptr;
+                *cursor++ = (i + 1) % Canvas::channels == 0 ? '\n' : ' ';
+            }
+            out.write(out_str.data(), cursor - out_str.data());
+        }
+    }
+
+    std::expected<bool, CanvasError> canvas_to_ppm(const Canvas &canvas, const std::string &file_path,
+                                                   const PpmFormat format) {
+        std::ofstream out_file(file_path, std::ios::trunc | std::ios::binary);
         if (!out_file) {
             return std::unexpected(CanvasError::invalid_path);
         }
-        const std::string header{
-            "P3\n" + std::to_string(canvas.width) + " " + std::to_string(canvas.height) + "\n255\n"
-        };
-        out_file << header;
-        for (const auto &row: canvas.storage) {
-            const std::vector<std::string> strings =
-                    row | std::views::transform([](int n) { return std::to_string(n); })
-                    | std::ranges::to<std::vector<std::string> >();
-            //            auto out_str = std::ranges::to<std::string>(std::views::join_with(strings, ' '));
-            /*
-            if (out_str.size() > 70) {
-                out_file << out_str.substr(0,  70);
-                out_file << "\n";
-                out_file << out_str.substr(71);
+        Canvas scratch{0, 0};
+        const Canvas &linear{linear_view(canvas, scratch)};
+        out_file << ppm_header(format, canvas.width, canvas.height);
+        write_ppm_rows(out_file, format, canvas.width, linear.storage);
+        if (!out_file) {
+            return std::unexpected(CanvasError::write_failed);
+        }
+        return true;
+    }
+
+    namespace {
+        constexpr bool is_space(const uint8_t c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+        }
+
+        // Reads the next unsigned integer, skipping whitespace and, when in the header, '#' comments. Hand rolled
+        // because the pixel data of a P3 file is millions of these and nothing more elaborate is needed.
+        struct PpmCursor {
+            std::span<const uint8_t> data;
+            size_t position{0};
+
+            std::expected<uint32_t, CanvasError> next(const bool allow_comments) {
+                while (position < data.size()) {
+                    if (is_space(data[position])) {
+                        ++position;
+                    } else if (allow_comments && data[position] == '#') {
+                        while (position < data.size() && data[position] != '\n') {
+                            ++position;
+                        }
+                    } else {
+                        break;
+                    }
+                }
+                if (position >= data.size() || data[position] < '0' || data[position] > '9') {
+                    return std::unexpected(CanvasError::malformed);
+                }
+                uint64_t value{0};
+                while (position < data.size() && data[position] >= '0' && data[position] <= '9') {
+                    value = value * 10 + (data[position++] - '0');
+                    if (value > UINT32_MAX) {
+                        return std::unexpected(CanvasError::malformed);
+                    }
+                }
+                return static_cast<uint32_t>(value);
             }
-            else {
-                out_file << out_str;
+        };
+    }
+
+    std::expected<Canvas, CanvasError> parse_ppm(const std::span<const uint8_t> data) {
+        if (data.size() < 2 || data[0] != 'P' || (data[1] != '3' && data[1] != '6')) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        const PpmFormat format{data[1] == '3' ? PpmFormat::ascii : PpmFormat::binary};
+        PpmCursor cursor{data, 2};
+        const auto width{cursor.next(true)};
+        const auto height{cursor.next(true)};
+        const auto max_value{cursor.next(true)};
+        if (!width || !height || !max_value || *max_value == 0 || *max_value > 255) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        // what the header asks for has to be there before anything is allocated for it: a P6 byte per channel, or
+        // for P3 at least a separator and a digit
+        const size_t remaining{data.size() - std::min(data.size(), cursor.position + 1)};
+        const size_t available{format == PpmFormat::binary ? remaining : (data.size() - cursor.position) / 2};
+        if (*height != 0 && *width > available / *height / Canvas::channels) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        Canvas canvas{*width, *height};
+        if (format == PpmFormat::binary) {
+            // exactly one whitespace byte separates the header from the pixels
+            const size_t start{cursor.position + 1};
+            if (start > data.size() || data.size() - start < canvas.storage.size()) {
+                return std::unexpected(CanvasError::malformed);
             }
-            */
-            //            std::println("{} {}", std::to_string(index), out_str);
-            std::string out_str;
-            for (size_t i = 0; i < strings.size(); ++i) {
-                out_str += strings[i];
-                if (i < strings.size() - 1) {
-                    out_str += ' ';
+            std::copy_n(data.begin() + static_cast<std::ptrdiff_t>(start), canvas.storage.size(),
+                        canvas.storage.begin());
+        } else {
+            for (auto &channel: canvas.storage) {
+                const auto value{cursor.next(false)};
+                if (!value || *value > *max_value) {
+                    return std::unexpected(CanvasError::malformed);
                 }
+                channel = static_cast<uint8_t>(*value);
             }
-            out_file << out_str << "\n";
         }
-        return true;
+        if (*max_value != 255) {
+            const uint32_t scale{*max_value};
+            for (auto &channel: canvas.storage) {
+                channel = static_cast<uint8_t>((std::min<uint32_t>(channel, scale) * 255u + scale / 2) / scale);
+            }
+        }
+        return canvas;
+    }
+
+    std::expected<Canvas, CanvasError> ppm_to_canvas(const std::string &file_path) {
+        std::ifstream in_file(file_path, std::ios::binary | std::ios::ate);
+        if (!in_file) {
+            return std::unexpected(CanvasError::invalid_path);
+        }
+        std::vector<uint8_t> contents(static_cast<size_t>(in_file.tellg()));
+        in_file.seekg(0);
+        if (!in_file.read(reinterpret_cast<char *>(contents.data()), static_cast<std::streamsize>(contents.size()))) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        return parse_ppm(contents);
     }
 }
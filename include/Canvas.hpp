@@ -9,6 +9,10 @@
 #include <vector>
 #include <expected>
 #include <ranges>
+#include <span>
+#include <string>
+#include <ostream>
+#include <algorithm>
 #include "Colour.hpp"
 
 namespace raytracer {
@@ -16,17 +20,103 @@ namespace raytracer {
         bad_dimensions
     };
     enum class CanvasError {
-        invalid_path
+        invalid_path,
+        dimension_mismatch,
+        write_failed,
+        incomplete,
+        unsupported,
+        malformed
     };
+    enum class PixelLayout {
+        // rows one after another
+        linear,
+        // square tiles of Canvas::tile_size pixels, each contiguous and row-major inside, with the tiles themselves in
+        // row-major order; storage is padded out to whole tiles
+        tiled
+    };
+    enum class PpmFormat {
+        // P3, one "r g b" pixel per line
+        ascii,
+        // P6, packed bytes
+        binary
+    };
+
+    // quantise a single channel the way write_pixel always has: clamp to [0, 1] and truncate
+    constexpr uint8_t to_byte(const float channel) {
+        return static_cast<uint8_t>(std::clamp(channel, 0.0f, 1.0f) * 255);
+    }
+
     struct Canvas {
+        static constexpr uint32_t channels{3};
+        // 16x16 RGB is 768 bytes, twelve cache lines, and matches the tile size renderers hand out
+        static constexpr uint32_t tile_size{16};
+
         uint32_t width{0};
         uint32_t height{0};
-        std::vector<std::vector<uint8_t>> storage{width * height, {0, 0, 0}};
+        PixelLayout layout{PixelLayout::linear};
+        // tightly packed RGB bytes, ordered according to layout
+        std::vector<uint8_t> storage{};
 
-        explicit constexpr Canvas(const unsigned w, const unsigned h) : width(w), height(h) {};
+        explicit constexpr Canvas(const unsigned w, const unsigned h, const PixelLayout l = PixelLayout::linear)
+            : width(w), height(h), layout(l), storage(storage_size(w, h, l), 0) {};
         void write_pixel(uint32_t pix_w, uint32_t pix_h, const Colour& colour);
+
+        [[nodiscard]] static constexpr size_t storage_size(const uint32_t w, const uint32_t h, const PixelLayout l) {
+            if (l == PixelLayout::linear) {
+                return size_t{w} * h * channels;
+            }
+            return size_t{(w + tile_size - 1) / tile_size} * ((h + tile_size - 1) / tile_size) * tile_size *
+                   tile_size * channels;
+        }
+
+        [[nodiscard]] constexpr uint32_t tiles_x() const { return (width + tile_size - 1) / tile_size; }
+
+        [[nodiscard]] constexpr uint32_t tiles_y() const { return (height + tile_size - 1) / tile_size; }
+
+        // byte offset of a pixel in storage
+        [[nodiscard]] constexpr size_t offset(const uint32_t pix_w, const uint32_t pix_h) const {
+            if (layout == PixelLayout::linear) {
+                return (size_t{pix_h} * width + pix_w) * channels;
+            }
+            const size_t tile{size_t{pix_h / tile_size} * tiles_x() + pix_w / tile_size};
+            return (tile * tile_size * tile_size + (pix_h % tile_size) * tile_size + pix_w % tile_size) * channels;
+        }
+
+        [[nodiscard]] constexpr std::span<const uint8_t, channels> pixel(const uint32_t pix_w, const uint32_t pix_h) const {
+            return std::span<const uint8_t, channels>{storage.data() + offset(pix_w, pix_h), channels};
+        }
+
+        // one row of the image; linear layout only
+        [[nodiscard]] constexpr std::span<uint8_t> row(const uint32_t pix_h) {
+            return {storage.data() + size_t{pix_h} * width * channels, size_t{width} * channels};
+        }
+
+        // The pixels of tile (tile_w, tile_h) as tile_size rows of tile_size pixels; tiled layout only. Tiles on the
+        // right and bottom edges include padding pixels past width and height, which are never encoded.
+        [[nodiscard]] constexpr std::span<uint8_t> tile(const uint32_t tile_w, const uint32_t tile_h) {
+            constexpr size_t tile_bytes{size_t{tile_size} * tile_size * channels};
+            return {storage.data() + (size_t{tile_h} * tiles_x() + tile_w) * tile_bytes, tile_bytes};
+        }
     };
-    std::expected<bool, CanvasError> canvas_to_ppm(const Canvas& canvas, const std::string& file_path);
+
+    // the same image in the requested layout
+    Canvas convert_layout(const Canvas& canvas, PixelLayout layout);
+
+    // canvas itself when it is already linear, otherwise a linear copy made in scratch. Encoders and anything else
+    // that walks whole rows go through this once rather than paying for the tile lookup per pixel.
+    const Canvas& linear_view(const Canvas& canvas, Canvas& scratch);
+
+    std::string ppm_header(PpmFormat format, uint32_t width, uint32_t height);
+    // write whole rows of packed RGB bytes in the body format of a PPM file
+    void write_ppm_rows(std::ostream& out, PpmFormat format, uint32_t width, std::span<const uint8_t> rgb);
+
+    std::expected<bool, CanvasError> canvas_to_ppm(const Canvas& canvas, const std::string& file_path,
+                                                   PpmFormat format = PpmFormat::ascii);
+
+    // P3 or P6 with a maximum value of up to 255; comments in the header are skipped and other maxima are rescaled
+    std::expected<Canvas, CanvasError> parse_ppm(std::span<const uint8_t> data);
+
+    std::expected<Canvas, CanvasError> ppm_to_canvas(const std::string& file_path);
 }
 
 #endif //THE_RAYTRACER_CHALLENGE_CANVAS_HPP
@@ -0,0 +1,483 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "CompiledScene.hpp"
+#include "MatrixImpl.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RAYTRACER_HAS_MMAP 1
+#endif
+
+namespace raytracer {
+    namespace {
+        constexpr std::array<char, 8> scene_cache_magic{'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+        constexpr uint32_t native_byte_order{0x01020304};
+        // arrays start on cache line boundaries
+        constexpr size_t column_alignment{64};
+
+        // A file next to file_path that no other writer uses: the process and a count of the caches it has written
+        // are in the name, so neither another process nor another thread of this one writes into it at the same time.
+        std::string temporary_path_for(const std::string &file_path) {
+            static std::atomic<uint64_t> written{0};
+#ifdef RAYTRACER_HAS_MMAP
+            const auto process{static_cast<uint64_t>(::getpid())};
+#else
+            static const auto process{static_cast<uint64_t>(std::random_device{}())};
+#endif
+            return file_path + "." + std::to_string(process) + "." +
+                   std::to_string(written.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+        }
+
+        static_assert(std::is_trivially_copyable_v<CompiledSceneHeader>);
+        static_assert(std::is_trivially_copyable_v<PointLight>);
+        static_assert(std::is_trivially_copyable_v<Matrix4>);
+        static_assert(std::is_trivially_copyable_v<Bounds>);
+        static_assert(std::is_trivially_copyable_v<BvhNode>);
+        static_assert(std::is_trivially_copyable_v<CompiledGeometry>);
+
+        constexpr size_t align_up(const size_t value, const size_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        bool column_fits(const uint64_t offset, const uint64_t count, const size_t element_size, const uint64_t size) {
+            return offset % column_alignment == 0 && offset <= size && count <= (size - offset) / element_size;
+        }
+
+        // everything map() needs to trust before handing out spans into the file
+        std::expected<bool, SceneCacheError> validate(const CompiledSceneHeader &header, const uint64_t size) {
+            if (header.magic != scene_cache_magic || header.byte_order != native_byte_order) {
+                return std::unexpected(SceneCacheError::malformed);
+            }
+            if (header.version != scene_cache_version) {
+                return std::unexpected(SceneCacheError::version_mismatch);
+            }
+            bool fits{header.total_size == size};
+            fits = fits && column_fits(header.lights_offset, header.light_count, sizeof(PointLight), size);
+            fits = fits && column_fits(header.inverse_transforms_offset, header.object_count, sizeof(Matrix4), size);
+            fits = fits && column_fits(header.bounds_offset, header.object_count, sizeof(Bounds), size);
+            fits = fits && column_fits(header.object_materials_offset, header.object_count, sizeof(uint32_t), size);
+            for (const uint64_t offset: header.material_offsets) {
+                fits = fits && column_fits(offset, header.material_count, sizeof(float), size);
+            }
+            fits = fits && column_fits(header.geometries_offset, header.geometry_count, sizeof(CompiledGeometry), size);
+            fits = fits && column_fits(header.object_geometries_offset, header.object_count, sizeof(uint32_t), size);
+            fits = fits && column_fits(header.mesh_nodes_offset, header.mesh_node_count, sizeof(BvhNode), size);
+            for (const uint64_t offset: header.triangle_offsets) {
+                fits = fits && column_fits(offset, header.triangle_count, sizeof(float), size);
+            }
+            fits = fits && column_fits(header.bvh_nodes_offset, header.bvh_node_count, sizeof(BvhNode), size);
+            fits = fits && column_fits(header.bvh_indices_offset, header.bvh_index_count, sizeof(uint32_t), size);
+            if (!fits) {
+                return std::unexpected(SceneCacheError::malformed);
+            }
+            return true;
+        }
+
+        // Every child link and leaf range of nodes stays within node_count nodes and index_count leaf entries, and
+        // children come after their parent, as build_bvh() places them, so no walk down the tree can loop.
+        bool tree_fits(const std::span<const BvhNode> nodes, const uint32_t node_count, const uint32_t index_count) {
+            for (uint32_t i = 0; i < nodes.size(); ++i) {
+                const BvhNode &node{nodes[i]};
+                const bool fits{
+                    node.is_leaf()
+                        ? node.first <= index_count && node.count <= index_count - node.first
+                        : node.first > i && node.first < node_count && node.first + 1 < node_count
+                };
+                if (!fits) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool below(const std::span<const uint32_t> values, const uint32_t limit) {
+            return std::ranges::all_of(values, [limit](const uint32_t value) { return value < limit; });
+        }
+
+        // traversal follows child links, leaf ranges and geometry and material numbers without checking them, so a
+        // cache must not point outside its own arrays
+        bool indices_fit(const CompiledScene &scene) {
+            const CompiledSceneHeader &header{scene.header()};
+            for (const CompiledGeometry &geometry: scene.geometries()) {
+                const bool fits{
+                    geometry.shape == Shape::sphere ||
+                    (geometry.shape == Shape::mesh && geometry.first_node <= header.mesh_node_count &&
+                     geometry.node_count <= header.mesh_node_count - geometry.first_node &&
+                     geometry.first_triangle <= header.triangle_count &&
+                     geometry.triangle_count <= header.triangle_count - geometry.first_triangle &&
+                     tree_fits(scene.mesh_nodes(geometry), geometry.node_count, geometry.triangle_count))
+                };
+                if (!fits) {
+                    return false;
+                }
+            }
+            return tree_fits(scene.bvh_nodes(), header.bvh_node_count, header.bvh_index_count) &&
+                   below(scene.bvh_indices(), header.object_count) &&
+                   below(scene.materials().object_material, header.material_count) &&
+                   below(scene.object_geometries(), header.geometry_count);
+        }
+
+        template<typename T>
+        T *column_at(std::vector<std::byte> &blob, const uint64_t offset) {
+            return reinterpret_cast<T *>(blob.data() + offset);
+        }
+    }
+
+    CompiledScene::CompiledScene(std::vector<std::byte> &&owned, const std::byte *data)
+        : owned(std::move(owned)), data(data) {
+    }
+
+    CompiledScene::CompiledScene(void *mapping, const size_t mapping_size)
+        : mapping(mapping), mapping_size(mapping_size), data(static_cast<const std::byte *>(mapping)) {
+    }
+
+    CompiledScene::CompiledScene(CompiledScene &&other) noexcept
+        : owned(std::move(other.owned)),
+          mapping(std::exchange(other.mapping, nullptr)),
+          mapping_size(std::exchange(other.mapping_size, 0)),
+          data(std::exchange(other.data, nullptr)),
+          shading(std::move(other.shading)) {
+    }
+
+    CompiledScene &CompiledScene::operator=(CompiledScene &&other) noexcept {
+        if (this != &other) {
+            release();
+            owned = std::move(other.owned);
+            mapping = std::exchange(other.mapping, nullptr);
+            mapping_size = std::exchange(other.mapping_size, 0);
+            data = std::exchange(other.data, nullptr);
+            shading = std::move(other.shading);
+        }
+        return *this;
+    }
+
+    CompiledScene::~CompiledScene() {
+        release();
+    }
+
+    struct CompiledScene::Objects {
+        std::vector<Matrix4> inverses;
+        std::vector<Bounds> bounds;
+        std::vector<uint32_t> materials;
+        std::vector<uint32_t> geometries;
+        MaterialTable material_table;
+        std::vector<CompiledGeometry> geometry_table{CompiledGeometry{}};
+        std::vector<BvhNode> mesh_nodes;
+        std::array<std::vector<float>, 9> triangles;
+
+        explicit Objects(const size_t count) : inverses(count), bounds(count), materials(count), geometries(count) {
+        }
+    };
+
+    CompiledScene CompiledScene::compile(const Scene &scene, const SceneSource source, const BvhOptions &options) {
+        Objects objects{scene.spheres.size()};
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, scene.spheres.size(), 1024, [&](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                // a singular transform gets an all-zero inverse, which no ray can hit, and no extent
+                const auto inverted{invert(scene.spheres[i].transform)};
+                objects.inverses[i] = inverted.value_or(Matrix4{.m = {}});
+                if (inverted.has_value()) {
+                    objects.bounds[i] = sphere_bounds(Matrix4::from(scene.spheres[i].transform));
+                }
+            }
+        });
+        for (size_t i = 0; i < scene.spheres.size(); ++i) {
+            objects.materials[i] = objects.material_table.add(scene.spheres[i].material);
+        }
+        return assemble(scene.camera, scene.lights, objects, source, options);
+    }
+
+    CompiledScene CompiledScene::compile(const InstancedScene &scene, const SceneSource source,
+                                         const BvhOptions &options) {
+        Objects objects{scene.instances.size()};
+        // the scene's table is already free of duplicates, so every index carries over as it is
+        for (const auto &material: scene.materials.entries()) {
+            objects.material_table.add(material);
+        }
+        // each mesh gets its own tree, stored after the ones before it with its links counted from its own start
+        objects.geometry_table.clear();
+        std::vector<Bounds> object_space_bounds;
+        for (const Geometry &geometry: scene.geometries) {
+            CompiledGeometry compiled{.shape = geometry.shape};
+            Bounds extent{{-1, -1, -1}, {1, 1, 1}};
+            if (geometry.shape == Shape::mesh) {
+                const Mesh &mesh{scene.meshes[geometry.mesh]};
+                const MeshBvh built{build_mesh_bvh(mesh, options)};
+                compiled.first_node = static_cast<uint32_t>(objects.mesh_nodes.size());
+                compiled.node_count = static_cast<uint32_t>(built.bvh.nodes.size());
+                compiled.first_triangle = static_cast<uint32_t>(objects.triangles[0].size());
+                compiled.triangle_count = static_cast<uint32_t>(built.bvh.indices.size());
+                objects.mesh_nodes.insert(objects.mesh_nodes.end(), built.bvh.nodes.begin(), built.bvh.nodes.end());
+                for (size_t i = 0; i < objects.triangles.size(); ++i) {
+                    objects.triangles[i].insert(objects.triangles[i].end(), built.corners[i].begin(),
+                                                built.corners[i].end());
+                }
+                extent = built.bvh.nodes.empty() ? Bounds{} : built.bvh.nodes[0].bounds;
+            }
+            objects.geometry_table.push_back(compiled);
+            object_space_bounds.push_back(extent);
+        }
+        // each transform is inverted once however many instances share it
+        std::vector<std::optional<Matrix4>> inverses(scene.transforms.size());
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, scene.transforms.size(), 1024, [&](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                if (const auto inverted{invert(scene.transforms[i])}; inverted.has_value()) {
+                    inverses[i] = inverted.value();
+                }
+            }
+        });
+        pool.parallel_for(0, scene.instances.size(), 1024, [&](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const Instance &instance{scene.instances[i]};
+                const auto &inverse{inverses[instance.transform]};
+                const Matrix4 &transform{scene.transforms[instance.transform]};
+                objects.inverses[i] = inverse.value_or(Matrix4{.m = {}});
+                if (inverse.has_value()) {
+                    objects.bounds[i] = scene.geometries[instance.geometry].shape == Shape::sphere
+                                            ? sphere_bounds(transform)
+                                            : transformed_bounds(object_space_bounds[instance.geometry], transform);
+                }
+                objects.materials[i] = instance.material;
+                objects.geometries[i] = instance.geometry;
+            }
+        });
+        return assemble(scene.camera, scene.lights, objects, source, options);
+    }
+
+    CompiledScene CompiledScene::assemble(const Camera &camera, const std::span<const PointLight> lights,
+                                          const Objects &objects, const SceneSource source,
+                                          const BvhOptions &options) {
+        const size_t object_count{objects.inverses.size()};
+        const auto materials{objects.material_table.entries()};
+        const size_t triangle_count{objects.triangles[0].size()};
+        CompiledSceneHeader header{
+            .magic = scene_cache_magic, .version = scene_cache_version, .byte_order = native_byte_order,
+            .source = source, .hsize = camera.hsize, .vsize = camera.vsize, .field_of_view = camera.field_of_view,
+            .light_count = static_cast<uint32_t>(lights.size()), .object_count = static_cast<uint32_t>(object_count),
+            .material_count = static_cast<uint32_t>(materials.size()),
+            .geometry_count = static_cast<uint32_t>(objects.geometry_table.size()),
+            .mesh_node_count = static_cast<uint32_t>(objects.mesh_nodes.size()),
+            .triangle_count = static_cast<uint32_t>(triangle_count)
+        };
+        std::copy_n(camera.transform.m_data.begin(), 16, header.camera_transform.begin());
+
+        size_t size{sizeof(CompiledSceneHeader)};
+        const auto reserve = [&size](const size_t bytes) {
+            const size_t offset{align_up(size, column_alignment)};
+            size = offset + bytes;
+            return offset;
+        };
+        header.lights_offset = reserve(lights.size() * sizeof(PointLight));
+        header.inverse_transforms_offset = reserve(object_count * sizeof(Matrix4));
+        header.bounds_offset = reserve(object_count * sizeof(Bounds));
+        header.object_materials_offset = reserve(object_count * sizeof(uint32_t));
+        for (auto &offset: header.material_offsets) {
+            offset = reserve(materials.size() * sizeof(float));
+        }
+        header.geometries_offset = reserve(objects.geometry_table.size() * sizeof(CompiledGeometry));
+        header.object_geometries_offset = reserve(object_count * sizeof(uint32_t));
+        header.mesh_nodes_offset = reserve(objects.mesh_nodes.size() * sizeof(BvhNode));
+        for (auto &offset: header.triangle_offsets) {
+            offset = reserve(triangle_count * sizeof(float));
+        }
+        const Bvh bvh{build_bvh(objects.bounds, options)};
+        header.bvh_node_count = static_cast<uint32_t>(bvh.nodes.size());
+        header.bvh_index_count = static_cast<uint32_t>(bvh.indices.size());
+        header.bvh_nodes_offset = reserve(bvh.nodes.size() * sizeof(BvhNode));
+        header.bvh_indices_offset = reserve(bvh.indices.size() * sizeof(uint32_t));
+        header.bvh_stats = bvh.stats;
+        header.total_size = size;
+
+        std::vector<std::byte> blob(size);
+        std::ranges::copy(lights, column_at<PointLight>(blob, header.lights_offset));
+        std::ranges::copy(objects.inverses, column_at<Matrix4>(blob, header.inverse_transforms_offset));
+        std::ranges::copy(objects.bounds, column_at<Bounds>(blob, header.bounds_offset));
+        std::ranges::copy(objects.materials, column_at<uint32_t>(blob, header.object_materials_offset));
+        std::ranges::copy(objects.geometry_table, column_at<CompiledGeometry>(blob, header.geometries_offset));
+        std::ranges::copy(objects.geometries, column_at<uint32_t>(blob, header.object_geometries_offset));
+        std::ranges::copy(objects.mesh_nodes, column_at<BvhNode>(blob, header.mesh_nodes_offset));
+        for (size_t i = 0; i < objects.triangles.size(); ++i) {
+            std::ranges::copy(objects.triangles[i], column_at<float>(blob, header.triangle_offsets[i]));
+        }
+        std::ranges::copy(bvh.nodes, column_at<BvhNode>(blob, header.bvh_nodes_offset));
+        std::ranges::copy(bvh.indices, column_at<uint32_t>(blob, header.bvh_indices_offset));
+        for (const auto &bounds: objects.bounds) {
+            header.scene_bounds.merge(bounds);
+        }
+        std::array<float *, 10> columns{};
+        for (size_t field = 0; field < columns.size(); ++field) {
+            columns[field] = column_at<float>(blob, header.material_offsets[field]);
+        }
+        for (size_t i = 0; i < materials.size(); ++i) {
+            const Material &material{materials[i]};
+            columns[0][i] = material.colour.r;
+            columns[1][i] = material.colour.g;
+            columns[2][i] = material.colour.b;
+            columns[3][i] = material.ambient;
+            columns[4][i] = material.diffuse;
+            columns[5][i] = material.specular;
+            columns[6][i] = material.shininess;
+            columns[7][i] = material.reflective;
+            columns[8][i] = material.transparency;
+            columns[9][i] = material.refractive_index;
+        }
+        std::memcpy(blob.data(), &header, sizeof(header));
+        const std::byte *data{blob.data()};
+        CompiledScene compiled{std::move(blob), data};
+        compiled.build_shading_table();
+        return compiled;
+    }
+
+    Camera CompiledScene::camera() const {
+        Camera camera{header().hsize, header().vsize, header().field_of_view};
+        camera.set_transform(Container<double>{4, 4, header().camera_transform});
+        return camera;
+    }
+
+    MaterialColumns CompiledScene::materials() const {
+        const auto &offsets{header().material_offsets};
+        const size_t count{header().material_count};
+        return MaterialColumns{
+            column<uint32_t>(header().object_materials_offset, header().object_count),
+            column<float>(offsets[0], count), column<float>(offsets[1], count), column<float>(offsets[2], count),
+            column<float>(offsets[3], count), column<float>(offsets[4], count), column<float>(offsets[5], count),
+            column<float>(offsets[6], count), column<float>(offsets[7], count), column<float>(offsets[8], count),
+            column<float>(offsets[9], count)
+        };
+    }
+
+    void CompiledScene::build_shading_table() {
+        const MaterialColumns columns{materials()};
+        std::vector<Material> entries;
+        entries.reserve(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            entries.push_back(columns.entry(i));
+        }
+        shading = ShadingTable::build(entries, LightSet::from(lights()));
+    }
+
+    TriangleColumns CompiledScene::triangles(const CompiledGeometry &geometry) const {
+        TriangleColumns columns;
+        for (size_t i = 0; i < columns.corners.size(); ++i) {
+            columns.corners[i] = column<float>(header().triangle_offsets[i], header().triangle_count).data() +
+                                 geometry.first_triangle;
+        }
+        return columns;
+    }
+
+    std::expected<bool, SceneCacheError> CompiledScene::write(const std::string &file_path) const {
+        const std::string temporary_path{temporary_path_for(file_path)};
+        {
+            std::ofstream out_file(temporary_path, std::ios::trunc | std::ios::binary);
+            if (!out_file) {
+                return std::unexpected(SceneCacheError::invalid_path);
+            }
+            out_file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(header().total_size));
+            if (!out_file.flush()) {
+                return std::unexpected(SceneCacheError::write_failed);
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary_path, file_path, error);
+        if (error) {
+            std::filesystem::remove(temporary_path, error);
+            return std::unexpected(SceneCacheError::write_failed);
+        }
+        return true;
+    }
+
+#ifdef RAYTRACER_HAS_MMAP
+    std::expected<CompiledScene, SceneCacheError> CompiledScene::map(const std::string &file_path) {
+        const int fd{::open(file_path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return std::unexpected(SceneCacheError::invalid_path);
+        }
+        struct stat status{};
+        if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CompiledSceneHeader)) {
+            ::close(fd);
+            return std::unexpected(SceneCacheError::malformed);
+        }
+        const auto size{static_cast<size_t>(status.st_size)};
+        void *address{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+        // the mapping keeps the file alive on its own
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            return std::unexpected(SceneCacheError::invalid_path);
+        }
+        CompiledScene compiled{address, size};
+        if (const auto valid{validate(compiled.header(), size)}; !valid.has_value()) {
+            return std::unexpected(valid.error());
+        }
+        if (!indices_fit(compiled)) {
+            return std::unexpected(SceneCacheError::malformed);
+        }
+        compiled.build_shading_table();
+        return compiled;
+    }
+
+    void CompiledScene::release() {
+        if (mapping != nullptr) {
+            ::munmap(mapping, mapping_size);
+            mapping = nullptr;
+        }
+        owned.clear();
+        data = nullptr;
+    }
+#else
+    std::expected<CompiledScene, SceneCacheError> CompiledScene::map(const std::string &) {
+        return std::unexpected(SceneCacheError::unsupported);
+    }
+
+    void CompiledScene::release() {
+        owned.clear();
+        data = nullptr;
+    }
+#endif
+
+    std::expected<SceneSource, SceneCacheError> scene_source(const std::string &scene_path) {
+        std::error_code error;
+        const auto size{std::filesystem::file_size(scene_path, error)};
+        if (error) {
+            return std::unexpected(SceneCacheError::invalid_path);
+        }
+        const auto modified{std::filesystem::last_write_time(scene_path, error)};
+        if (error) {
+            return std::unexpected(SceneCacheError::invalid_path);
+        }
+        return SceneSource{size, static_cast<int64_t>(modified.time_since_epoch().count())};
+    }
+
+    std::expected<CompiledScene, SceneParseError> load_compiled_scene(const std::string &scene_path,
+                                                                      const std::string &cache_path) {
+        const auto source{scene_source(scene_path)};
+        if (!source.has_value()) {
+            return std::unexpected(SceneParseError{SceneError::invalid_path});
+        }
+        if (auto cached{CompiledScene::map(cache_path)}; cached.has_value() && cached->header().source == *source) {
+            return std::move(cached.value());
+        }
+        const auto scene{load_scene(scene_path)};
+        if (!scene.has_value()) {
+            return std::unexpected(scene.error());
+        }
+        CompiledScene compiled{CompiledScene::compile(scene.value(), source.value())};
+        [[maybe_unused]] const auto written{compiled.write(cache_path)};
+        return compiled;
+    }
+}
@@ -0,0 +1,241 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_COMPILED_SCENE_HPP
+#define THE_RAYTRACER_CHALLENGE_COMPILED_SCENE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+#include "Bounds.hpp"
+#include "Bvh.hpp"
+#include "Camera.hpp"
+#include "InstancedScene.hpp"
+#include "Light.hpp"
+#include "Material.hpp"
+#include "Matrix4.hpp"
+#include "Mesh.hpp"
+#include "Scene.hpp"
+
+namespace raytracer {
+    enum class SceneCacheError {
+        invalid_path,
+        malformed,
+        version_mismatch,
+        write_failed,
+        unsupported
+    };
+
+    // bumped whenever the layout below changes; caches of any other version are rebuilt
+    inline constexpr uint32_t scene_cache_version{5};
+
+    // identifies the scene file a cache was built from; a cache is stale when either differs
+    struct SceneSource {
+        uint64_t size{0};
+        int64_t modified{0};
+
+        constexpr bool operator==(const SceneSource &) const = default;
+    };
+
+    // distinct materials, one entry of every column each; the material of object i is entry object_material[i]
+    struct MaterialColumns {
+        std::span<const uint32_t> object_material;
+        std::span<const float> colour_r;
+        std::span<const float> colour_g;
+        std::span<const float> colour_b;
+        std::span<const float> ambient;
+        std::span<const float> diffuse;
+        std::span<const float> specular;
+        std::span<const float> shininess;
+        std::span<const float> reflective;
+        std::span<const float> transparency;
+        std::span<const float> refractive_index;
+
+        // the material of object i
+        [[nodiscard]] Material operator[](const size_t object) const { return entry(object_material[object]); }
+
+        // distinct material i
+        [[nodiscard]] Material entry(const size_t i) const {
+            return Material{
+                .colour = Colour{colour_r[i], colour_g[i], colour_b[i]}, .ambient = ambient[i], .diffuse = diffuse[i],
+                .specular = specular[i], .shininess = shininess[i], .reflective = reflective[i],
+                .transparency = transparency[i], .refractive_index = refractive_index[i]
+            };
+        }
+
+        // how many distinct materials there are
+        [[nodiscard]] size_t size() const { return shininess.size(); }
+    };
+
+    // Where a geometry's shape data sits in the blob; a sphere has none. A mesh's BVH is the node_count nodes from
+    // first_node of mesh_nodes(), with child links counted from first_node and leaves counting triangles from
+    // first_triangle.
+    struct CompiledGeometry {
+        Shape shape{Shape::sphere};
+        uint32_t first_node{0};
+        uint32_t node_count{0};
+        uint32_t first_triangle{0};
+        uint32_t triangle_count{0};
+    };
+
+    // Start of the blob. Every array is referenced by its byte offset from the start of the header, so the same
+    // bytes are valid in memory and on disk.
+    struct CompiledSceneHeader {
+        std::array<char, 8> magic{};
+        uint32_t version{0};
+        // 0x01020304 as written; a cache from a machine of the other byte order reads differently and is rebuilt
+        uint32_t byte_order{0};
+        uint64_t total_size{0};
+        SceneSource source{};
+        uint32_t hsize{0};
+        uint32_t vsize{0};
+        double field_of_view{0};
+        std::array<double, 16> camera_transform{};
+        Bounds scene_bounds{};
+        uint32_t light_count{0};
+        uint32_t object_count{0};
+        uint64_t lights_offset{0};
+        uint64_t inverse_transforms_offset{0};
+        uint64_t bounds_offset{0};
+        uint32_t material_count{0};
+        uint64_t object_materials_offset{0};
+        // colour r, g, b, ambient, diffuse, specular, shininess, reflective, transparency, refractive index;
+        // material_count entries each
+        std::array<uint64_t, 10> material_offsets{};
+        uint32_t geometry_count{0};
+        uint64_t geometries_offset{0};
+        uint64_t object_geometries_offset{0};
+        uint32_t mesh_node_count{0};
+        uint32_t triangle_count{0};
+        uint64_t mesh_nodes_offset{0};
+        // a.x, a.y, a.z, b.x, ... c.z of every mesh triangle, triangle_count entries each
+        std::array<uint64_t, 9> triangle_offsets{};
+        uint32_t bvh_node_count{0};
+        uint32_t bvh_index_count{0};
+        uint64_t bvh_nodes_offset{0};
+        uint64_t bvh_indices_offset{0};
+        // as measured when the cache was built
+        BvhStats bvh_stats{};
+    };
+
+    // Everything the renderer needs from a Scene, flattened into a single block: per-object inverse transforms,
+    // world bounds, geometry and material numbers, the distinct materials as one array per field, mesh triangles
+    // with a BVH for each mesh, a BVH over the objects' bounds, lights and the camera. The block is
+    // either built in memory by compile() or memory-mapped read-only from a cache file by map(), which does no
+    // parsing and no copying beyond checking the header and the tree's indices.
+    class CompiledScene {
+    public:
+        // bounds are computed and the BVH built on options.pool
+        static CompiledScene compile(const Scene &scene, SceneSource source = {}, const BvhOptions &options = {});
+
+        static CompiledScene compile(const InstancedScene &scene, SceneSource source = {},
+                                     const BvhOptions &options = {});
+
+        static std::expected<CompiledScene, SceneCacheError> map(const std::string &file_path);
+
+        CompiledScene(const CompiledScene &) = delete;
+        CompiledScene &operator=(const CompiledScene &) = delete;
+        CompiledScene(CompiledScene &&other) noexcept;
+        CompiledScene &operator=(CompiledScene &&other) noexcept;
+        ~CompiledScene();
+
+        // written to a temporary file and renamed into place, so a concurrent map() never sees half a cache
+        std::expected<bool, SceneCacheError> write(const std::string &file_path) const;
+
+        [[nodiscard]] const CompiledSceneHeader &header() const {
+            return *reinterpret_cast<const CompiledSceneHeader *>(data);
+        }
+
+        [[nodiscard]] std::span<const std::byte> bytes() const { return {data, header().total_size}; }
+
+        [[nodiscard]] bool is_mapped() const { return mapping != nullptr; }
+
+        [[nodiscard]] size_t object_count() const { return header().object_count; }
+
+        [[nodiscard]] Camera camera() const;
+
+        [[nodiscard]] std::span<const PointLight> lights() const {
+            return column<PointLight>(header().lights_offset, header().light_count);
+        }
+
+        [[nodiscard]] std::span<const Matrix4> inverse_transforms() const {
+            return column<Matrix4>(header().inverse_transforms_offset, header().object_count);
+        }
+
+        [[nodiscard]] std::span<const Bounds> bounds() const {
+            return column<Bounds>(header().bounds_offset, header().object_count);
+        }
+
+        [[nodiscard]] MaterialColumns materials() const;
+
+        // the distinct materials under the lights, built by compile() and map() rather than stored in the blob
+        [[nodiscard]] const ShadingTable &shading_table() const { return shading; }
+
+        [[nodiscard]] std::span<const uint32_t> object_geometries() const {
+            return column<uint32_t>(header().object_geometries_offset, header().object_count);
+        }
+
+        [[nodiscard]] std::span<const CompiledGeometry> geometries() const {
+            return column<CompiledGeometry>(header().geometries_offset, header().geometry_count);
+        }
+
+        [[nodiscard]] std::span<const BvhNode> mesh_nodes(const CompiledGeometry &geometry) const {
+            return column<BvhNode>(header().mesh_nodes_offset, header().mesh_node_count)
+                    .subspan(geometry.first_node, geometry.node_count);
+        }
+
+        [[nodiscard]] TriangleColumns triangles(const CompiledGeometry &geometry) const;
+
+        [[nodiscard]] std::span<const BvhNode> bvh_nodes() const {
+            return column<BvhNode>(header().bvh_nodes_offset, header().bvh_node_count);
+        }
+
+        // object numbers in the order the BVH leaves refer to them
+        [[nodiscard]] std::span<const uint32_t> bvh_indices() const {
+            return column<uint32_t>(header().bvh_indices_offset, header().bvh_index_count);
+        }
+
+        [[nodiscard]] const BvhStats &bvh_stats() const { return header().bvh_stats; }
+
+    private:
+        // per-object data gathered from either kind of scene before the blob is laid out
+        struct Objects;
+
+        static CompiledScene assemble(const Camera &camera, std::span<const PointLight> lights, const Objects &objects,
+                                      SceneSource source, const BvhOptions &options);
+
+        CompiledScene(std::vector<std::byte> &&owned, const std::byte *data);
+
+        CompiledScene(void *mapping, size_t mapping_size);
+
+        template<typename T>
+        [[nodiscard]] std::span<const T> column(const uint64_t offset, const size_t count) const {
+            return {reinterpret_cast<const T *>(data + offset), count};
+        }
+
+        void release();
+
+        void build_shading_table();
+
+        std::vector<std::byte> owned;
+        void *mapping{nullptr};
+        size_t mapping_size{0};
+        const std::byte *data{nullptr};
+        ShadingTable shading;
+    };
+
+    std::expected<SceneSource, SceneCacheError> scene_source(const std::string &scene_path);
+
+    // The compiled form of scene_path, mapped from cache_path when that was built from the file as it is now and
+    // otherwise parsed, compiled and written back to cache_path for next time. Failing to write the cache is not an
+    // error; the scene is still returned.
+    std::expected<CompiledScene, SceneParseError> load_compiled_scene(const std::string &scene_path,
+                                                                      const std::string &cache_path);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_COMPILED_SCENE_HPP
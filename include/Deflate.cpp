@@ -0,0 +1,659 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include "Deflate.hpp"
+
+namespace raytracer {
+    namespace {
+        constexpr size_t window_size{32768};
+        constexpr size_t hash_bits{15};
+        constexpr size_t min_match{3};
+        constexpr size_t max_match{258};
+        // how many earlier occurrences of a 3-byte prefix are tried, and the match length that ends the search
+        constexpr size_t max_chain{32};
+        constexpr size_t nice_match{128};
+        // tokens per dynamic block; each block gets its own Huffman tables
+        constexpr size_t block_tokens{1 << 16};
+
+        constexpr size_t literal_codes{286};
+        constexpr size_t distance_codes{30};
+        constexpr size_t code_length_codes{19};
+        constexpr uint32_t end_of_block{256};
+
+        constexpr std::array<uint16_t, 29> length_base{
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195,
+            227, 258
+        };
+        constexpr std::array<uint8_t, 29> length_extra{
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        constexpr std::array<uint16_t, 30> distance_base{
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+            4097, 6145, 8193, 12289, 16385, 24577
+        };
+        constexpr std::array<uint8_t, 30> distance_extra{
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+        constexpr std::array<uint8_t, code_length_codes> code_length_order{
+            16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+        };
+
+        struct CodeTables {
+            std::array<uint8_t, max_match + 1> length_code{};
+            // indexed by distance - 1 below 256 and by 256 + ((distance - 1) >> 7) above, as zlib does
+            std::array<uint8_t, 512> distance_code{};
+            std::array<uint32_t, 256> crc{};
+        };
+
+        const CodeTables &code_tables() {
+            static const auto tables{[] {
+                CodeTables result{};
+                for (uint8_t code = 0; code < length_base.size(); ++code) {
+                    const size_t last{size_t{code} + 1 < length_base.size() ? length_base[code + 1] : max_match + 1};
+                    for (size_t length = length_base[code]; length < last; ++length) {
+                        result.length_code[length] = code;
+                    }
+                }
+                for (uint8_t code = 0; code < distance_base.size(); ++code) {
+                    const size_t first{distance_base[code] - 1u};
+                    const size_t last{first + (size_t{1} << distance_extra[code])};
+                    for (size_t d = first; d < last; ++d) {
+                        if (d < 256) {
+                            result.distance_code[d] = code;
+                        } else {
+                            result.distance_code[256 + (d >> 7)] = code;
+                        }
+                    }
+                }
+                for (uint32_t n = 0; n < 256; ++n) {
+                    uint32_t c{n};
+                    for (int k = 0; k < 8; ++k) {
+                        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    }
+                    result.crc[n] = c;
+                }
+                return result;
+            }()};
+            return tables;
+        }
+
+        uint8_t distance_code_for(const size_t distance) {
+            const auto &tables{code_tables()};
+            return distance <= 256 ? tables.distance_code[distance - 1] : tables.distance_code[256 + ((distance - 1) >> 7)];
+        }
+
+        class BitWriter {
+        public:
+            explicit BitWriter(std::vector<uint8_t> &out) : out(out) {};
+
+            void put(const uint32_t value, const unsigned count) {
+                buffer |= static_cast<uint64_t>(value) << filled;
+                filled += count;
+                while (filled >= 8) {
+                    out.push_back(static_cast<uint8_t>(buffer));
+                    buffer >>= 8;
+                    filled -= 8;
+                }
+            }
+
+            void align() {
+                if (filled > 0) {
+                    put(0, 8 - filled);
+                }
+            }
+
+        private:
+            std::vector<uint8_t> &out;
+            uint64_t buffer{0};
+            unsigned filled{0};
+        };
+
+        struct Token {
+            // literal byte when distance is zero, match length otherwise
+            uint16_t value;
+            uint16_t distance;
+        };
+
+        // Huffman code lengths for the given frequencies, no longer than limit. Frequencies are flattened and the tree
+        // rebuilt until it fits, which costs a little ratio in rare cases but is simple and always terminates.
+        void huffman_lengths(std::span<const uint32_t> frequencies, const unsigned limit, std::span<uint8_t> lengths) {
+            std::ranges::fill(lengths, 0);
+            std::vector<uint32_t> weights(frequencies.begin(), frequencies.end());
+            std::vector<uint32_t> symbols;
+            for (uint32_t s = 0; s < weights.size(); ++s) {
+                if (weights[s] > 0) {
+                    symbols.push_back(s);
+                }
+            }
+            if (symbols.size() == 1) {
+                lengths[symbols[0]] = 1;
+                return;
+            }
+            if (symbols.empty()) {
+                return;
+            }
+            while (true) {
+                std::ranges::sort(symbols, [&](const uint32_t a, const uint32_t b) {
+                    return weights[a] < weights[b] || (weights[a] == weights[b] && a < b);
+                });
+                // two-queue construction: leaves in weight order, internal nodes are created in weight order
+                const size_t leaves{symbols.size()};
+                std::vector<uint64_t> weight(2 * leaves - 1);
+                std::vector<uint32_t> parent(2 * leaves - 1);
+                for (size_t i = 0; i < leaves; ++i) {
+                    weight[i] = weights[symbols[i]];
+                }
+                size_t next_leaf{0};
+                size_t next_internal{leaves};
+                const auto take_smallest = [&](const size_t created) {
+                    if (next_leaf < leaves && (next_internal >= created || weight[next_leaf] <= weight[next_internal])) {
+                        return next_leaf++;
+                    }
+                    return next_internal++;
+                };
+                for (size_t created = leaves; created < 2 * leaves - 1; ++created) {
+                    const size_t a{take_smallest(created)};
+                    const size_t b{take_smallest(created)};
+                    weight[created] = weight[a] + weight[b];
+                    parent[a] = static_cast<uint32_t>(created);
+                    parent[b] = static_cast<uint32_t>(created);
+                }
+                std::vector<uint8_t> depth(2 * leaves - 1, 0);
+                unsigned deepest{0};
+                for (size_t node = 2 * leaves - 2; node-- > 0;) {
+                    depth[node] = static_cast<uint8_t>(std::min(depth[parent[node]] + 1, 255));
+                    if (node < leaves) {
+                        deepest = std::max<unsigned>(deepest, depth[node]);
+                    }
+                }
+                if (deepest <= limit) {
+                    for (size_t i = 0; i < leaves; ++i) {
+                        lengths[symbols[i]] = depth[i];
+                    }
+                    return;
+                }
+                for (const auto s: symbols) {
+                    weights[s] = (weights[s] >> 1) | 1;
+                }
+            }
+        }
+
+        // canonical codes, bit-reversed because deflate writes Huffman codes most significant bit first
+        void canonical_codes(std::span<const uint8_t> lengths, std::span<uint16_t> codes) {
+            std::array<uint16_t, 16> count{};
+            for (const auto length: lengths) {
+                ++count[length];
+            }
+            count[0] = 0;
+            std::array<uint16_t, 16> next{};
+            uint16_t code{0};
+            for (size_t bits = 1; bits < 16; ++bits) {
+                code = static_cast<uint16_t>((code + count[bits - 1]) << 1);
+                next[bits] = code;
+            }
+            for (size_t s = 0; s < lengths.size(); ++s) {
+                if (const auto length{lengths[s]}; length != 0) {
+                    uint16_t value{next[length]++};
+                    uint16_t reversed{0};
+                    for (unsigned bit = 0; bit < length; ++bit) {
+                        reversed = static_cast<uint16_t>((reversed << 1) | (value & 1));
+                        value >>= 1;
+                    }
+                    codes[s] = reversed;
+                }
+            }
+        }
+
+        void write_dynamic_block(BitWriter &bits, std::span<const Token> tokens, const bool final_block) {
+            const auto &tables{code_tables()};
+            std::array<uint32_t, literal_codes> literal_frequency{};
+            std::array<uint32_t, distance_codes> distance_frequency{};
+            for (const auto &token: tokens) {
+                if (token.distance == 0) {
+                    ++literal_frequency[token.value];
+                } else {
+                    ++literal_frequency[257 + tables.length_code[token.value]];
+                    ++distance_frequency[distance_code_for(token.distance)];
+                }
+            }
+            literal_frequency[end_of_block] = 1;
+            // keep both codes complete: a lone symbol would get a one-symbol code that some decoders reject
+            literal_frequency[0] = std::max(literal_frequency[0], 1u);
+            distance_frequency[0] = std::max(distance_frequency[0], 1u);
+            distance_frequency[1] = std::max(distance_frequency[1], 1u);
+
+            std::array<uint8_t, literal_codes> literal_lengths{};
+            std::array<uint8_t, distance_codes> distance_lengths{};
+            huffman_lengths(literal_frequency, 15, literal_lengths);
+            huffman_lengths(distance_frequency, 15, distance_lengths);
+            std::array<uint16_t, literal_codes> literal_bits{};
+            std::array<uint16_t, distance_codes> distance_bits{};
+            canonical_codes(literal_lengths, literal_bits);
+            canonical_codes(distance_lengths, distance_bits);
+
+            size_t hlit{literal_codes};
+            while (hlit > 257 && literal_lengths[hlit - 1] == 0) {
+                --hlit;
+            }
+            size_t hdist{distance_codes};
+            while (hdist > 1 && distance_lengths[hdist - 1] == 0) {
+                --hdist;
+            }
+
+            // run-length encode the concatenated code lengths with symbols 16 (repeat), 17 and 18 (zeros)
+            std::vector<uint8_t> all_lengths(literal_lengths.begin(), literal_lengths.begin() + hlit);
+            all_lengths.insert(all_lengths.end(), distance_lengths.begin(), distance_lengths.begin() + hdist);
+            struct LengthSymbol {
+                uint8_t symbol;
+                uint8_t extra;
+            };
+            std::vector<LengthSymbol> encoded;
+            std::array<uint32_t, code_length_codes> length_frequency{};
+            for (size_t i = 0; i < all_lengths.size();) {
+                const uint8_t length{all_lengths[i]};
+                size_t run{1};
+                while (i + run < all_lengths.size() && all_lengths[i + run] == length) {
+                    ++run;
+                }
+                if (length == 0 && run >= 3) {
+                    const size_t take{std::min<size_t>(run, 138)};
+                    encoded.push_back(take >= 11
+                                          ? LengthSymbol{18, static_cast<uint8_t>(take - 11)}
+                                          : LengthSymbol{17, static_cast<uint8_t>(take - 3)});
+                    i += take;
+                } else if (length != 0 && run >= 4) {
+                    encoded.push_back({length, 0});
+                    const size_t take{std::min<size_t>(run - 1, 6)};
+                    encoded.push_back({16, static_cast<uint8_t>(take - 3)});
+                    i += take + 1;
+                } else {
+                    encoded.push_back({length, 0});
+                    ++i;
+                }
+            }
+            for (const auto &[symbol, extra]: encoded) {
+                ++length_frequency[symbol];
+            }
+            std::array<uint8_t, code_length_codes> code_length_lengths{};
+            std::array<uint16_t, code_length_codes> code_length_bits{};
+            huffman_lengths(length_frequency, 7, code_length_lengths);
+            canonical_codes(code_length_lengths, code_length_bits);
+            size_t hclen{code_length_codes};
+            while (hclen > 4 && code_length_lengths[code_length_order[hclen - 1]] == 0) {
+                --hclen;
+            }
+
+            bits.put(final_block ? 1 : 0, 1);
+            bits.put(2, 2);
+            bits.put(static_cast<uint32_t>(hlit - 257), 5);
+            bits.put(static_cast<uint32_t>(hdist - 1), 5);
+            bits.put(static_cast<uint32_t>(hclen - 4), 4);
+            for (size_t i = 0; i < hclen; ++i) {
+                bits.put(code_length_lengths[code_length_order[i]], 3);
+            }
+            for (const auto &[symbol, extra]: encoded) {
+                bits.put(code_length_bits[symbol], code_length_lengths[symbol]);
+                if (symbol == 16) {
+                    bits.put(extra, 2);
+                } else if (symbol == 17) {
+                    bits.put(extra, 3);
+                } else if (symbol == 18) {
+                    bits.put(extra, 7);
+                }
+            }
+
+            for (const auto &token: tokens) {
+                if (token.distance == 0) {
+                    bits.put(literal_bits[token.value], literal_lengths[token.value]);
+                    continue;
+                }
+                const uint8_t length_code{tables.length_code[token.value]};
+                bits.put(literal_bits[257 + length_code], literal_lengths[257 + length_code]);
+                bits.put(token.value - length_base[length_code], length_extra[length_code]);
+                const uint8_t distance_code{distance_code_for(token.distance)};
+                bits.put(distance_bits[distance_code], distance_lengths[distance_code]);
+                bits.put(token.distance - distance_base[distance_code], distance_extra[distance_code]);
+            }
+            bits.put(literal_bits[end_of_block], literal_lengths[end_of_block]);
+        }
+
+        // greedy LZ77 over hash chains of 3-byte prefixes
+        std::vector<Token> match(std::span<const uint8_t> input) {
+            std::vector<Token> tokens;
+            tokens.reserve(input.size() / 2);
+            std::vector<int32_t> head(size_t{1} << hash_bits, -1);
+            std::vector<int32_t> previous(window_size, -1);
+            const auto hash = [&](const size_t pos) {
+                const uint32_t key{
+                    static_cast<uint32_t>(input[pos]) | static_cast<uint32_t>(input[pos + 1]) << 8 |
+                    static_cast<uint32_t>(input[pos + 2]) << 16
+                };
+                return (key * 2654435761u) >> (32 - hash_bits);
+            };
+            const auto insert = [&](const size_t pos) {
+                const auto h{hash(pos)};
+                previous[pos & (window_size - 1)] = head[h];
+                head[h] = static_cast<int32_t>(pos);
+            };
+
+            const size_t size{input.size()};
+            for (size_t pos = 0; pos < size;) {
+                size_t best_length{0};
+                size_t best_distance{0};
+                if (pos + min_match <= size) {
+                    const size_t longest{std::min(max_match, size - pos)};
+                    int32_t candidate{head[hash(pos)]};
+                    for (size_t chain = 0; candidate >= 0 && chain < max_chain; ++chain) {
+                        const size_t distance{pos - static_cast<size_t>(candidate)};
+                        if (distance > window_size) {
+                            break;
+                        }
+                        const uint8_t *a{input.data() + candidate};
+                        const uint8_t *b{input.data() + pos};
+                        if (a[best_length] == b[best_length]) {
+                            size_t length{0};
+                            while (length < longest && a[length] == b[length]) {
+                                ++length;
+                            }
+                            if (length > best_length) {
+                                best_length = length;
+                                best_distance = distance;
+                                if (length >= nice_match || length == longest) {
+                                    break;
+                                }
+                            }
+                        }
+                        candidate = previous[static_cast<size_t>(candidate) & (window_size - 1)];
+                    }
+                    insert(pos);
+                }
+                if (best_length >= min_match) {
+                    tokens.push_back({static_cast<uint16_t>(best_length), static_cast<uint16_t>(best_distance)});
+                    for (size_t skipped = pos + 1; skipped < pos + best_length && skipped + min_match <= size; ++skipped) {
+                        insert(skipped);
+                    }
+                    pos += best_length;
+                } else {
+                    tokens.push_back({input[pos], 0});
+                    ++pos;
+                }
+            }
+            return tokens;
+        }
+
+        class BitReader {
+        public:
+            explicit BitReader(std::span<const uint8_t> input) : input(input) {};
+
+            std::expected<uint32_t, DeflateError> get(const unsigned count) {
+                uint32_t value{0};
+                for (unsigned i = 0; i < count; ++i) {
+                    if (position >= input.size()) {
+                        return std::unexpected(DeflateError::truncated);
+                    }
+                    value |= static_cast<uint32_t>((input[position] >> bit) & 1) << i;
+                    if (++bit == 8) {
+                        bit = 0;
+                        ++position;
+                    }
+                }
+                return value;
+            }
+
+            void align() {
+                if (bit != 0) {
+                    bit = 0;
+                    ++position;
+                }
+            }
+
+            std::span<const uint8_t> input;
+            size_t position{0};
+            unsigned bit{0};
+        };
+
+        // canonical decoding table in the style of zlib's puff: codes are matched one bit at a time
+        struct Decoder {
+            std::array<uint16_t, 16> count{};
+            std::vector<uint16_t> symbols;
+
+            explicit Decoder(std::span<const uint8_t> lengths) : symbols(lengths.size()) {
+                for (const auto length: lengths) {
+                    ++count[length];
+                }
+                std::array<uint16_t, 16> offsets{};
+                for (size_t bits = 1; bits < 16; ++bits) {
+                    offsets[bits] = static_cast<uint16_t>(offsets[bits - 1] + (bits > 1 ? count[bits - 1] : 0));
+                }
+                for (size_t s = 0; s < lengths.size(); ++s) {
+                    if (lengths[s] != 0) {
+                        symbols[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+                    }
+                }
+            }
+
+            std::expected<uint16_t, DeflateError> decode(BitReader &bits) const {
+                int code{0};
+                int first{0};
+                int index{0};
+                for (size_t length = 1; length < 16; ++length) {
+                    const auto bit{bits.get(1)};
+                    if (!bit.has_value()) {
+                        return std::unexpected(bit.error());
+                    }
+                    code |= static_cast<int>(*bit);
+                    const int available{count[length]};
+                    if (code - available < first) {
+                        return symbols[index + (code - first)];
+                    }
+                    index += available;
+                    first = (first + available) << 1;
+                    code <<= 1;
+                }
+                return std::unexpected(DeflateError::invalid_code);
+            }
+        };
+
+        std::expected<bool, DeflateError> inflate_codes(BitReader &bits, const Decoder &literals,
+                                                        const Decoder &distances, std::vector<uint8_t> &out) {
+            while (true) {
+                const auto symbol{literals.decode(bits)};
+                if (!symbol.has_value()) {
+                    return std::unexpected(symbol.error());
+                }
+                if (*symbol < 256) {
+                    out.push_back(static_cast<uint8_t>(*symbol));
+                    continue;
+                }
+                if (*symbol == end_of_block) {
+                    return true;
+                }
+                const size_t length_code{*symbol - 257u};
+                if (length_code >= length_base.size()) {
+                    return std::unexpected(DeflateError::invalid_code);
+                }
+                const auto length_bits{bits.get(length_extra[length_code])};
+                const auto distance_code{distances.decode(bits)};
+                if (!length_bits.has_value() || !distance_code.has_value()) {
+                    return std::unexpected(DeflateError::truncated);
+                }
+                if (*distance_code >= distance_base.size()) {
+                    return std::unexpected(DeflateError::invalid_code);
+                }
+                const auto distance_bits{bits.get(distance_extra[*distance_code])};
+                if (!distance_bits.has_value()) {
+                    return std::unexpected(distance_bits.error());
+                }
+                const size_t length{length_base[length_code] + *length_bits};
+                const size_t distance{distance_base[*distance_code] + *distance_bits};
+                if (distance > out.size()) {
+                    return std::unexpected(DeflateError::invalid_distance);
+                }
+                for (size_t i = 0; i < length; ++i) {
+                    out.push_back(out[out.size() - distance]);
+                }
+            }
+        }
+    }
+
+    uint32_t crc32(const std::span<const uint8_t> data, uint32_t crc) {
+        const auto &table{code_tables().crc};
+        crc = ~crc;
+        for (const auto byte: data) {
+            crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    uint32_t adler32(const std::span<const uint8_t> data, const uint32_t adler) {
+        constexpr uint32_t modulus{65521};
+        // the largest run that cannot overflow 32 bits before reducing
+        constexpr size_t max_run{5552};
+        uint32_t a{adler & 0xFFFF};
+        uint32_t b{adler >> 16};
+        for (size_t start = 0; start < data.size(); start += max_run) {
+            const size_t end{std::min(data.size(), start + max_run)};
+            for (size_t i = start; i < end; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= modulus;
+            b %= modulus;
+        }
+        return b << 16 | a;
+    }
+
+    uint32_t adler32_combine(const uint32_t adler_a, const uint32_t adler_b, const size_t length_b) {
+        constexpr uint64_t modulus{65521};
+        const uint64_t remainder{length_b % modulus};
+        const uint64_t a1{adler_a & 0xFFFF};
+        const uint64_t b1{adler_a >> 16};
+        const uint64_t a2{adler_b & 0xFFFF};
+        const uint64_t b2{adler_b >> 16};
+        const uint64_t a{(a1 + a2 + modulus - 1) % modulus};
+        const uint64_t b{(b1 + b2 + remainder * a1 + modulus - remainder) % modulus};
+        return static_cast<uint32_t>(b << 16 | a);
+    }
+
+    void deflate(const std::span<const uint8_t> input, const DeflateEnd end, std::vector<uint8_t> &out) {
+        BitWriter bits{out};
+        const std::vector<Token> tokens{match(input)};
+        for (size_t start = 0; start < tokens.size(); start += block_tokens) {
+            const size_t count{std::min(block_tokens, tokens.size() - start)};
+            const bool last{start + count == tokens.size()};
+            write_dynamic_block(bits, std::span{tokens}.subspan(start, count), last && end == DeflateEnd::final);
+        }
+        if (tokens.empty() || end == DeflateEnd::sync) {
+            // empty stored block: final if nothing else closed the stream, otherwise a byte-aligned sync point
+            bits.put(tokens.empty() && end == DeflateEnd::final ? 1 : 0, 1);
+            bits.put(0, 2);
+            bits.align();
+            bits.put(0x0000, 16);
+            bits.put(0xFFFF, 16);
+        }
+        bits.align();
+    }
+
+    std::expected<std::vector<uint8_t>, DeflateError> inflate(const std::span<const uint8_t> input) {
+        BitReader bits{input};
+        std::vector<uint8_t> out;
+        bool final_block{false};
+        while (!final_block) {
+            const auto header{bits.get(3)};
+            if (!header.has_value()) {
+                return std::unexpected(header.error());
+            }
+            final_block = (*header & 1) != 0;
+            const uint32_t type{*header >> 1};
+            if (type == 0) {
+                bits.align();
+                if (bits.position + 4 > input.size()) {
+                    return std::unexpected(DeflateError::truncated);
+                }
+                const size_t length{input[bits.position] | static_cast<size_t>(input[bits.position + 1]) << 8};
+                const size_t complement{
+                    input[bits.position + 2] | static_cast<size_t>(input[bits.position + 3]) << 8
+                };
+                if ((length ^ 0xFFFF) != complement) {
+                    return std::unexpected(DeflateError::invalid_block);
+                }
+                bits.position += 4;
+                if (bits.position + length > input.size()) {
+                    return std::unexpected(DeflateError::truncated);
+                }
+                out.insert(out.end(), input.begin() + bits.position, input.begin() + bits.position + length);
+                bits.position += length;
+                continue;
+            }
+            std::array<uint8_t, literal_codes + 2> literal_lengths{};
+            std::array<uint8_t, distance_codes> distance_lengths{};
+            size_t hlit{literal_codes + 2};
+            size_t hdist{distance_codes};
+            if (type == 1) {
+                std::fill_n(literal_lengths.begin(), 144, 8);
+                std::fill_n(literal_lengths.begin() + 144, 112, 9);
+                std::fill_n(literal_lengths.begin() + 256, 24, 7);
+                std::fill_n(literal_lengths.begin() + 280, 8, 8);
+                distance_lengths.fill(5);
+            } else if (type == 2) {
+                const auto counts{bits.get(14)};
+                if (!counts.has_value()) {
+                    return std::unexpected(counts.error());
+                }
+                hlit = (*counts & 0x1F) + 257;
+                hdist = ((*counts >> 5) & 0x1F) + 1;
+                const size_t hclen{(*counts >> 10) + 4};
+                if (hlit > literal_codes || hdist > distance_codes) {
+                    return std::unexpected(DeflateError::invalid_block);
+                }
+                std::array<uint8_t, code_length_codes> code_length_lengths{};
+                for (size_t i = 0; i < hclen; ++i) {
+                    const auto length{bits.get(3)};
+                    if (!length.has_value()) {
+                        return std::unexpected(length.error());
+                    }
+                    code_length_lengths[code_length_order[i]] = static_cast<uint8_t>(*length);
+                }
+                const Decoder code_lengths{code_length_lengths};
+                std::vector<uint8_t> lengths;
+                while (lengths.size() < hlit + hdist) {
+                    const auto symbol{code_lengths.decode(bits)};
+                    if (!symbol.has_value()) {
+                        return std::unexpected(symbol.error());
+                    }
+                    if (*symbol < 16) {
+                        lengths.push_back(static_cast<uint8_t>(*symbol));
+                        continue;
+                    }
+                    if (*symbol == 16 && lengths.empty()) {
+                        return std::unexpected(DeflateError::invalid_block);
+                    }
+                    const uint8_t repeated{*symbol == 16 ? lengths.back() : uint8_t{0}};
+                    const unsigned extra{*symbol == 16 ? 2u : *symbol == 17 ? 3u : 7u};
+                    const size_t base{*symbol == 16 ? 3u : *symbol == 17 ? 3u : 11u};
+                    const auto run{bits.get(extra)};
+                    if (!run.has_value()) {
+                        return std::unexpected(run.error());
+                    }
+                    lengths.insert(lengths.end(), base + *run, repeated);
+                }
+                if (lengths.size() != hlit + hdist) {
+                    return std::unexpected(DeflateError::invalid_block);
+                }
+                std::copy_n(lengths.begin(), hlit, literal_lengths.begin());
+                std::copy_n(lengths.begin() + static_cast<std::ptrdiff_t>(hlit), hdist, distance_lengths.begin());
+            } else {
+                return std::unexpected(DeflateError::invalid_block);
+            }
+            const Decoder literals{std::span<const uint8_t>{literal_lengths}.first(hlit)};
+            const Decoder distances{std::span<const uint8_t>{distance_lengths}.first(hdist)};
+            if (const auto inflated{inflate_codes(bits, literals, distances, out)}; !inflated.has_value()) {
+                return std::unexpected(inflated.error());
+            }
+        }
+        return out;
+    }
+}
@@ -0,0 +1,45 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_DEFLATE_HPP
+#define THE_RAYTRACER_CHALLENGE_DEFLATE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <vector>
+
+namespace raytracer {
+    enum class DeflateError {
+        truncated,
+        invalid_block,
+        invalid_code,
+        invalid_distance
+    };
+
+    enum class DeflateEnd {
+        // finish on a byte boundary with an empty stored block so another segment can be appended directly
+        sync,
+        // mark the last block as final; the stream is complete
+        final
+    };
+
+    uint32_t crc32(std::span<const uint8_t> data, uint32_t crc = 0);
+
+    uint32_t adler32(std::span<const uint8_t> data, uint32_t adler = 1);
+
+    // checksum of A followed by B, given the checksums of each and the length of B
+    uint32_t adler32_combine(uint32_t adler_a, uint32_t adler_b, size_t length_b);
+
+    // Compress input into raw deflate blocks (RFC 1951) appended to out. Segments compressed independently and ended
+    // with DeflateEnd::sync concatenate into one valid stream, which is what lets large inputs be compressed in
+    // parallel; back-references never reach outside the segment being compressed.
+    void deflate(std::span<const uint8_t> input, DeflateEnd end, std::vector<uint8_t> &out);
+
+    // Straightforward decoder for raw deflate streams, used to read back what deflate() produces.
+    std::expected<std::vector<uint8_t>, DeflateError> inflate(std::span<const uint8_t> input);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_DEFLATE_HPP
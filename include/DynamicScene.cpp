@@ -0,0 +1,171 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include "DynamicScene.hpp"
+
+namespace raytracer {
+    DynamicScene::DynamicScene(Scene scene, const BvhOptions &options)
+        : source(std::move(scene)), options(options), objects(source.spheres.size()) {
+        // one block of ids, so sphere i is object i
+        (void) objects.add(static_cast<uint32_t>(source.spheres.size()));
+        // one thread, as the table is not safe to add to from several
+        for (size_t i = 0; i < source.spheres.size(); ++i) {
+            objects.set_material(static_cast<uint32_t>(i), material_table.add(source.spheres[i].material));
+        }
+        shading = ShadingTable::build(material_table.entries(), LightSet::from(source.lights));
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, source.spheres.size(), 1024, [this](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                place(static_cast<uint32_t>(i));
+            }
+        });
+        build_top();
+    }
+
+    void DynamicScene::place(const uint32_t i) {
+        Sphere &sphere{source.spheres[i]};
+        if (object_groups.empty()) {
+            objects.place(i, sphere.transform);
+            sphere.transform_dirty = false;
+            return;
+        }
+        std::optional<Matrix4> &local_inverse{local_inverses[i]};
+        if (sphere.transform_dirty) {
+            const auto inverted{invert(sphere.transform)};
+            local_inverse = inverted.has_value() ? std::optional{inverted.value()} : std::nullopt;
+            sphere.transform_dirty = false;
+        }
+        const uint32_t group{object_groups[i]};
+        if (!local_inverse.has_value() || !graph.invertible(group)) {
+            objects.place(i, Matrix4{}, std::nullopt);
+            return;
+        }
+        objects.place(i, multiply(graph.world_transform(group), Matrix4::from(sphere.transform)),
+                      multiply(local_inverse.value(), graph.inverse_world_transform(group)));
+    }
+
+    void DynamicScene::set_transform(const size_t i, const Container<double> &transform) {
+        mark_moved(static_cast<uint32_t>(i));
+        source.spheres[i].set_transform(transform);
+    }
+
+    void DynamicScene::mark_moved(const uint32_t i) {
+        Sphere &sphere{source.spheres[i]};
+        if (!sphere.transform_dirty) {
+            moved_objects.push_back(i);
+            sphere.transform_dirty = true;
+        }
+    }
+
+    void DynamicScene::attach(const size_t i, const uint32_t group) {
+        use_groups();
+        group_members.resize(std::max(group_members.size(), graph.group_count()));
+        // swapped out of its old group's list with the last member
+        std::vector<uint32_t> &old_members{group_members[object_groups[i]]};
+        const uint32_t slot{member_slots[i]};
+        old_members[slot] = old_members.back();
+        member_slots[old_members[slot]] = slot;
+        old_members.pop_back();
+        member_slots[i] = static_cast<uint32_t>(group_members[group].size());
+        group_members[group].push_back(static_cast<uint32_t>(i));
+        object_groups[i] = group;
+        mark_moved(static_cast<uint32_t>(i));
+    }
+
+    void DynamicScene::use_groups() {
+        if (!object_groups.empty()) {
+            return;
+        }
+        object_groups.assign(source.spheres.size(), SceneGraph::root);
+        local_inverses.resize(source.spheres.size());
+        group_members.resize(graph.group_count());
+        group_members[SceneGraph::root].resize(source.spheres.size());
+        std::iota(group_members[SceneGraph::root].begin(), group_members[SceneGraph::root].end(), 0u);
+        member_slots = group_members[SceneGraph::root];
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, source.spheres.size(), 1024, [this](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const auto inverted{invert(source.spheres[i].transform)};
+                local_inverses[i] = inverted.has_value() ? std::optional{inverted.value()} : std::nullopt;
+            }
+        });
+    }
+
+    void DynamicScene::set_material(const size_t i, const Material &material) {
+        source.spheres[i].material = material;
+        objects.set_material(static_cast<uint32_t>(i), material_table.add(material));
+        if (material_table.size() != shading.material_count()) {
+            shading = ShadingTable::build(material_table.entries(), LightSet::from(source.lights));
+        }
+    }
+
+    SceneUpdate DynamicScene::update() {
+        const auto start{std::chrono::steady_clock::now()};
+        SceneUpdate result;
+        const std::vector<uint32_t> moved{place_moved(&result.groups_moved)};
+        bool needs_rebuild{false};
+        for (const uint32_t i: moved) {
+            needs_rebuild = needs_rebuild || (links.leaves[i] == BvhLinks::none && !objects.bounds()[i].empty());
+        }
+        result.moved = static_cast<uint32_t>(moved.size());
+        if (needs_rebuild) {
+            build_top();
+            result.rebuilt = true;
+        } else {
+            result.nodes_refit = refit_bvh(top, links, objects.bounds(), moved);
+        }
+        const auto elapsed{std::chrono::steady_clock::now() - start};
+        result.update_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        return result;
+    }
+
+    std::vector<uint32_t> DynamicScene::place_moved(uint32_t *groups_moved) {
+        const std::vector<uint32_t> changed{graph.update()};
+        if (groups_moved != nullptr) {
+            *groups_moved = static_cast<uint32_t>(changed.size());
+        }
+        if (!changed.empty()) {
+            use_groups();
+        }
+        std::vector<uint32_t> moved;
+        moved.swap(moved_objects);
+        // members of a moved group that were not queued on their own
+        for (const uint32_t group: changed) {
+            if (group >= group_members.size()) {
+                continue;
+            }
+            for (const uint32_t i: group_members[group]) {
+                if (!source.spheres[i].transform_dirty) {
+                    moved.push_back(i);
+                }
+            }
+        }
+        // in object order, as the refit has always seen them
+        std::ranges::sort(moved);
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, moved.size(), 256, [this, &moved](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                place(moved[i]);
+            }
+        });
+        return moved;
+    }
+
+    void DynamicScene::rebuild() {
+        place_moved();
+        build_top();
+    }
+
+    void DynamicScene::build_top() {
+        top = build_bvh(objects.bounds(), options);
+        links = bvh_links(top, objects.size());
+    }
+
+    BvhStats DynamicScene::bvh_stats() const {
+        return raytracer::bvh_stats(top.nodes, options);
+    }
+}
@@ -0,0 +1,154 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_DYNAMIC_SCENE_HPP
+#define THE_RAYTRACER_CHALLENGE_DYNAMIC_SCENE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "Bounds.hpp"
+#include "Bvh.hpp"
+#include "Camera.hpp"
+#include "Light.hpp"
+#include "Material.hpp"
+#include "Matrix4.hpp"
+#include "ObjectRegistry.hpp"
+#include "Scene.hpp"
+#include "SceneGraph.hpp"
+
+namespace raytracer {
+    // what one update() found and did
+    struct SceneUpdate {
+        // objects whose transform was set, or whose group moved, since the last update
+        uint32_t moved{0};
+        // groups whose world transform changed
+        uint32_t groups_moved{0};
+        // boxes of the top level tree recomputed by the refit
+        uint32_t nodes_refit{0};
+        // the top level tree was built again instead of refitted
+        bool rebuilt{false};
+        double update_ms{0};
+    };
+
+    // A scene whose objects move between frames, held as two levels: a top level BVH over the world bounds of every
+    // object instance, and below it each object's own geometry in object space, reached through its inverse
+    // transform. Moving an object changes nothing below the top level, so update() only recomputes the inverse and
+    // bounds of the objects moved through set_transform() and refits the boxes above them. The moved objects are
+    // recorded as they move, and each group keeps a list of its own, so a frame costs in proportion to what moved
+    // rather than to the size of the scene.
+    //
+    // Refitting keeps the shape of the tree, so after large movements rays visit more nodes than they would in a
+    // fresh tree; rebuild() starts over from where everything is now, and bvh_stats() tells how much it would gain.
+    //
+    // Objects can also be put in groups of a SceneGraph, after which their transform places them relative to the
+    // group. Moving a group is one set_transform() on groups(); update() then recomposes the world transforms below
+    // it and places each of its objects from its cached inverse and the group's, two products in float, with
+    // nothing inverted again and no Container arithmetic.
+    class DynamicScene {
+    public:
+        explicit DynamicScene(Scene scene, const BvhOptions &options = {});
+
+        [[nodiscard]] const Scene &scene() const { return source; }
+
+        // to move an object, set its transform through set_transform() and its material through set_material()
+        [[nodiscard]] const Sphere &object(const size_t i) const { return source.spheres[i]; }
+
+        // takes effect at the next update()
+        void set_transform(size_t i, const Container<double> &transform);
+
+        // takes effect from the next frame, with no update() needed; a material not seen before is added to the
+        // table, which keeps it even once no object uses it, and the shading table is built again
+        void set_material(size_t i, const Material &material);
+
+        // groups to put objects in; moving one takes effect at the next update()
+        [[nodiscard]] SceneGraph &groups() { return graph; }
+
+        [[nodiscard]] const SceneGraph &groups() const { return graph; }
+
+        // from the next update(), the transform of object i places it relative to group
+        void attach(size_t i, uint32_t group);
+
+        [[nodiscard]] uint32_t group_of(const size_t i) const {
+            return object_groups.empty() ? SceneGraph::root : object_groups[i];
+        }
+
+        [[nodiscard]] size_t object_count() const { return source.spheres.size(); }
+
+        // picks up every transform set and every group moved since the last update; the top level tree is rebuilt
+        // only when an object that could not be hit until now has to go in it
+        SceneUpdate update();
+
+        // builds the top level tree again, for when refits have let it get too far from a fresh one
+        void rebuild();
+
+        [[nodiscard]] const Camera &camera() const { return source.camera; }
+
+        [[nodiscard]] std::span<const PointLight> lights() const { return source.lights; }
+
+        // object i of the scene is object i of the registry
+        [[nodiscard]] const ObjectRegistry &registry() const { return objects; }
+
+        [[nodiscard]] std::span<const Matrix4> inverse_transforms() const { return objects.inverse_transforms(); }
+
+        [[nodiscard]] std::span<const Bounds> bounds() const { return objects.bounds(); }
+
+        // the distinct materials, each stored once however many objects use it
+        [[nodiscard]] std::span<const Material> materials() const { return material_table.entries(); }
+
+        // the number in materials() of each object's material
+        [[nodiscard]] std::span<const uint32_t> object_materials() const { return objects.materials(); }
+
+        [[nodiscard]] const Material &material(const size_t i) const { return material_table[objects.materials()[i]]; }
+
+        // materials() under the lights
+        [[nodiscard]] const ShadingTable &shading_table() const { return shading; }
+
+        [[nodiscard]] std::span<const BvhNode> bvh_nodes() const { return top.nodes; }
+
+        [[nodiscard]] std::span<const uint32_t> bvh_indices() const { return top.indices; }
+
+        // the tree as it is now, refits included; walks the whole tree
+        [[nodiscard]] BvhStats bvh_stats() const;
+
+        // as measured by the last build
+        [[nodiscard]] const BvhStats &build_stats() const { return top.stats; }
+
+    private:
+        // inverse and bounds of object i from its current transform and group
+        void place(uint32_t i);
+
+        // place() every object whose transform was set or whose group moved since it was last placed; returns
+        // their numbers
+        std::vector<uint32_t> place_moved(uint32_t *groups_moved = nullptr);
+
+        // from the first use of a group on: every object's group and the inverse of its own transform
+        void use_groups();
+
+        // queues object i for the next update() unless it already is
+        void mark_moved(uint32_t i);
+
+        void build_top();
+
+        Scene source;
+        BvhOptions options;
+        ObjectRegistry objects;
+        MaterialTable material_table;
+        ShadingTable shading;
+        SceneGraph graph;
+        // both empty while no group has been used, so a flat scene is placed exactly as it always was
+        std::vector<uint32_t> object_groups;
+        std::vector<std::optional<Matrix4>> local_inverses;
+        // the objects in each group, in no order, and where each object is in its group's list
+        std::vector<std::vector<uint32_t>> group_members;
+        std::vector<uint32_t> member_slots;
+        // objects set_transform() or attach() has queued since the last update, each once
+        std::vector<uint32_t> moved_objects;
+        Bvh top;
+        BvhLinks links;
+    };
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_DYNAMIC_SCENE_HPP
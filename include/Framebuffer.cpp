@@ -0,0 +1,100 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include "Framebuffer.hpp"
+
+namespace raytracer {
+    namespace {
+        constexpr size_t srgb_table_size{4096};
+        // pixels per block; the per-block scratch arrays stay in L1 and every inner loop is a straight run over
+        // contiguous floats that the compiler turns into vector code
+        constexpr size_t block_size{64};
+
+        const std::array<uint8_t, srgb_table_size> &srgb_table() {
+            static const auto table{[] {
+                std::array<uint8_t, srgb_table_size> result{};
+                for (size_t i = 0; i < srgb_table_size; ++i) {
+                    const double linear{static_cast<double>(i) / (srgb_table_size - 1)};
+                    const double encoded{
+                        linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055
+                    };
+                    result[i] = static_cast<uint8_t>(encoded * 255.0 + 0.5);
+                }
+                return result;
+            }()};
+            return table;
+        }
+    }
+
+    void AccumulationBuffer::clear() {
+        std::ranges::fill(r, 0.0f);
+        std::ranges::fill(g, 0.0f);
+        std::ranges::fill(b, 0.0f);
+        std::ranges::fill(samples, 0u);
+    }
+
+    std::expected<bool, CanvasError> resolve(const AccumulationBuffer &buffer, const ToneMap &tone_map,
+                                             std::span<uint8_t> rgb) {
+        const size_t pixel_count{size_t{buffer.width} * buffer.height};
+        if (rgb.size() != pixel_count * Canvas::channels) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        const bool srgb{tone_map.transfer == TransferFunction::srgb};
+        const float steps{srgb ? static_cast<float>(srgb_table_size - 1) : 255.0f};
+        // sRGB rounds to the nearest table entry, linear truncates like write_pixel
+        const float bias{srgb ? 0.5f : 0.0f};
+        const auto &table{srgb_table()};
+        const std::array planes{buffer.r.data(), buffer.g.data(), buffer.b.data()};
+
+        alignas(64) std::array<float, block_size> scale{};
+        alignas(64) std::array<std::array<uint16_t, block_size>, Canvas::channels> quantised{};
+        for (size_t start = 0; start < pixel_count; start += block_size) {
+            const size_t count{std::min(block_size, pixel_count - start)};
+            const uint32_t *samples{buffer.samples.data() + start};
+            for (size_t i = 0; i < count; ++i) {
+                scale[i] = tone_map.exposure * steps / static_cast<float>(std::max(samples[i], 1u));
+            }
+            for (size_t c = 0; c < Canvas::channels; ++c) {
+                const float *plane{planes[c] + start};
+                auto &channel{quantised[c]};
+                for (size_t i = 0; i < count; ++i) {
+                    channel[i] = static_cast<uint16_t>(std::min(std::max(plane[i] * scale[i], 0.0f), steps) + bias);
+                }
+            }
+            uint8_t *out{rgb.data() + start * Canvas::channels};
+            if (srgb) {
+                for (size_t i = 0; i < count; ++i) {
+                    out[i * 3] = table[quantised[0][i]];
+                    out[i * 3 + 1] = table[quantised[1][i]];
+                    out[i * 3 + 2] = table[quantised[2][i]];
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    out[i * 3] = static_cast<uint8_t>(quantised[0][i]);
+                    out[i * 3 + 1] = static_cast<uint8_t>(quantised[1][i]);
+                    out[i * 3 + 2] = static_cast<uint8_t>(quantised[2][i]);
+                }
+            }
+        }
+        return true;
+    }
+
+    std::expected<bool, CanvasError> resolve(const AccumulationBuffer &buffer, const ToneMap &tone_map,
+                                             Canvas &canvas) {
+        if (canvas.width != buffer.width || canvas.height != buffer.height) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        if (canvas.layout == PixelLayout::tiled) {
+            // the block kernels work along rows; resolve linearly and retile once
+            Canvas linear{canvas.width, canvas.height};
+            const auto resolved{resolve(buffer, tone_map, std::span{linear.storage})};
+            canvas = convert_layout(linear, PixelLayout::tiled);
+            return resolved;
+        }
+        return resolve(buffer, tone_map, std::span{canvas.storage});
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_FRAMEBUFFER_HPP
+#define THE_RAYTRACER_CHALLENGE_FRAMEBUFFER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <expected>
+#include "Canvas.hpp"
+#include "Colour.hpp"
+
+namespace raytracer {
+    enum class TransferFunction {
+        // clamp and truncate, identical to Canvas::write_pixel
+        linear,
+        // IEC 61966-2-1 sRGB encoding, rounded to the nearest 8-bit step
+        srgb
+    };
+
+    struct ToneMap {
+        float exposure{1.0f};
+        TransferFunction transfer{TransferFunction::srgb};
+    };
+
+    // Unclamped float radiance, one plane per channel, summed over every sample a pixel receives. The per-pixel
+    // sample count plays the role of the alpha/weight channel and is divided out when the buffer is resolved.
+    struct AccumulationBuffer {
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<float> r{};
+        std::vector<float> g{};
+        std::vector<float> b{};
+        std::vector<uint32_t> samples{};
+
+        explicit AccumulationBuffer(const uint32_t w, const uint32_t h) : width(w), height(h),
+                                                                          r(size_t{w} * h, 0.0f),
+                                                                          g(size_t{w} * h, 0.0f),
+                                                                          b(size_t{w} * h, 0.0f),
+                                                                          samples(size_t{w} * h, 0) {};
+
+        constexpr void add_sample(const uint32_t pix_w, const uint32_t pix_h, const Colour &colour) {
+            const size_t index{size_t{pix_h} * width + pix_w};
+            r[index] += colour.r;
+            g[index] += colour.g;
+            b[index] += colour.b;
+            ++samples[index];
+        }
+
+        void clear();
+    };
+
+    // Divide out the sample counts, apply exposure and the transfer function, and quantise to tightly packed RGB
+    // bytes in one pass over the planes. The sRGB path goes through a 4096 entry table and is within one 8-bit step
+    // of the exact transfer function.
+    std::expected<bool, CanvasError> resolve(const AccumulationBuffer &buffer, const ToneMap &tone_map,
+                                             std::span<uint8_t> rgb);
+
+    std::expected<bool, CanvasError> resolve(const AccumulationBuffer &buffer, const ToneMap &tone_map,
+                                             Canvas &canvas);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_FRAMEBUFFER_HPP
@@ -0,0 +1,488 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "ImageCodecs.hpp"
+#include "Deflate.hpp"
+
+namespace raytracer {
+    namespace {
+        constexpr std::array<uint8_t, 8> png_signature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        constexpr std::array<uint8_t, 4> qoi_magic{'q', 'o', 'i', 'f'};
+        constexpr std::array<uint8_t, 8> qoi_end_marker{0, 0, 0, 0, 0, 0, 0, 1};
+        constexpr size_t qoi_header_size{14};
+
+        constexpr uint8_t qoi_op_index{0x00};
+        constexpr uint8_t qoi_op_diff{0x40};
+        constexpr uint8_t qoi_op_luma{0x80};
+        constexpr uint8_t qoi_op_run{0xC0};
+        constexpr uint8_t qoi_op_rgb{0xFE};
+        constexpr uint8_t qoi_op_rgba{0xFF};
+        constexpr uint8_t qoi_tag_mask{0xC0};
+        constexpr size_t qoi_max_run{62};
+
+        enum class PngFilter : uint8_t {
+            none,
+            sub,
+            up,
+            average,
+            paeth
+        };
+
+        void put_u32(std::vector<uint8_t> &out, const uint32_t value) {
+            out.push_back(static_cast<uint8_t>(value >> 24));
+            out.push_back(static_cast<uint8_t>(value >> 16));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        uint32_t get_u32(const uint8_t *bytes) {
+            return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+                   static_cast<uint32_t>(bytes[2]) << 8 | bytes[3];
+        }
+
+        // run work(chunk) for every chunk on the pool, one task per chunk
+        template<typename Work>
+        void for_each_chunk(const size_t chunks, const EncodeOptions &options, Work &&work) {
+            ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+            pool.parallel_for(0, chunks, 1, [&](const size_t first, const size_t last) {
+                for (size_t chunk = first; chunk < last; ++chunk) {
+                    work(chunk);
+                }
+            });
+        }
+
+        void write_png_chunk(std::vector<uint8_t> &out, const char (&type)[5], std::span<const uint8_t> data) {
+            put_u32(out, static_cast<uint32_t>(data.size()));
+            const size_t type_start{out.size()};
+            out.insert(out.end(), type, type + 4);
+            out.insert(out.end(), data.begin(), data.end());
+            put_u32(out, crc32(std::span{out}.subspan(type_start)));
+        }
+
+        // branch-free form of the Paeth predictor so the filter loops vectorise
+        uint8_t paeth_predictor(const int a, const int b, const int c) {
+            const int pa{std::abs(b - c)};
+            const int pb{std::abs(a - c)};
+            const int pc{std::abs(a + b - 2 * c)};
+            const int b_or_c{pb <= pc ? b : c};
+            return static_cast<uint8_t>(pa <= pb && pa <= pc ? a : b_or_c);
+        }
+
+        uint8_t predict(const PngFilter filter, const uint8_t left, const uint8_t up, const uint8_t up_left) {
+            switch (filter) {
+                case PngFilter::sub:
+                    return left;
+                case PngFilter::up:
+                    return up;
+                case PngFilter::average:
+                    return static_cast<uint8_t>((left + up) / 2);
+                case PngFilter::paeth:
+                    return paeth_predictor(left, up, up_left);
+                default:
+                    return 0;
+            }
+        }
+
+        template<PngFilter filter>
+        uint8_t filter_byte(const uint8_t value, const uint8_t left, const uint8_t up, const uint8_t up_left) {
+            if constexpr (filter == PngFilter::sub) {
+                return static_cast<uint8_t>(value - left);
+            } else if constexpr (filter == PngFilter::up) {
+                return static_cast<uint8_t>(value - up);
+            } else if constexpr (filter == PngFilter::average) {
+                return static_cast<uint8_t>(value - (left + up) / 2);
+            } else if constexpr (filter == PngFilter::paeth) {
+                return static_cast<uint8_t>(value - paeth_predictor(left, up, up_left));
+            } else {
+                return value;
+            }
+        }
+
+        // filter a row into out and return the sum of absolute residuals; the first pixel has nothing to its left
+        template<PngFilter filter>
+        uint64_t apply_filter(std::span<const uint8_t> row, std::span<const uint8_t> previous, uint8_t *out) {
+            constexpr size_t bpp{Canvas::channels};
+            const size_t lead{std::min(bpp, row.size())};
+            uint64_t cost{0};
+            for (size_t i = 0; i < lead; ++i) {
+                out[i] = filter_byte<filter>(row[i], 0, previous[i], 0);
+                cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(out[i])));
+            }
+            uint32_t body_cost{0};
+            for (size_t i = lead; i < row.size(); ++i) {
+                out[i] = filter_byte<filter>(row[i], row[i - bpp], previous[i], previous[i - bpp]);
+                body_cost += static_cast<uint32_t>(std::abs(static_cast<int8_t>(out[i])));
+            }
+            return cost + body_cost;
+        }
+
+        // Filter one row with every PNG filter and keep the one with the smallest sum of absolute residuals, the
+        // heuristic the PNG specification recommends for truecolour images. The first row has no row above it, which
+        // the filters treat as zeros.
+        void filter_row(std::span<const uint8_t> row, std::span<const uint8_t> previous, std::span<uint8_t> scratch,
+                        uint8_t *out) {
+            uint64_t best_cost{UINT64_MAX};
+            const auto consider = [&](const PngFilter filter, const uint64_t cost) {
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    out[0] = static_cast<uint8_t>(filter);
+                    std::ranges::copy(scratch, out + 1);
+                }
+            };
+            consider(PngFilter::none, apply_filter<PngFilter::none>(row, previous, scratch.data()));
+            consider(PngFilter::sub, apply_filter<PngFilter::sub>(row, previous, scratch.data()));
+            consider(PngFilter::up, apply_filter<PngFilter::up>(row, previous, scratch.data()));
+            consider(PngFilter::average, apply_filter<PngFilter::average>(row, previous, scratch.data()));
+            consider(PngFilter::paeth, apply_filter<PngFilter::paeth>(row, previous, scratch.data()));
+        }
+
+        struct QoiPixel {
+            uint8_t r{0};
+            uint8_t g{0};
+            uint8_t b{0};
+            uint8_t a{0};
+
+            constexpr bool operator==(const QoiPixel &) const = default;
+
+            [[nodiscard]] constexpr size_t hash() const {
+                return (r * 3u + g * 5u + b * 7u + a * 11u) % 64;
+            }
+        };
+
+        constexpr QoiPixel qoi_start_pixel{0, 0, 0, 255};
+
+        QoiPixel qoi_pixel(std::span<const uint8_t> rgb, const size_t index) {
+            const uint8_t *p{rgb.data() + index * Canvas::channels};
+            return {p[0], p[1], p[2], 255};
+        }
+
+        // What the encoder of a chunk knows of the colour index a decoder holds just before its first pixel
+        struct QoiIndex {
+            std::array<QoiPixel, 64> pixels{};
+            // slots not worked out, which the decoder holds something in that QOI_OP_INDEX must not refer to
+            std::array<bool, 64> known{};
+        };
+
+        // The colour index before pixel `start`: every slot keeps the most recent pixel hashed to it that was not a
+        // repeat of its predecessor. Scans back at most `window` pixels, as an image of a few colours never fills
+        // every slot and would otherwise be scanned back to its start for every chunk; slots not seen in the window
+        // are left unknown.
+        QoiIndex qoi_index_before(std::span<const uint8_t> rgb, const size_t start, const size_t window) {
+            QoiIndex index;
+            size_t remaining{64};
+            for (size_t i = start; i-- > start - std::min(start, window) && remaining > 0;) {
+                const QoiPixel px{qoi_pixel(rgb, i)};
+                if (px == (i > 0 ? qoi_pixel(rgb, i - 1) : qoi_start_pixel)) {
+                    continue;
+                }
+                if (const size_t slot{px.hash()}; !index.known[slot]) {
+                    index.known[slot] = true;
+                    index.pixels[slot] = px;
+                    --remaining;
+                }
+            }
+            return index;
+        }
+
+        void encode_qoi_pixels(std::span<const uint8_t> rgb, const size_t begin, const size_t end,
+                               std::vector<uint8_t> &out) {
+            // a slot the encoder writes itself is known from then on, to the decoder as well
+            QoiIndex index{qoi_index_before(rgb, begin, end - begin)};
+            QoiPixel previous{begin > 0 ? qoi_pixel(rgb, begin - 1) : qoi_start_pixel};
+            size_t run{0};
+            for (size_t i = begin; i < end; ++i) {
+                const QoiPixel px{qoi_pixel(rgb, i)};
+                if (px == previous) {
+                    if (++run == qoi_max_run) {
+                        out.push_back(static_cast<uint8_t>(qoi_op_run | (run - 1)));
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0) {
+                    out.push_back(static_cast<uint8_t>(qoi_op_run | (run - 1)));
+                    run = 0;
+                }
+                const size_t slot{px.hash()};
+                if (index.known[slot] && index.pixels[slot] == px) {
+                    out.push_back(static_cast<uint8_t>(qoi_op_index | slot));
+                } else {
+                    index.pixels[slot] = px;
+                    index.known[slot] = true;
+                    const int dr{static_cast<int8_t>(px.r - previous.r)};
+                    const int dg{static_cast<int8_t>(px.g - previous.g)};
+                    const int db{static_cast<int8_t>(px.b - previous.b)};
+                    const int dr_dg{dr - dg};
+                    const int db_dg{db - dg};
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out.push_back(static_cast<uint8_t>(qoi_op_diff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                        out.push_back(static_cast<uint8_t>(qoi_op_luma | (dg + 32)));
+                        out.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+                    } else {
+                        out.insert(out.end(), {qoi_op_rgb, px.r, px.g, px.b});
+                    }
+                }
+                previous = px;
+            }
+            if (run > 0) {
+                out.push_back(static_cast<uint8_t>(qoi_op_run | (run - 1)));
+            }
+        }
+
+        std::expected<bool, CanvasError> write_bytes(const std::string &file_path, std::span<const uint8_t> bytes) {
+            std::ofstream out_file(file_path, std::ios::trunc | std::ios::binary);
+            if (!out_file) {
+                return std::unexpected(CanvasError::invalid_path);
+            }
+            out_file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!out_file) {
+                return std::unexpected(CanvasError::write_failed);
+            }
+            return true;
+        }
+    }
+
+    ImageFormat image_format_for(const std::string &file_path) {
+        std::string extension{std::filesystem::path(file_path).extension().string()};
+        std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return std::tolower(c); });
+        if (extension == ".png") {
+            return ImageFormat::png;
+        }
+        if (extension == ".qoi") {
+            return ImageFormat::qoi;
+        }
+        return ImageFormat::ppm;
+    }
+
+    std::vector<uint8_t> encode_png(const Canvas &image, const EncodeOptions &options) {
+        Canvas scratch{0, 0};
+        const Canvas &canvas{linear_view(image, scratch)};
+        const size_t row_bytes{size_t{canvas.width} * Canvas::channels};
+        const size_t rows_per_chunk{std::max<size_t>(1, options.chunk_bytes / std::max<size_t>(row_bytes, 1))};
+        const size_t chunks{std::max<size_t>(1, (canvas.height + rows_per_chunk - 1) / rows_per_chunk)};
+
+        struct Compressed {
+            std::vector<uint8_t> bytes;
+            uint32_t adler{1};
+            size_t filtered_size{0};
+        };
+        std::vector<Compressed> compressed(chunks);
+        for_each_chunk(chunks, options, [&](const size_t chunk) {
+            const size_t first_row{chunk * rows_per_chunk};
+            const size_t rows{std::min(rows_per_chunk, canvas.height - std::min<size_t>(first_row, canvas.height))};
+            std::vector<uint8_t> filtered(rows * (row_bytes + 1));
+            std::vector<uint8_t> scratch(row_bytes);
+            const std::vector<uint8_t> zero_row(row_bytes, 0);
+            for (size_t r = 0; r < rows; ++r) {
+                const size_t y{first_row + r};
+                const std::span<const uint8_t> row{canvas.storage.data() + y * row_bytes, row_bytes};
+                const std::span<const uint8_t> previous{
+                    y > 0 ? canvas.storage.data() + (y - 1) * row_bytes : zero_row.data(), row_bytes
+                };
+                filter_row(row, previous, scratch, filtered.data() + r * (row_bytes + 1));
+            }
+            auto &result{compressed[chunk]};
+            result.adler = adler32(filtered);
+            result.filtered_size = filtered.size();
+            deflate(filtered, chunk + 1 == chunks ? DeflateEnd::final : DeflateEnd::sync, result.bytes);
+        });
+
+        std::vector<uint8_t> out(png_signature.begin(), png_signature.end());
+        std::vector<uint8_t> header;
+        put_u32(header, canvas.width);
+        put_u32(header, canvas.height);
+        // 8 bits per channel, truecolour, deflate, adaptive filtering, no interlace
+        header.insert(header.end(), {8, 2, 0, 0, 0});
+        write_png_chunk(out, "IHDR", header);
+
+        uint32_t adler{compressed.front().adler};
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            adler = adler32_combine(adler, compressed[chunk].adler, compressed[chunk].filtered_size);
+        }
+        // zlib framing: the stream header goes in front of the first chunk and the checksum after the last
+        compressed.front().bytes.insert(compressed.front().bytes.begin(), {0x78, 0x01});
+        put_u32(compressed.back().bytes, adler);
+        for (const auto &chunk: compressed) {
+            write_png_chunk(out, "IDAT", chunk.bytes);
+        }
+        write_png_chunk(out, "IEND", {});
+        return out;
+    }
+
+    std::vector<uint8_t> encode_qoi(const Canvas &image, const EncodeOptions &options) {
+        Canvas scratch{0, 0};
+        const Canvas &canvas{linear_view(image, scratch)};
+        const size_t pixels{size_t{canvas.width} * canvas.height};
+        const size_t pixels_per_chunk{std::max<size_t>(1, options.chunk_bytes / Canvas::channels)};
+        const size_t chunks{std::max<size_t>(1, (pixels + pixels_per_chunk - 1) / pixels_per_chunk)};
+        std::vector<std::vector<uint8_t>> encoded(chunks);
+        for_each_chunk(chunks, options, [&](const size_t chunk) {
+            const size_t begin{std::min(pixels, chunk * pixels_per_chunk)};
+            const size_t end{std::min(pixels, begin + pixels_per_chunk)};
+            encoded[chunk].reserve((end - begin) * 2);
+            encode_qoi_pixels(canvas.storage, begin, end, encoded[chunk]);
+        });
+
+        std::vector<uint8_t> out(qoi_magic.begin(), qoi_magic.end());
+        put_u32(out, canvas.width);
+        put_u32(out, canvas.height);
+        // three channels, sRGB colour space tag
+        out.insert(out.end(), {3, 0});
+        for (const auto &chunk: encoded) {
+            out.insert(out.end(), chunk.begin(), chunk.end());
+        }
+        out.insert(out.end(), qoi_end_marker.begin(), qoi_end_marker.end());
+        return out;
+    }
+
+    std::expected<Canvas, CanvasError> decode_png(const std::span<const uint8_t> data) {
+        if (data.size() < png_signature.size() || !std::equal(png_signature.begin(), png_signature.end(), data.begin())) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<uint8_t> zlib_stream;
+        for (size_t pos = png_signature.size(); pos + 12 <= data.size();) {
+            const uint32_t length{get_u32(data.data() + pos)};
+            if (pos + 12 + length > data.size()) {
+                return std::unexpected(CanvasError::malformed);
+            }
+            const auto chunk{data.subspan(pos + 4, 4 + size_t{length})};
+            if (crc32(chunk) != get_u32(data.data() + pos + 8 + length)) {
+                return std::unexpected(CanvasError::malformed);
+            }
+            const std::string_view type{reinterpret_cast<const char *>(chunk.data()), 4};
+            const auto body{chunk.subspan(4)};
+            if (type == "IHDR") {
+                if (length != 13 || body[8] != 8 || body[9] != 2 || body[12] != 0) {
+                    return std::unexpected(CanvasError::unsupported);
+                }
+                width = get_u32(body.data());
+                height = get_u32(body.data() + 4);
+            } else if (type == "IDAT") {
+                zlib_stream.insert(zlib_stream.end(), body.begin(), body.end());
+            } else if (type == "IEND") {
+                break;
+            }
+            pos += 12 + length;
+        }
+        if (zlib_stream.size() < 6 || (zlib_stream[0] & 0x0F) != 8) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        const auto filtered{inflate(std::span{zlib_stream}.subspan(2, zlib_stream.size() - 6))};
+        const size_t row_bytes{size_t{width} * Canvas::channels};
+        if (!filtered.has_value() || filtered->size() != height * (row_bytes + 1) ||
+            adler32(*filtered) != get_u32(zlib_stream.data() + zlib_stream.size() - 4)) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        Canvas canvas{width, height};
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t *in{filtered->data() + y * (row_bytes + 1)};
+            if (in[0] > static_cast<uint8_t>(PngFilter::paeth)) {
+                return std::unexpected(CanvasError::malformed);
+            }
+            const auto filter{static_cast<PngFilter>(in[0])};
+            uint8_t *row{canvas.storage.data() + y * row_bytes};
+            const uint8_t *previous{y > 0 ? row - row_bytes : nullptr};
+            for (size_t i = 0; i < row_bytes; ++i) {
+                const uint8_t left{i >= Canvas::channels ? row[i - Canvas::channels] : uint8_t{0}};
+                const uint8_t up{previous != nullptr ? previous[i] : uint8_t{0}};
+                const uint8_t up_left{i >= Canvas::channels && previous != nullptr ? previous[i - Canvas::channels] : uint8_t{0}};
+                row[i] = static_cast<uint8_t>(in[i + 1] + predict(filter, left, up, up_left));
+            }
+        }
+        return canvas;
+    }
+
+    std::expected<Canvas, CanvasError> decode_qoi(const std::span<const uint8_t> data) {
+        if (data.size() < qoi_header_size + qoi_end_marker.size() ||
+            !std::equal(qoi_magic.begin(), qoi_magic.end(), data.begin())) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        Canvas canvas{get_u32(data.data() + 4), get_u32(data.data() + 8)};
+        const size_t pixels{size_t{canvas.width} * canvas.height};
+        const size_t end{data.size() - qoi_end_marker.size()};
+        std::array<QoiPixel, 64> index{};
+        QoiPixel px{qoi_start_pixel};
+        size_t pos{qoi_header_size};
+        for (size_t i = 0; i < pixels; ++i) {
+            if (pos >= end) {
+                return std::unexpected(CanvasError::malformed);
+            }
+            const uint8_t op{data[pos++]};
+            size_t run{0};
+            if (op == qoi_op_rgb || op == qoi_op_rgba) {
+                if (pos + (op == qoi_op_rgb ? 3 : 4) > end) {
+                    return std::unexpected(CanvasError::malformed);
+                }
+                px.r = data[pos++];
+                px.g = data[pos++];
+                px.b = data[pos++];
+                if (op == qoi_op_rgba) {
+                    px.a = data[pos++];
+                }
+            } else if ((op & qoi_tag_mask) == qoi_op_index) {
+                px = index[op];
+            } else if ((op & qoi_tag_mask) == qoi_op_diff) {
+                px.r = static_cast<uint8_t>(px.r + ((op >> 4) & 0x03) - 2);
+                px.g = static_cast<uint8_t>(px.g + ((op >> 2) & 0x03) - 2);
+                px.b = static_cast<uint8_t>(px.b + (op & 0x03) - 2);
+            } else if ((op & qoi_tag_mask) == qoi_op_luma) {
+                if (pos >= end) {
+                    return std::unexpected(CanvasError::malformed);
+                }
+                const uint8_t next{data[pos++]};
+                const int dg{(op & 0x3F) - 32};
+                px.r = static_cast<uint8_t>(px.r + dg - 8 + ((next >> 4) & 0x0F));
+                px.g = static_cast<uint8_t>(px.g + dg);
+                px.b = static_cast<uint8_t>(px.b + dg - 8 + (next & 0x0F));
+            } else {
+                run = op & 0x3F;
+            }
+            index[px.hash()] = px;
+            const size_t last{std::min(pixels, i + run + 1)};
+            for (; i < last; ++i) {
+                std::memcpy(canvas.storage.data() + i * Canvas::channels, &px, Canvas::channels);
+            }
+            --i;
+        }
+        return canvas;
+    }
+
+    std::expected<Canvas, CanvasError> load_image(const std::string &file_path) {
+        const ImageFormat format{image_format_for(file_path)};
+        if (format == ImageFormat::ppm) {
+            return ppm_to_canvas(file_path);
+        }
+        std::ifstream in_file(file_path, std::ios::binary | std::ios::ate);
+        if (!in_file) {
+            return std::unexpected(CanvasError::invalid_path);
+        }
+        std::vector<uint8_t> contents(static_cast<size_t>(in_file.tellg()));
+        in_file.seekg(0);
+        if (!in_file.read(reinterpret_cast<char *>(contents.data()), static_cast<std::streamsize>(contents.size()))) {
+            return std::unexpected(CanvasError::malformed);
+        }
+        return format == ImageFormat::png ? decode_png(contents) : decode_qoi(contents);
+    }
+
+    std::expected<bool, CanvasError> save_image(const Canvas &canvas, const std::string &file_path,
+                                                const EncodeOptions &options) {
+        switch (image_format_for(file_path)) {
+            case ImageFormat::png:
+                return write_bytes(file_path, encode_png(canvas, options));
+            case ImageFormat::qoi:
+                return write_bytes(file_path, encode_qoi(canvas, options));
+            default:
+                return canvas_to_ppm(canvas, file_path);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_IMAGE_CODECS_HPP
+#define THE_RAYTRACER_CHALLENGE_IMAGE_CODECS_HPP
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+#include "Canvas.hpp"
+#include "ThreadPool.hpp"
+
+namespace raytracer {
+    enum class ImageFormat {
+        ppm,
+        png,
+        qoi
+    };
+
+    // picked from the file extension; anything unrecognised is written as PPM
+    ImageFormat image_format_for(const std::string &file_path);
+
+    struct EncodeOptions {
+        // pool the independent chunks are spread over; nullptr for ThreadPool::shared()
+        ThreadPool *pool{nullptr};
+        // raw bytes per independently compressed chunk; smaller chunks parallelise better but compress worse
+        size_t chunk_bytes{size_t{1} << 18};
+    };
+
+    // 8-bit RGB PNG. Rows are filtered and deflated in chunks on separate threads and the chunks are stitched into
+    // a single zlib stream, one IDAT per chunk.
+    std::vector<uint8_t> encode_png(const Canvas &canvas, const EncodeOptions &options = {});
+
+    // QOI with three channels. Each chunk of pixels is encoded on its own thread, starting from the previous pixel
+    // and colour index the decoder will have reached at that point, so chunks concatenate into a valid stream.
+    std::vector<uint8_t> encode_qoi(const Canvas &canvas, const EncodeOptions &options = {});
+
+    // decoders for what the encoders above produce: 8-bit RGB, non-interlaced PNG and three channel QOI
+    std::expected<Canvas, CanvasError> decode_png(std::span<const uint8_t> data);
+
+    std::expected<Canvas, CanvasError> decode_qoi(std::span<const uint8_t> data);
+
+    // read a PPM, PNG or QOI file, chosen by extension like save_image
+    std::expected<Canvas, CanvasError> load_image(const std::string &file_path);
+
+    std::expected<bool, CanvasError> save_image(const Canvas &canvas, const std::string &file_path,
+                                                const EncodeOptions &options = {});
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_IMAGE_CODECS_HPP
@@ -0,0 +1,83 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include "ImageDiff.hpp"
+
+namespace raytracer {
+    namespace {
+        // whole pixels per block; 255^2 * block_bytes stays well inside the 32-bit per-block sum of squares
+        constexpr size_t block_pixels{1024};
+        constexpr size_t block_bytes{block_pixels * Canvas::channels};
+
+        bool same_size(const Canvas &a, const Canvas &b) {
+            return a.width == b.width && a.height == b.height;
+        }
+    }
+
+    std::expected<DiffStats, CanvasError> compare(const Canvas &expected_image, const Canvas &actual_image) {
+        if (!same_size(expected_image, actual_image)) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        Canvas expected_scratch{0, 0};
+        Canvas actual_scratch{0, 0};
+        const Canvas &expected{linear_view(expected_image, expected_scratch)};
+        const Canvas &actual{linear_view(actual_image, actual_scratch)};
+        const size_t size{expected.storage.size()};
+        const uint8_t *a{expected.storage.data()};
+        const uint8_t *b{actual.storage.data()};
+        uint64_t sum_of_squares{0};
+        uint8_t max_error{0};
+        size_t differing{0};
+        alignas(64) std::array<uint8_t, block_bytes> difference{};
+        for (size_t start = 0; start < size; start += block_bytes) {
+            const size_t count{std::min(block_bytes, size - start)};
+            uint32_t block_squares{0};
+            uint8_t block_max{0};
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t x{a[start + i]};
+                const uint8_t y{b[start + i]};
+                const auto d{static_cast<uint8_t>(std::max(x, y) - std::min(x, y))};
+                difference[i] = d;
+                block_max = std::max(block_max, d);
+                block_squares += static_cast<uint32_t>(d) * d;
+            }
+            sum_of_squares += block_squares;
+            max_error = std::max(max_error, block_max);
+            if (block_max != 0) {
+                for (size_t i = 0; i < count; i += Canvas::channels) {
+                    differing += (difference[i] | difference[i + 1] | difference[i + 2]) != 0;
+                }
+            }
+        }
+        DiffStats stats{.max_abs_error = max_error, .differing_pixels = differing};
+        const double mse{size == 0 ? 0.0 : static_cast<double>(sum_of_squares) / static_cast<double>(size)};
+        stats.rmse = std::sqrt(mse);
+        stats.psnr = mse == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / mse);
+        return stats;
+    }
+
+    std::expected<Canvas, CanvasError> diff_image(const Canvas &expected_image, const Canvas &actual_image,
+                                                  const uint32_t gain) {
+        if (!same_size(expected_image, actual_image)) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        Canvas expected_scratch{0, 0};
+        Canvas actual_scratch{0, 0};
+        const Canvas &expected{linear_view(expected_image, expected_scratch)};
+        const Canvas &actual{linear_view(actual_image, actual_scratch)};
+        Canvas result{expected.width, expected.height};
+        const uint8_t *a{expected.storage.data()};
+        const uint8_t *b{actual.storage.data()};
+        uint8_t *out{result.storage.data()};
+        for (size_t i = 0; i < result.storage.size(); ++i) {
+            const uint32_t d{static_cast<uint32_t>(std::max(a[i], b[i]) - std::min(a[i], b[i]))};
+            out[i] = static_cast<uint8_t>(std::min(d * gain, 255u));
+        }
+        return result;
+    }
+}
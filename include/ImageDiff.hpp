@@ -0,0 +1,32 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_IMAGE_DIFF_HPP
+#define THE_RAYTRACER_CHALLENGE_IMAGE_DIFF_HPP
+
+#include <cstdint>
+#include <expected>
+#include "Canvas.hpp"
+
+namespace raytracer {
+    struct DiffStats {
+        // largest difference of any single channel, in 8-bit steps
+        uint32_t max_abs_error{0};
+        // root mean square error over every channel, in 8-bit steps
+        double rmse{0.0};
+        // peak signal to noise ratio in dB; infinite for identical images
+        double psnr{0.0};
+        // pixels where at least one channel differs
+        size_t differing_pixels{0};
+    };
+
+    // Compare two canvases of the same size. The kernels work on fixed blocks of bytes with narrow accumulators so
+    // they vectorise; a 4K frame is compared in a few milliseconds.
+    std::expected<DiffStats, CanvasError> compare(const Canvas &expected, const Canvas &actual);
+
+    // per-channel absolute difference multiplied by gain and clamped, for looking at where two images disagree
+    std::expected<Canvas, CanvasError> diff_image(const Canvas &expected, const Canvas &actual, uint32_t gain = 1);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_IMAGE_DIFF_HPP
@@ -0,0 +1,20 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "InstancedScene.hpp"
+
+namespace raytracer {
+    InstancedScene instance_scene(const Scene &scene) {
+        InstancedScene instanced{
+            .camera = scene.camera, .lights = scene.lights, .meshes = {}, .transforms = {}, .materials = {},
+            .instances = {}
+        };
+        instanced.transforms.reserve(scene.spheres.size());
+        instanced.instances.reserve(scene.spheres.size());
+        for (const auto &sphere: scene.spheres) {
+            instanced.add_instance(0, instanced.add_transform(Matrix4::from(sphere.transform)), sphere.material);
+        }
+        return instanced;
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_INSTANCED_SCENE_HPP
+#define THE_RAYTRACER_CHALLENGE_INSTANCED_SCENE_HPP
+
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+#include "Camera.hpp"
+#include "Light.hpp"
+#include "Material.hpp"
+#include "Matrix4.hpp"
+#include "Mesh.hpp"
+#include "Scene.hpp"
+
+namespace raytracer {
+    // what an instance is in object space
+    enum class Shape : uint32_t {
+        sphere,
+        mesh
+    };
+
+    // Shape data stored once and shared by every instance of it
+    struct Geometry {
+        Shape shape{Shape::sphere};
+        // for a mesh, its number in InstancedScene::meshes
+        uint32_t mesh{0};
+    };
+
+    // One object in the world: a shared geometry, placed by a transform and coloured by a material, each given by
+    // its index in the tables of the InstancedScene
+    struct Instance {
+        uint32_t geometry{0};
+        uint32_t transform{0};
+        uint32_t material{0};
+    };
+
+    // A Scene whose objects are instances. Each Sphere of a Scene carries its own transform, on the heap and in
+    // double, and its own material. An instance holds three indices instead, so objects share their geometry and
+    // any equal materials or transforms.
+    struct InstancedScene {
+        Camera camera{100, 100, std::numbers::pi / 3};
+        std::vector<PointLight> lights;
+        // the unit sphere is always geometries[0]
+        std::vector<Geometry> geometries{Geometry{}};
+        std::vector<Mesh> meshes;
+        // object to world
+        std::vector<Matrix4> transforms;
+        MaterialTable materials;
+        std::vector<Instance> instances;
+
+        // the geometry number for instances of mesh
+        uint32_t add_mesh(Mesh mesh) {
+            meshes.push_back(std::move(mesh));
+            geometries.push_back({Shape::mesh, static_cast<uint32_t>(meshes.size() - 1)});
+            return static_cast<uint32_t>(geometries.size() - 1);
+        }
+
+        uint32_t add_transform(const Matrix4 &transform) {
+            transforms.push_back(transform);
+            return static_cast<uint32_t>(transforms.size() - 1);
+        }
+
+        // a new instance of geometry, placed by an existing transform and coloured by material
+        uint32_t add_instance(const uint32_t geometry, const uint32_t transform, const Material &material) {
+            instances.push_back({geometry, transform, materials.add(material)});
+            return static_cast<uint32_t>(instances.size() - 1);
+        }
+    };
+
+    // every sphere becomes an instance of the unit sphere with its transform rounded to float and equal materials
+    // shared
+    InstancedScene instance_scene(const Scene &scene);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_INSTANCED_SCENE_HPP
@@ -2,33 +2,37 @@
 // Created by chaku on 28/12/2025.
 //
 
+#include <atomic>
 #include "Intersect.hpp"
 #include "MatrixImpl.hpp"
 
 namespace raytracer {
+    namespace {
+        // one counter for the whole program; ids start at 1
+        std::atomic<uint32_t> sphere_id{0};
+    }
+
     Point position(const Ray &ray, const float distance) {
         return ray.origin + ray.direction * distance;
     }
 
     Ray transform(const Ray &ray, const Container<double> &matrix) {
-        const Container<double> origin_container{make_container(Point{ray.origin.x, ray.origin.y, ray.origin.z})};
-        const Container<double> direction_container{4, 1, std::vector{
-            static_cast<double>(ray.direction.x),
-            static_cast<double>(ray.direction.y),
-            static_cast<double>(ray.direction.z),
-            0.0
+        // the same sums multiply() would form for the point and the direction as 4x1 containers, without building
+        // either; this runs for every sphere on every ray
+        const auto &m{matrix.m_data};
+        const auto row{[&m](const size_t r, const double x, const double y, const double z, const double w) {
+            double sum{0};
+            sum += m[r * 4] * x;
+            sum += m[r * 4 + 1] * y;
+            sum += m[r * 4 + 2] * z;
+            sum += m[r * 4 + 3] * w;
+            return static_cast<float>(sum);
         }};
-
-        const Container<double> new_origin{multiply(matrix, origin_container)};
-        const Container<double> new_direction{multiply(matrix, direction_container)};
-
+        const Point &o{ray.origin};
+        const Vector &d{ray.direction};
         return Ray{
-            Point{static_cast<float>(new_origin.m_data[0]),
-                  static_cast<float>(new_origin.m_data[1]),
-                  static_cast<float>(new_origin.m_data[2])},
-            Vector{static_cast<float>(new_direction.m_data[0]),
-                   static_cast<float>(new_direction.m_data[1]),
-                   static_cast<float>(new_direction.m_data[2])}
+            Point{row(0, o.x, o.y, o.z, 1), row(1, o.x, o.y, o.z, 1), row(2, o.x, o.y, o.z, 1)},
+            Vector{row(0, d.x, d.y, d.z, 0), row(1, d.x, d.y, d.z, 0), row(2, d.x, d.y, d.z, 0)}
         };
     }
 
@@ -75,7 +79,7 @@ namespace raytracer {
     }
 
     Sphere Sphere::make_sphere() {
-        return Sphere(++sphere_id);
+        return Sphere(sphere_id.fetch_add(1, std::memory_order_relaxed) + 1);
     }
 
     Vector Sphere::normal_at(const Point &point) {
@@ -84,6 +88,7 @@ namespace raytracer {
 
     void Sphere::set_transform(const Container<double> &t) {
         transform = t;
+        transform_dirty = true;
     }
 
     std::optional<Intersection> hit(const std::vector<Intersection> &intersections) {
@@ -13,8 +13,6 @@
 #include <optional>
 
 namespace raytracer {
-    static uint32_t sphere_id{0};
-
     struct Ray {
         Point origin{};
         Vector direction{};
@@ -28,11 +26,15 @@ namespace raytracer {
         uint32_t id;
         Container<double> transform{Container<double>::identity(4)};
         Material material;
+        // set by set_transform and cleared by whatever caches something derived from the transform, so that only
+        // what moved is recomputed; a new sphere starts out dirty
+        bool transform_dirty{true};
 
         Sphere() = delete;
 
         explicit Sphere(const uint32_t id) : id(id) {};
 
+        // a sphere with an id no other made by this function has, from any thread or translation unit
         static Sphere make_sphere();
 
         void set_transform(const Container<double> &t);
@@ -0,0 +1,34 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <numeric>
+#include "Light.hpp"
+
+namespace raytracer {
+    LightSet LightSet::from(const std::span<const PointLight> lights) {
+        const auto brightest{[](const PointLight &light) {
+            return std::max({light.intensity.r, light.intensity.g, light.intensity.b});
+        }};
+        // stable, so lights of equal brightness keep the order they were given in
+        std::vector<size_t> order(lights.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::ranges::stable_sort(order, [&](const size_t a, const size_t b) {
+            return brightest(lights[a]) > brightest(lights[b]);
+        });
+        LightSet set;
+        for (const size_t i: order) {
+            const PointLight &light{lights[i]};
+            set.position_x.push_back(light.position.x);
+            set.position_y.push_back(light.position.y);
+            set.position_z.push_back(light.position.z);
+            set.intensity_r.push_back(light.intensity.r);
+            set.intensity_g.push_back(light.intensity.g);
+            set.intensity_b.push_back(light.intensity.b);
+            set.brightness.push_back(brightest(light));
+            set.total_intensity = set.total_intensity + light.intensity;
+        }
+        return set;
+    }
+}
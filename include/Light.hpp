@@ -5,6 +5,8 @@
 #ifndef THE_RAYTRACER_CHALLENGE_LIGHT_HPP
 #define THE_RAYTRACER_CHALLENGE_LIGHT_HPP
 
+#include <span>
+#include <vector>
 #include "Colour.hpp"
 #include "Point.hpp"
 
@@ -13,6 +15,31 @@ namespace raytracer {
         Point position;
         Colour intensity{0, 0, 0};
     };
+
+    // Any number of lights, a column per component, so shading against all of them is one loop over contiguous
+    // floats. They are kept brightest first: a loop that finds a light too dim to matter can stop there, as every
+    // light after it is dimmer. The ambient term does not depend on where a light is, so the lights' total intensity
+    // is kept too and that term is worked out once for all of them.
+    struct LightSet {
+        std::vector<float> position_x;
+        std::vector<float> position_y;
+        std::vector<float> position_z;
+        std::vector<float> intensity_r;
+        std::vector<float> intensity_g;
+        std::vector<float> intensity_b;
+        // the largest of each light's three channels, in descending order
+        std::vector<float> brightness;
+        Colour total_intensity{0, 0, 0};
+
+        static LightSet from(std::span<const PointLight> lights);
+
+        [[nodiscard]] size_t size() const { return brightness.size(); }
+
+        [[nodiscard]] PointLight light(const size_t i) const {
+            return {Point{position_x[i], position_y[i], position_z[i]},
+                    Colour{intensity_r[i], intensity_g[i], intensity_b[i]}};
+        }
+    };
 }
 
-#endif //THE_RAYTRACER_CHALLENGE_LIGHT_HPP
\ No newline at end of file
+#endif //THE_RAYTRACER_CHALLENGE_LIGHT_HPP
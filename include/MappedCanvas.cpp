@@ -0,0 +1,103 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <cstring>
+#include <utility>
+#include "MappedCanvas.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define RAYTRACER_HAS_MMAP 1
+#endif
+
+namespace raytracer {
+    MappedCanvas::MappedCanvas(const int fd, std::byte *mapping, const size_t mapping_size, const size_t header_size,
+                               const uint32_t w, const uint32_t h)
+        : width(w), height(h), file_descriptor(fd), mapping(mapping), mapping_size(mapping_size),
+          pixel_data(reinterpret_cast<uint8_t *>(mapping + header_size)) {
+    }
+
+    MappedCanvas::MappedCanvas(MappedCanvas &&other) noexcept
+        : width(other.width), height(other.height),
+          file_descriptor(std::exchange(other.file_descriptor, -1)),
+          mapping(std::exchange(other.mapping, nullptr)),
+          mapping_size(std::exchange(other.mapping_size, 0)),
+          pixel_data(std::exchange(other.pixel_data, nullptr)) {
+    }
+
+    MappedCanvas &MappedCanvas::operator=(MappedCanvas &&other) noexcept {
+        if (this != &other) {
+            release();
+            width = other.width;
+            height = other.height;
+            file_descriptor = std::exchange(other.file_descriptor, -1);
+            mapping = std::exchange(other.mapping, nullptr);
+            mapping_size = std::exchange(other.mapping_size, 0);
+            pixel_data = std::exchange(other.pixel_data, nullptr);
+        }
+        return *this;
+    }
+
+    MappedCanvas::~MappedCanvas() {
+        release();
+    }
+
+#ifdef RAYTRACER_HAS_MMAP
+    std::expected<MappedCanvas, CanvasError> MappedCanvas::create(const std::string &file_path, const uint32_t width,
+                                                                  const uint32_t height) {
+        const std::string header{ppm_header(PpmFormat::binary, width, height)};
+        const size_t file_size{header.size() + size_t{width} * height * Canvas::channels};
+
+        const int fd{::open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+        if (fd < 0) {
+            return std::unexpected(CanvasError::invalid_path);
+        }
+        // the file is sized up front and stays sparse until pixels are written
+        if (::ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+            ::close(fd);
+            return std::unexpected(CanvasError::write_failed);
+        }
+        void *address{::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            return std::unexpected(CanvasError::write_failed);
+        }
+        auto *mapping{static_cast<std::byte *>(address)};
+        std::memcpy(mapping, header.data(), header.size());
+        return MappedCanvas{fd, mapping, file_size, header.size(), width, height};
+    }
+
+    std::expected<bool, CanvasError> MappedCanvas::flush() const {
+        if (::msync(mapping, mapping_size, MS_SYNC) != 0) {
+            return std::unexpected(CanvasError::write_failed);
+        }
+        return true;
+    }
+
+    void MappedCanvas::release() {
+        if (mapping != nullptr) {
+            ::munmap(mapping, mapping_size);
+            mapping = nullptr;
+        }
+        if (file_descriptor >= 0) {
+            ::close(file_descriptor);
+            file_descriptor = -1;
+        }
+        pixel_data = nullptr;
+    }
+#else
+    std::expected<MappedCanvas, CanvasError> MappedCanvas::create(const std::string &, const uint32_t, const uint32_t) {
+        return std::unexpected(CanvasError::unsupported);
+    }
+
+    std::expected<bool, CanvasError> MappedCanvas::flush() const {
+        return std::unexpected(CanvasError::unsupported);
+    }
+
+    void MappedCanvas::release() {
+    }
+#endif
+}
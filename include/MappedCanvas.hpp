@@ -0,0 +1,64 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_MAPPED_CANVAS_HPP
+#define THE_RAYTRACER_CHALLENGE_MAPPED_CANVAS_HPP
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include "Canvas.hpp"
+#include "Colour.hpp"
+
+namespace raytracer {
+    // A canvas whose pixels live in a memory-mapped binary PPM file. The header is written when the file is created
+    // and the pixel bytes follow it in exactly the layout of Canvas::storage, so the file is complete as soon as the
+    // last pixel is written and the kernel is free to page finished rows out. Threads may write distinct pixels
+    // concurrently.
+    class MappedCanvas {
+    public:
+        static std::expected<MappedCanvas, CanvasError> create(const std::string &file_path, uint32_t width,
+                                                               uint32_t height);
+
+        MappedCanvas(const MappedCanvas &) = delete;
+        MappedCanvas &operator=(const MappedCanvas &) = delete;
+        MappedCanvas(MappedCanvas &&other) noexcept;
+        MappedCanvas &operator=(MappedCanvas &&other) noexcept;
+        ~MappedCanvas();
+
+        void write_pixel(const uint32_t pix_w, const uint32_t pix_h, const Colour &colour) {
+            uint8_t *pixel{pixel_data + (size_t{pix_h} * width + pix_w) * Canvas::channels};
+            pixel[0] = to_byte(colour.r);
+            pixel[1] = to_byte(colour.g);
+            pixel[2] = to_byte(colour.b);
+        }
+
+        [[nodiscard]] std::span<uint8_t> pixels() const {
+            return {pixel_data, size_t{width} * height * Canvas::channels};
+        }
+
+        [[nodiscard]] std::span<uint8_t> row(const uint32_t pix_h) const {
+            return {pixel_data + size_t{pix_h} * width * Canvas::channels, size_t{width} * Canvas::channels};
+        }
+
+        // write dirty pages back to the file and wait for it
+        std::expected<bool, CanvasError> flush() const;
+
+        uint32_t width{0};
+        uint32_t height{0};
+
+    private:
+        MappedCanvas(int fd, std::byte *mapping, size_t mapping_size, size_t header_size, uint32_t w, uint32_t h);
+
+        void release();
+
+        int file_descriptor{-1};
+        std::byte *mapping{nullptr};
+        size_t mapping_size{0};
+        uint8_t *pixel_data{nullptr};
+    };
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_MAPPED_CANVAS_HPP
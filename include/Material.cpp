@@ -2,9 +2,60 @@
 // Created by chaku on 15/03/2026.
 //
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numbers>
 #include "Material.hpp"
 
 namespace raytracer {
+    namespace {
+        // the diffuse and specular terms of lighting(), for light_vector the unit vector towards the light
+        Colour direct_light(const Material &material, const Colour &intensity, const Vector &light_vector,
+                            const Vector &eye, const Vector &normal) {
+            // this is the cosine of the angle between light vector and normal. Negative number means light is on the
+            // other side of the surface
+            const auto &light_dot_normal{Vector::dot(light_vector, normal)};
+            Colour diffuse{0, 0, 0};
+            Colour specular{0, 0, 0};
+            if (light_dot_normal > 0) {
+                diffuse = material.colour * intensity * material.diffuse * light_dot_normal;
+                const auto &reflect{Vector::reflect(-light_vector, normal)};
+                if (const auto reflect_dot_eye{Vector::dot(reflect, eye)}; reflect_dot_eye > 0) {
+                    const auto factor = std::pow(reflect_dot_eye, material.shininess);
+                    specular = intensity * material.specular * factor;
+                }
+            }
+            return diffuse + specular;
+        }
+
+        // the most any light of brightness 1 can add to a channel through the diffuse and specular terms
+        float reach_of(const Material &material) {
+            return material.diffuse * std::max({material.colour.r, material.colour.g, material.colour.b}) +
+                   material.specular;
+        }
+    }
+
+    size_t MaterialTable::Hash::operator()(const Material &material) const {
+        // equal materials must hash equally, and 0 and -0 are equal, so both are hashed as 0
+        size_t hash{0};
+        for (const float field: {material.colour.r, material.colour.g, material.colour.b, material.ambient,
+                                 material.diffuse, material.specular, material.shininess, material.reflective,
+                                 material.transparency, material.refractive_index}) {
+            hash = (hash ^ std::bit_cast<uint32_t>(field + 0.0f)) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    uint32_t MaterialTable::add(const Material &material) {
+        const auto [entry, added]{lookup.try_emplace(material, static_cast<uint32_t>(materials.size()))};
+        if (added) {
+            materials.push_back(material);
+        }
+        return entry->second;
+    }
+
     Colour lighting(const Material &material, const PointLight &light, const Point &point, const Vector &eye,
         const Vector &normal)
     {
@@ -17,20 +68,319 @@ namespace raytracer {
         // compute the ambient contribution
         const auto &ambient{effective_colour * material.ambient};
 
-        // this is the cosine of the angle between light vector and normal. Negative number means light is on the other
-        // side of the surface
-        const auto &light_dot_normal{Vector::dot(light_vector, normal)};
-        Colour diffuse{0, 0, 0};
-        Colour specular{0, 0, 0};
-        if (light_dot_normal > 0) {
-            diffuse = effective_colour * material.diffuse * light_dot_normal;
-            const auto& reflect{Vector::reflect(-light_vector, normal)};
-            if (const auto reflect_dot_eye{Vector::dot(reflect, eye)}; reflect_dot_eye > 0) {
-                const auto factor = std::pow(reflect_dot_eye, material.shininess);
-                specular = light.intensity * material.specular * factor;
+        return ambient + direct_light(material, light.intensity, light_vector, eye, normal);
+    }
+
+    Colour lighting(const Material &material, const LightSet &lights, const Point &point, const Vector &eye,
+                    const Vector &normal, const float cutoff) {
+        Colour colour{material.colour * lights.total_intensity * material.ambient};
+        const float material_reach{reach_of(material)};
+        for (size_t i = 0; i < lights.size(); ++i) {
+            // brightest first, so no light from here on can reach the cutoff either
+            if (lights.brightness[i] * material_reach < cutoff) {
+                break;
             }
+            const Vector to_light{
+                lights.position_x[i] - point.x, lights.position_y[i] - point.y, lights.position_z[i] - point.z
+            };
+            // behind the surface: nothing but the ambient term, which is already in, so not even normalised
+            if (Vector::dot(to_light, normal) <= 0) {
+                continue;
+            }
+            const Colour intensity{lights.intensity_r[i], lights.intensity_g[i], lights.intensity_b[i]};
+            colour = colour + direct_light(material, intensity, Vector::normalize(to_light), eye, normal);
         }
-        return ambient + diffuse + specular;
+        return colour;
     }
 
+    namespace {
+        // log2 of x > 0: the exponent from the bits, and the log of the mantissa, moved into [sqrt(1/2), sqrt(2)),
+        // from the series of atanh in t = (m - 1) / (m + 1), where |t| < 0.172 so five terms are plenty
+        inline float fast_log2(const float x) {
+            const auto bits{std::bit_cast<uint32_t>(std::max(x, std::numeric_limits<float>::min()))};
+            // subtracting the bits of sqrt(1/2) picks the exponent that puts the mantissa in the range above
+            const uint32_t shifted{bits - 0x3f3504f3u};
+            const auto exponent{static_cast<float>(static_cast<int32_t>(shifted) >> 23)};
+            const float m{std::bit_cast<float>((shifted & 0x007fffffu) + 0x3f3504f3u)};
+            const float t{(m - 1) / (m + 1)};
+            const float t2{t * t};
+            const float series{t * (2.0f + t2 * (2.0f / 3 + t2 * (2.0f / 5 + t2 * (2.0f / 7 + t2 * (2.0f / 9)))))};
+            return exponent + series * std::numbers::log2e_v<float>;
+        }
+
+        // 2 to the y: the nearest whole number into the exponent bits, the rest f from a polynomial for e^(f ln 2),
+        // below 2e-7 relative error for f in [-1/2, 1/2] and exactly 1 at f = 0; 0 below 2^-126
+        inline float fast_exp2(const float y) {
+            const float clamped{std::clamp(y, -126.0f, 127.0f)};
+            // rounded by truncating a positive number, which unlike std::round is a single vector instruction
+            const auto whole{static_cast<float>(static_cast<int32_t>(clamped + 126.5f) - 126)};
+            const float u{(clamped - whole) * std::numbers::ln2_v<float>};
+            const float e{
+                1 + u * (1 + u * (1.0f / 2 + u * (1.0f / 6 + u * (1.0f / 24 + u * (1.0f / 120 + u * (1.0f / 720))))))
+            };
+            const float scale{std::bit_cast<float>(static_cast<uint32_t>(static_cast<int32_t>(whole) + 127) << 23)};
+            // 0 rather than a denormal, which the specular term multiplies on and which is slow in every lane
+            return y >= -126.0f ? scale * e : 0.0f;
+        }
+    }
+
+    float fast_pow(const float x, const float y) {
+        return fast_exp2(y * fast_log2(x));
+    }
+
+    ShadingTable ShadingTable::build(const std::span<const Material> materials, const LightSet &lights,
+                                     const size_t max_entries) {
+        ShadingTable table;
+        table.lights = lights;
+        for (const Material &material: materials) {
+            const Colour ambient{material.colour * lights.total_intensity * material.ambient};
+            table.ambient_r.push_back(ambient.r);
+            table.ambient_g.push_back(ambient.g);
+            table.ambient_b.push_back(ambient.b);
+            table.shininess.push_back(material.shininess);
+            table.reach.push_back(reach_of(material));
+            table.reflective.push_back(material.reflective);
+            table.transparency.push_back(material.transparency);
+            table.refractive_index.push_back(material.refractive_index);
+            table.colour_r.push_back(material.colour.r);
+            table.colour_g.push_back(material.colour.g);
+            table.colour_b.push_back(material.colour.b);
+            table.diffuse.push_back(material.diffuse);
+            table.specular.push_back(material.specular);
+        }
+        const size_t entries{materials.size() * lights.size()};
+        if (entries > max_entries) {
+            return table;
+        }
+        for (auto *column: {&table.diffuse_r, &table.diffuse_g, &table.diffuse_b, &table.specular_r,
+                            &table.specular_g, &table.specular_b}) {
+            column->reserve(entries);
+        }
+        for (size_t light = 0; light < lights.size(); ++light) {
+            const Colour intensity{lights.intensity_r[light], lights.intensity_g[light], lights.intensity_b[light]};
+            for (const Material &material: materials) {
+                const Colour diffuse{material.colour * intensity * material.diffuse};
+                const Colour specular{intensity * material.specular};
+                table.diffuse_r.push_back(diffuse.r);
+                table.diffuse_g.push_back(diffuse.g);
+                table.diffuse_b.push_back(diffuse.b);
+                table.specular_r.push_back(specular.r);
+                table.specular_g.push_back(specular.g);
+                table.specular_b.push_back(specular.b);
+            }
+        }
+        return table;
+    }
+
+    namespace {
+        // one lane's material under one light: its diffuse and specular colours, for the kernel below
+        struct LaneMaterial {
+            float diffuse_r;
+            float diffuse_g;
+            float diffuse_b;
+            float specular_r;
+            float specular_g;
+            float specular_b;
+            float shininess;
+        };
+
+        // The diffuse and specular terms of the light at position for every lane of batch, with material_of(i) the
+        // LaneMaterial of lane i. Every lane is computed, whatever count is, and the terms that do not apply are
+        // multiplied by masks, so this loop has no branches and a fixed length, and is compiled to vector
+        // instructions without a scalar remainder; the materials are read lane by lane, which with AVX2 is a gather.
+        // Lanes past count still read a material, the first, so there has to be one. The results are returned
+        // rather than added to the caller's, which the compiler would have to assume might be batch. Lanes whose
+        // bit in visible is clear, those in shadow, get nothing.
+        template<typename LaneMaterialOf>
+        ColourBatch direct_light(const Point position, const ShadingBatch &batch, LaneMaterialOf &&material_of,
+                                 const uint32_t visible = ~0u) {
+            ColourBatch lit;
+            for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+                const float to_light_x{position.x - batch.point_x[i]};
+                const float to_light_y{position.y - batch.point_y[i]};
+                const float to_light_z{position.z - batch.point_z[i]};
+                const float inverse_length{
+                    1 / std::sqrt(to_light_x * to_light_x + to_light_y * to_light_y + to_light_z * to_light_z)
+                };
+                const float light_x{to_light_x * inverse_length};
+                const float light_y{to_light_y * inverse_length};
+                const float light_z{to_light_z * inverse_length};
+                const float light_dot_normal{
+                    light_x * batch.normal_x[i] + light_y * batch.normal_y[i] + light_z * batch.normal_z[i]
+                };
+                // the light reflected about the normal, 2 (l.n) n - l, against the eye
+                const float reflect_dot_eye{
+                    (2 * light_dot_normal * batch.normal_x[i] - light_x) * batch.eye_x[i] +
+                    (2 * light_dot_normal * batch.normal_y[i] - light_y) * batch.eye_y[i] +
+                    (2 * light_dot_normal * batch.normal_z[i] - light_z) * batch.eye_z[i]
+                };
+                // the light's side of the surface and the reflection's side of the eye, as 1 or 0 to multiply by
+                const auto facing{static_cast<float>(light_dot_normal > 0) * static_cast<float>(visible >> i & 1)};
+                const auto towards_eye{static_cast<float>(reflect_dot_eye > 0)};
+                const LaneMaterial material{material_of(i)};
+                const float factor{fast_exp2(material.shininess * fast_log2(std::max(reflect_dot_eye, 0.0f)))};
+                const float diffuse{std::max(light_dot_normal, 0.0f) * facing};
+                const float specular{factor * facing * towards_eye};
+                lit.r[i] = material.diffuse_r * diffuse + material.specular_r * specular;
+                lit.g[i] = material.diffuse_g * diffuse + material.specular_g * specular;
+                lit.b[i] = material.diffuse_b * diffuse + material.specular_b * specular;
+            }
+            return lit;
+        }
+
+        // what direct_light() needs of material under a light of the given intensity
+        LaneMaterial lane_material(const Material &material, const Colour intensity) {
+            return {
+                material.colour.r * intensity.r * material.diffuse, material.colour.g * intensity.g * material.diffuse,
+                material.colour.b * intensity.b * material.diffuse, intensity.r * material.specular,
+                intensity.g * material.specular, intensity.b * material.specular, material.shininess
+            };
+        }
+
+        // the ambient term of lights of the given total intensity for every lane of batch
+        ColourBatch ambient_light(const std::span<const Material> materials, const Colour intensity,
+                                  const ShadingBatch &batch) {
+            ColourBatch lit;
+            for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+                const Material &material{materials[batch.material[i]]};
+                lit.r[i] = material.colour.r * intensity.r * material.ambient;
+                lit.g[i] = material.colour.g * intensity.g * material.ambient;
+                lit.b[i] = material.colour.b * intensity.b * material.ambient;
+            }
+            return lit;
+        }
+
+        // from is a copy, which unlike a reference cannot be to, so these loops are vectorised too
+        void add(const ColourBatch from, ColourBatch &to) {
+            for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+                to.r[i] += from.r[i];
+                to.g[i] += from.g[i];
+                to.b[i] += from.b[i];
+            }
+        }
+
+        // lanes from count on are left as they are, even if what was computed for them is not a number
+        void add_lanes(const ShadingBatch &batch, const ColourBatch from, ColourBatch &to) {
+            for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+                const bool active{i < batch.count};
+                to.r[i] += active ? from.r[i] : 0.0f;
+                to.g[i] += active ? from.g[i] : 0.0f;
+                to.b[i] += active ? from.b[i] : 0.0f;
+            }
+        }
+
+        // Adds direct_light(light, position, lanes) to lit for every light of lights that can matter to batch: the
+        // lights are brightest first, so the loop stops at the first that cannot add cutoff to any lane, batch_reach
+        // being the largest reach() of the lanes' materials, and a light is skipped when every lane has its back to
+        // it. lanes has bit i set for each lane i that faces the light.
+        template<typename DirectLight>
+        void add_lights(const LightSet &lights, const ShadingBatch &batch, const float batch_reach, const float cutoff,
+                        ColourBatch &lit, DirectLight &&direct_light) {
+            for (size_t light = 0; light < lights.size(); ++light) {
+                if (lights.brightness[light] * batch_reach < cutoff) {
+                    break;
+                }
+                const Point position{lights.position_x[light], lights.position_y[light], lights.position_z[light]};
+                uint32_t facing{0};
+                for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+                    const float to_light_dot_normal{
+                        (position.x - batch.point_x[i]) * batch.normal_x[i] +
+                        (position.y - batch.point_y[i]) * batch.normal_y[i] +
+                        (position.z - batch.point_z[i]) * batch.normal_z[i]
+                    };
+                    facing |= (static_cast<uint32_t>(to_light_dot_normal > 0) &
+                               static_cast<uint32_t>(i < batch.count)) << i;
+                }
+                if (facing != 0) {
+                    add(direct_light(light, position, facing), lit);
+                }
+            }
+        }
+    }
+
+    void lighting(const std::span<const Material> materials, const PointLight &light, const ShadingBatch &batch,
+                  ColourBatch &colours) {
+        if (batch.count == 0) {
+            return;
+        }
+        ColourBatch lit{ambient_light(materials, light.intensity, batch)};
+        add(direct_light(light.position, batch, [&](const uint32_t i) {
+            return lane_material(materials[batch.material[i]], light.intensity);
+        }), lit);
+        add_lanes(batch, lit, colours);
+    }
+
+    void lighting(const std::span<const Material> materials, const LightSet &lights, const ShadingBatch &batch,
+                  ColourBatch &colours, const float cutoff) {
+        if (batch.count == 0) {
+            return;
+        }
+        ColourBatch lit{ambient_light(materials, lights.total_intensity, batch)};
+        float batch_reach{0};
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            batch_reach = std::max(batch_reach, reach_of(materials[batch.material[i]]));
+        }
+        add_lights(lights, batch, batch_reach, cutoff, lit, [&](const size_t light, const Point position, uint32_t) {
+            const Colour intensity{lights.intensity_r[light], lights.intensity_g[light], lights.intensity_b[light]};
+            return direct_light(position, batch, [&](const uint32_t i) {
+                return lane_material(materials[batch.material[i]], intensity);
+            });
+        });
+        add_lanes(batch, lit, colours);
+    }
+
+    void lighting(const ShadingTable &table, const ShadingBatch &batch, ColourBatch &colours, const float cutoff) {
+        lighting(table, batch, colours, cutoff, {});
+    }
+
+    void lighting(const ShadingTable &table, const ShadingBatch &batch, ColourBatch &colours, const float cutoff,
+                  const ShadowTest &shadowed) {
+        if (batch.count == 0) {
+            return;
+        }
+        ColourBatch lit;
+        for (uint32_t i = 0; i < ShadingBatch::width; ++i) {
+            lit.r[i] = table.ambient_r[batch.material[i]];
+            lit.g[i] = table.ambient_g[batch.material[i]];
+            lit.b[i] = table.ambient_b[batch.material[i]];
+        }
+        float batch_reach{0};
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            batch_reach = std::max(batch_reach, table.reach[batch.material[i]]);
+        }
+        const auto material_count{static_cast<uint32_t>(table.material_count())};
+        const bool per_light{table.per_light()};
+        add_lights(table.lights, batch, batch_reach, cutoff, lit,
+                   [&](const size_t light, const Point position, const uint32_t facing) {
+                       const uint32_t visible{shadowed ? facing & ~shadowed(light, position, facing) : facing};
+                       if (!per_light) {
+                           const Colour intensity{
+                               table.lights.intensity_r[light], table.lights.intensity_g[light],
+                               table.lights.intensity_b[light]
+                           };
+                           // multiplied in the order build() does
+                           return direct_light(position, batch, [&](const uint32_t i) {
+                               const uint32_t m{batch.material[i]};
+                               return LaneMaterial{
+                                   table.colour_r[m] * intensity.r * table.diffuse[m],
+                                   table.colour_g[m] * intensity.g * table.diffuse[m],
+                                   table.colour_b[m] * intensity.b * table.diffuse[m],
+                                   intensity.r * table.specular[m], intensity.g * table.specular[m],
+                                   intensity.b * table.specular[m], table.shininess[m]
+                               };
+                           }, visible);
+                       }
+                       // 32 bits, for gathers of eight lanes rather than four
+                       const uint32_t first{static_cast<uint32_t>(light) * material_count};
+                       return direct_light(position, batch, [&](const uint32_t i) {
+                           const uint32_t entry{first + batch.material[i]};
+                           return LaneMaterial{
+                               table.diffuse_r[entry], table.diffuse_g[entry], table.diffuse_b[entry],
+                               table.specular_r[entry], table.specular_g[entry], table.specular_b[entry],
+                               table.shininess[batch.material[i]]
+                           };
+                       }, visible);
+                   });
+        add_lanes(batch, lit, colours);
+    }
 }
@@ -5,6 +5,12 @@
 #ifndef THE_RAYTRACER_CHALLENGE_MATERIAL_HPP
 #define THE_RAYTRACER_CHALLENGE_MATERIAL_HPP
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
 #include "Colour.hpp"
 #include "Light.hpp"
 
@@ -15,12 +21,160 @@ namespace raytracer {
         float diffuse{0.9};
         float specular{0.9};
         float shininess{200.0};
+        // share of the light arriving along the mirror direction that is reflected, 0 to 1
+        float reflective{0};
+        // share of the light behind the surface that passes through it, 0 to 1, bent by refractive_index
+        float transparency{0};
+        float refractive_index{1};
 
         constexpr auto operator<=>(const Material &) const = default;
     };
 
+    // Distinct materials, each stored once however many objects use it
+    class MaterialTable {
+    public:
+        // index of an equal material already in the table, or of material newly added
+        uint32_t add(const Material &material);
+
+        [[nodiscard]] std::span<const Material> entries() const { return materials; }
+
+        [[nodiscard]] size_t size() const { return materials.size(); }
+
+        [[nodiscard]] const Material &operator[](const size_t i) const { return materials[i]; }
+
+    private:
+        struct Hash {
+            size_t operator()(const Material &material) const;
+        };
+
+        std::vector<Material> materials;
+        std::unordered_map<Material, uint32_t, Hash> lookup;
+    };
+
     Colour lighting(const Material &material, const PointLight &light, const Point &point, const Vector &eye,
                     const Vector &normal);
+
+    // lighting() summed over every light of lights, with the ambient term from their total intensity. A light the
+    // point has its back to adds nothing more and is skipped before anything is normalised. Lights are visited
+    // brightest first and the loop stops at the first whose most possible addition to any channel,
+    // brightness * (diffuse * brightest channel of colour + specular), is below cutoff; with a cutoff of 0 only lights
+    // that would add nothing are skipped. The cutoff bounds each light on its own, so many lights just under it can
+    // add up to more than it.
+    Colour lighting(const Material &material, const LightSet &lights, const Point &point, const Vector &eye,
+                    const Vector &normal, float cutoff = 0);
+
+    // Points to shade, a column per component so the kernel works on every lane at once. Lanes from count on are
+    // masked out and left alone.
+    struct ShadingBatch {
+        static constexpr uint32_t width{16};
+
+        std::array<float, width> point_x{};
+        std::array<float, width> point_y{};
+        std::array<float, width> point_z{};
+        std::array<float, width> normal_x{};
+        std::array<float, width> normal_y{};
+        std::array<float, width> normal_z{};
+        std::array<float, width> eye_x{};
+        std::array<float, width> eye_y{};
+        std::array<float, width> eye_z{};
+        // index into the materials given to lighting()
+        std::array<uint32_t, width> material{};
+        uint32_t count{0};
+
+        // fills the next lane; normal and eye are unit vectors, as for lighting()
+        void add(const Point &point, const Vector &normal, const Vector &eye, const uint32_t material_index) {
+            point_x[count] = point.x;
+            point_y[count] = point.y;
+            point_z[count] = point.z;
+            normal_x[count] = normal.x;
+            normal_y[count] = normal.y;
+            normal_z[count] = normal.z;
+            eye_x[count] = eye.x;
+            eye_y[count] = eye.y;
+            eye_z[count] = eye.z;
+            material[count] = material_index;
+            ++count;
+        }
+    };
+
+    // light reaching the eye from each lane, added up over however many lighting() calls
+    struct ColourBatch {
+        std::array<float, ShadingBatch::width> r{};
+        std::array<float, ShadingBatch::width> g{};
+        std::array<float, ShadingBatch::width> b{};
+    };
+
+    // lighting() for every lane of batch, added to colours. The specular power is exp2(shininess * log2(x)) with
+    // both functions approximated by polynomials in float, a relative error below 2e-5 of std::pow for shininess
+    // up to 1000; for lights of intensity up to 1 each channel is within 1e-4 of lighting().
+    void lighting(std::span<const Material> materials, const PointLight &light, const ShadingBatch &batch,
+                  ColourBatch &colours);
+
+    // the same for every light of lights, culled as by the scalar overload above: a light is skipped for the whole
+    // batch when every lane has its back to it, and the loop stops at the first light below cutoff in every lane
+    void lighting(std::span<const Material> materials, const LightSet &lights, const ShadingBatch &batch,
+                  ColourBatch &colours, float cutoff = 0);
+
+    // What the batched lighting() needs of a scene's distinct materials under its lights, worked out once when the
+    // scene is loaded rather than for every point: the ambient term of each material under all the lights together,
+    // and for each light and material the diffuse colour, colour * intensity * diffuse, and the specular colour,
+    // intensity * specular. Entry m of the per-material columns is material m of the list the table was built from;
+    // the per-light columns hold a run of material_count() entries per light, in the order of lights, so they grow
+    // with materials times lights. Past max_entries of those they are left empty and lighting() multiplies the
+    // same products out per lane from the per-material columns instead, to the same bits.
+    struct ShadingTable {
+        // 24 MiB of per-light columns
+        static constexpr size_t default_max_entries{size_t{1} << 20};
+
+        LightSet lights;
+        std::vector<float> ambient_r;
+        std::vector<float> ambient_g;
+        std::vector<float> ambient_b;
+        std::vector<float> shininess;
+        // the most a light of brightness 1 can add to a channel, to cull lights by
+        std::vector<float> reach;
+        // what secondary rays need, copied from the materials
+        std::vector<float> reflective;
+        std::vector<float> transparency;
+        std::vector<float> refractive_index;
+        // colour and diffuse and specular factors, for when there are no per-light columns
+        std::vector<float> colour_r;
+        std::vector<float> colour_g;
+        std::vector<float> colour_b;
+        std::vector<float> diffuse;
+        std::vector<float> specular;
+        // entry light * material_count() + material
+        std::vector<float> diffuse_r;
+        std::vector<float> diffuse_g;
+        std::vector<float> diffuse_b;
+        std::vector<float> specular_r;
+        std::vector<float> specular_g;
+        std::vector<float> specular_b;
+
+        static ShadingTable build(std::span<const Material> materials, const LightSet &lights,
+                                  size_t max_entries = default_max_entries);
+
+        [[nodiscard]] size_t material_count() const { return shininess.size(); }
+
+        // whether the per-light columns were filled in
+        [[nodiscard]] bool per_light() const { return diffuse_r.size() == material_count() * lights.size(); }
+    };
+
+    // the same from a table, with the lanes' material numbers counting its materials; nothing is multiplied out per
+    // point that does not depend on where the point is
+    void lighting(const ShadingTable &table, const ShadingBatch &batch, ColourBatch &colours, float cutoff = 0);
+
+    // Which lanes of a batch are in shadow from a light: given the number of the light in the table's LightSet, its
+    // position and the lanes that face it, lane i as bit i, returns those of them with something in between.
+    using ShadowTest = std::function<uint32_t(size_t light, const Point &position, uint32_t lanes)>;
+
+    // the same with shadows: lanes whose bit shadowed() returns set get only the ambient term of that light; it is
+    // called only for lights that survive the cutoff and only with lanes that face them
+    void lighting(const ShadingTable &table, const ShadingBatch &batch, ColourBatch &colours, float cutoff,
+                  const ShadowTest &shadowed);
+
+    // x to the power y for x in (0, 1] and y >= 0, as used by the batched lighting()
+    float fast_pow(float x, float y);
 }
 
 #endif //THE_RAYTRACER_CHALLENGE_MATERIAL_HPP
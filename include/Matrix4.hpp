@@ -0,0 +1,134 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_MATRIX4_HPP
+#define THE_RAYTRACER_CHALLENGE_MATRIX4_HPP
+
+#include <algorithm>
+#include <array>
+#include <expected>
+#include "Matrix.hpp"
+#include "Point.hpp"
+#include "Vector.hpp"
+
+namespace raytracer {
+    // Fixed-size, trivially copyable 4x4 transform for render-time data. Container<double> remains the general
+    // matrix type; this is what gets stored per object and applied per ray, so it has no heap storage and can live
+    // in a memory-mapped file as is.
+    struct Matrix4 {
+        // row-major
+        std::array<float, 16> m{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+        static Matrix4 from(const Container<double> &container) {
+            Matrix4 result;
+            for (size_t i = 0; i < 16; ++i) {
+                result.m[i] = static_cast<float>(container.m_data[i]);
+            }
+            return result;
+        }
+
+        [[nodiscard]] constexpr Point transform_point(const Point &p) const {
+            return {
+                m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3],
+                m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+                m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11]
+            };
+        }
+
+        [[nodiscard]] constexpr Vector transform_vector(const Vector &v) const {
+            return {
+                m[0] * v.x + m[1] * v.y + m[2] * v.z,
+                m[4] * v.x + m[5] * v.y + m[6] * v.z,
+                m[8] * v.x + m[9] * v.y + m[10] * v.z
+            };
+        }
+
+        // multiply by the transpose, which is how an inverse transform carries object normals back to world space
+        [[nodiscard]] constexpr Vector transpose_transform_vector(const Vector &v) const {
+            return {
+                m[0] * v.x + m[4] * v.y + m[8] * v.z,
+                m[1] * v.x + m[5] * v.y + m[9] * v.z,
+                m[2] * v.x + m[6] * v.y + m[10] * v.z
+            };
+        }
+
+        constexpr bool operator==(const Matrix4 &) const = default;
+    };
+
+    // a times b, applying b first; in float, with no heap storage, for composing transforms at render time
+    constexpr Matrix4 multiply(const Matrix4 &a, const Matrix4 &b) {
+        Matrix4 result{.m = {}};
+        for (size_t row = 0; row < 4; ++row) {
+            for (size_t column = 0; column < 4; ++column) {
+                float sum{0};
+                for (size_t k = 0; k < 4; ++k) {
+                    sum += a.m[row * 4 + k] * b.m[k * 4 + column];
+                }
+                result.m[row * 4 + column] = sum;
+            }
+        }
+        return result;
+    }
+
+    // Closed-form inverse of 16 row-major values, computed in double and rounded once. Equivalent to inverse()
+    // followed by Matrix4::from, without the recursive cofactor expansion, which matters when compiling millions of
+    // objects.
+    template<typename Values>
+    std::expected<Matrix4, bool> invert_row_major(const Values &values) {
+        // widened first, so float input is not multiplied out in float
+        std::array<double, 16> a{};
+        std::copy_n(std::begin(values), 16, a.begin());
+        // 2x2 determinants of the top two and bottom two rows
+        const double s0{a[0] * a[5] - a[4] * a[1]};
+        const double s1{a[0] * a[6] - a[4] * a[2]};
+        const double s2{a[0] * a[7] - a[4] * a[3]};
+        const double s3{a[1] * a[6] - a[5] * a[2]};
+        const double s4{a[1] * a[7] - a[5] * a[3]};
+        const double s5{a[2] * a[7] - a[6] * a[3]};
+        const double c5{a[10] * a[15] - a[14] * a[11]};
+        const double c4{a[9] * a[15] - a[13] * a[11]};
+        const double c3{a[9] * a[14] - a[13] * a[10]};
+        const double c2{a[8] * a[15] - a[12] * a[11]};
+        const double c1{a[8] * a[14] - a[12] * a[10]};
+        const double c0{a[8] * a[13] - a[12] * a[9]};
+        const double determinant{s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0};
+        if (determinant == 0) {
+            return std::unexpected(false);
+        }
+        const double r{1 / determinant};
+        const std::array<double, 16> inverse{
+            (a[5] * c5 - a[6] * c4 + a[7] * c3) * r,
+            (-a[1] * c5 + a[2] * c4 - a[3] * c3) * r,
+            (a[13] * s5 - a[14] * s4 + a[15] * s3) * r,
+            (-a[9] * s5 + a[10] * s4 - a[11] * s3) * r,
+            (-a[4] * c5 + a[6] * c2 - a[7] * c1) * r,
+            (a[0] * c5 - a[2] * c2 + a[3] * c1) * r,
+            (-a[12] * s5 + a[14] * s2 - a[15] * s1) * r,
+            (a[8] * s5 - a[10] * s2 + a[11] * s1) * r,
+            (a[4] * c4 - a[5] * c2 + a[7] * c0) * r,
+            (-a[0] * c4 + a[1] * c2 - a[3] * c0) * r,
+            (a[12] * s4 - a[13] * s2 + a[15] * s0) * r,
+            (-a[8] * s4 + a[9] * s2 - a[11] * s0) * r,
+            (-a[4] * c3 + a[5] * c1 - a[6] * c0) * r,
+            (a[0] * c3 - a[1] * c1 + a[2] * c0) * r,
+            (-a[12] * s3 + a[13] * s1 - a[14] * s0) * r,
+            (a[8] * s3 - a[9] * s1 + a[10] * s0) * r
+        };
+        Matrix4 result;
+        for (size_t i = 0; i < 16; ++i) {
+            result.m[i] = static_cast<float>(inverse[i]);
+        }
+        return result;
+    }
+
+    inline std::expected<Matrix4, bool> invert(const Container<double> &container) {
+        return invert_row_major(container.m_data);
+    }
+
+    inline std::expected<Matrix4, bool> invert(const Matrix4 &matrix) {
+        return invert_row_major(matrix.m);
+    }
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_MATRIX4_HPP
@@ -0,0 +1,237 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Mesh.hpp"
+
+namespace raytracer {
+    namespace {
+        constexpr float miss{std::numeric_limits<float>::infinity()};
+        // triangles tested together; enough for two AVX registers of floats
+        constexpr uint32_t block_size{8};
+
+        // The edge functions of one triangle, redone in double for a ray that float put exactly on an edge
+        float watertight_double(const std::array<float, 9> &sheared, const float scale_z) {
+            const auto [ax, ay, az, bx, by, bz, cx, cy, cz]{sheared};
+            const double u{static_cast<double>(cx) * by - static_cast<double>(cy) * bx};
+            const double v{static_cast<double>(ax) * cy - static_cast<double>(ay) * cx};
+            const double w{static_cast<double>(bx) * ay - static_cast<double>(by) * ax};
+            const bool inside{(u >= 0 && v >= 0 && w >= 0) || (u <= 0 && v <= 0 && w <= 0)};
+            const double determinant{u + v + w};
+            if (!inside || determinant == 0) {
+                return miss;
+            }
+            const double t{(u * az + v * bz + w * cz) * scale_z / determinant};
+            return t >= 0 ? static_cast<float>(t) : miss;
+        }
+
+        // distances along the ray to triangles [first, first + count), count at most block_size, infinity for a
+        // miss. Built with floating point contraction off, see CMakeLists.txt
+        void triangle_distances(const TriangleColumns &triangles, const uint32_t first, const uint32_t count,
+                                const TriangleRay &ray, std::array<float, block_size> &t) {
+            const auto [kx, ky, kz]{ray.axes};
+            const auto [sx, sy, sz]{ray.shear};
+            const float ox{ray.origin[kx]};
+            const float oy{ray.origin[ky]};
+            const float oz{ray.origin[kz]};
+            const float *ax{triangles.corners[kx] + first};
+            const float *ay{triangles.corners[ky] + first};
+            const float *az{triangles.corners[kz] + first};
+            const float *bx{triangles.corners[3 + kx] + first};
+            const float *by{triangles.corners[3 + ky] + first};
+            const float *bz{triangles.corners[3 + kz] + first};
+            const float *cx{triangles.corners[6 + kx] + first};
+            const float *cy{triangles.corners[6 + ky] + first};
+            const float *cz{triangles.corners[6 + kz] + first};
+            std::array<float, block_size> on_edge{};
+            for (uint32_t i = 0; i < count; ++i) {
+                // corners relative to the origin, sheared so the ray runs down z
+                const float a_z{az[i] - oz};
+                const float b_z{bz[i] - oz};
+                const float c_z{cz[i] - oz};
+                const float a_x{ax[i] - ox - sx * a_z};
+                const float a_y{ay[i] - oy - sy * a_z};
+                const float b_x{bx[i] - ox - sx * b_z};
+                const float b_y{by[i] - oy - sy * b_z};
+                const float c_x{cx[i] - ox - sx * c_z};
+                const float c_y{cy[i] - oy - sy * c_z};
+                const float u{c_x * b_y - c_y * b_x};
+                const float v{a_x * c_y - a_y * c_x};
+                const float w{b_x * a_y - b_y * a_x};
+                const bool inside{(u >= 0 && v >= 0 && w >= 0) || (u <= 0 && v <= 0 && w <= 0)};
+                const float determinant{u + v + w};
+                const float distance{(u * a_z + v * b_z + w * c_z) * sz / determinant};
+                t[i] = inside && determinant != 0 && distance >= 0 ? distance : miss;
+                on_edge[i] = u == 0 || v == 0 || w == 0 ? 1.0f : 0.0f;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                if (on_edge[i] != 0) {
+                    const float a_z{az[i] - oz};
+                    const float b_z{bz[i] - oz};
+                    const float c_z{cz[i] - oz};
+                    t[i] = watertight_double({
+                        ax[i] - ox - sx * a_z, ay[i] - oy - sy * a_z, a_z, bx[i] - ox - sx * b_z,
+                        by[i] - oy - sy * b_z, b_z, cx[i] - ox - sx * c_z, cy[i] - oy - sy * c_z, c_z
+                    }, sz);
+                }
+            }
+        }
+
+        Vector plane_normal(const Point &a, const Point &b, const Point &c) {
+            return Vector::normalize(Vector::cross(b - a, c - a));
+        }
+    }
+
+    Bounds Mesh::triangle_bounds(const uint32_t triangle) const {
+        Bounds bounds;
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            bounds.merge(this->corner(triangle, corner));
+        }
+        return bounds;
+    }
+
+    Bounds Mesh::bounds() const {
+        Bounds bounds;
+        for (const uint32_t v: triangles) {
+            bounds.merge(vertex(v));
+        }
+        return bounds;
+    }
+
+    TriangleRay::TriangleRay(const Ray &ray) : origin{ray.origin.x, ray.origin.y, ray.origin.z} {
+        const std::array<float, 3> direction{ray.direction.x, ray.direction.y, ray.direction.z};
+        uint32_t kz{0};
+        for (uint32_t axis = 1; axis < 3; ++axis) {
+            if (std::abs(direction[axis]) > std::abs(direction[kz])) {
+                kz = axis;
+            }
+        }
+        uint32_t kx{(kz + 1) % 3};
+        uint32_t ky{(kx + 1) % 3};
+        // keep the winding of the triangles as seen down the ray
+        if (direction[kz] < 0) {
+            std::swap(kx, ky);
+        }
+        axes = {kx, ky, kz};
+        shear = {direction[kx] / direction[kz], direction[ky] / direction[kz], 1 / direction[kz]};
+    }
+
+    void intersect_triangles(const TriangleColumns &triangles, const uint32_t first, const uint32_t count,
+                             const TriangleRay &ray, TriangleIntersection &nearest) {
+        std::array<float, block_size> t{};
+        for (uint32_t start = first; start < first + count; start += block_size) {
+            const uint32_t block{std::min(block_size, first + count - start)};
+            triangle_distances(triangles, start, block, ray, t);
+            for (uint32_t i = 0; i < block; ++i) {
+                if (t[i] < nearest.t) {
+                    nearest = {start + i, t[i]};
+                }
+            }
+        }
+    }
+
+    std::vector<TriangleIntersection> intersect(const Mesh &mesh, const Ray &ray) {
+        const TriangleRay prepared{ray};
+        std::vector<TriangleIntersection> intersections;
+        // triangles are gathered a block at a time into the layout the test works on
+        std::array<std::array<float, block_size>, 9> corners{};
+        TriangleColumns columns;
+        for (size_t i = 0; i < corners.size(); ++i) {
+            columns.corners[i] = corners[i].data();
+        }
+        std::array<float, block_size> t{};
+        const auto triangle_count{static_cast<uint32_t>(mesh.triangle_count())};
+        for (uint32_t start = 0; start < triangle_count; start += block_size) {
+            const uint32_t block{std::min(block_size, triangle_count - start)};
+            for (uint32_t i = 0; i < block; ++i) {
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    const Point p{mesh.corner(start + i, corner)};
+                    corners[corner * 3][i] = p.x;
+                    corners[corner * 3 + 1][i] = p.y;
+                    corners[corner * 3 + 2][i] = p.z;
+                }
+            }
+            triangle_distances(columns, 0, block, prepared, t);
+            for (uint32_t i = 0; i < block; ++i) {
+                if (t[i] != miss) {
+                    intersections.push_back({start + i, t[i]});
+                }
+            }
+        }
+        return intersections;
+    }
+
+    std::optional<TriangleIntersection> hit(const std::vector<TriangleIntersection> &intersections) {
+        const auto nearest{std::ranges::min_element(intersections, {}, &TriangleIntersection::t)};
+        if (nearest == intersections.end()) {
+            return std::nullopt;
+        }
+        return *nearest;
+    }
+
+    Vector normal_at(const Mesh &mesh, const uint32_t triangle) {
+        return plane_normal(mesh.corner(triangle, 0), mesh.corner(triangle, 1), mesh.corner(triangle, 2));
+    }
+
+    TriangleColumns MeshBvh::columns() const {
+        TriangleColumns columns;
+        for (size_t i = 0; i < corners.size(); ++i) {
+            columns.corners[i] = corners[i].data();
+        }
+        return columns;
+    }
+
+    MeshBvh build_mesh_bvh(const Mesh &mesh, const BvhOptions &options) {
+        std::vector<Bounds> bounds(mesh.triangle_count());
+        for (uint32_t i = 0; i < bounds.size(); ++i) {
+            bounds[i] = mesh.triangle_bounds(i);
+        }
+        MeshBvh built{.bvh = build_bvh(bounds, options), .corners = {}};
+        for (auto &column: built.corners) {
+            column.resize(built.bvh.indices.size());
+        }
+        for (size_t position = 0; position < built.bvh.indices.size(); ++position) {
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                const Point p{mesh.corner(built.bvh.indices[position], corner)};
+                built.corners[corner * 3][position] = p.x;
+                built.corners[corner * 3 + 1][position] = p.y;
+                built.corners[corner * 3 + 2][position] = p.z;
+            }
+        }
+        return built;
+    }
+
+    TriangleIntersection nearest_triangle(const std::span<const BvhNode> nodes, const TriangleColumns &triangles,
+                                          const Ray &ray, const float max_t) {
+        const TriangleRay prepared{ray};
+        TriangleIntersection nearest{0, max_t};
+        traverse_bvh(nodes, ray, nearest.t, [&](const uint32_t first, const uint32_t count) {
+            intersect_triangles(triangles, first, count, prepared, nearest);
+        });
+        return nearest.t < max_t ? nearest : TriangleIntersection{0, miss};
+    }
+
+    bool any_triangle(const std::span<const BvhNode> nodes, const TriangleColumns &triangles, const Ray &ray,
+                      const float max_t) {
+        const TriangleRay prepared{ray};
+        TriangleIntersection nearest{0, max_t};
+        float limit{max_t};
+        traverse_bvh(nodes, ray, limit, [&](const uint32_t first, const uint32_t count) {
+            intersect_triangles(triangles, first, count, prepared, nearest);
+            if (nearest.t < max_t) {
+                limit = -1;
+            }
+        });
+        return nearest.t < max_t;
+    }
+
+    Vector triangle_normal(const TriangleColumns &triangles, const uint32_t triangle) {
+        const auto &c{triangles.corners};
+        return plane_normal(Point{c[0][triangle], c[1][triangle], c[2][triangle]},
+                            Point{c[3][triangle], c[4][triangle], c[5][triangle]},
+                            Point{c[6][triangle], c[7][triangle], c[8][triangle]});
+    }
+}
@@ -0,0 +1,127 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_MESH_HPP
+#define THE_RAYTRACER_CHALLENGE_MESH_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "Bounds.hpp"
+#include "Bvh.hpp"
+#include "Intersect.hpp"
+#include "Point.hpp"
+#include "Vector.hpp"
+
+namespace raytracer {
+    // Indexed triangle mesh in object space. Vertex positions are kept one array per coordinate and each triangle
+    // as the numbers of its three vertices, so a vertex shared by several triangles is stored once.
+    struct Mesh {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        // the corners of triangle i are vertices triangles[3i], triangles[3i + 1] and triangles[3i + 2]
+        std::vector<uint32_t> triangles;
+
+        [[nodiscard]] size_t vertex_count() const { return x.size(); }
+
+        [[nodiscard]] size_t triangle_count() const { return triangles.size() / 3; }
+
+        uint32_t add_vertex(const Point &p) {
+            x.push_back(p.x);
+            y.push_back(p.y);
+            z.push_back(p.z);
+            return static_cast<uint32_t>(x.size() - 1);
+        }
+
+        void add_triangle(const uint32_t a, const uint32_t b, const uint32_t c) {
+            triangles.insert(triangles.end(), {a, b, c});
+        }
+
+        [[nodiscard]] Point vertex(const uint32_t v) const { return Point{x[v], y[v], z[v]}; }
+
+        // corner 0, 1 or 2 of a triangle
+        [[nodiscard]] Point corner(const uint32_t triangle, const uint32_t corner) const {
+            return vertex(triangles[size_t{triangle} * 3 + corner]);
+        }
+
+        [[nodiscard]] Bounds triangle_bounds(uint32_t triangle) const;
+
+        [[nodiscard]] Bounds bounds() const;
+    };
+
+    struct TriangleIntersection {
+        uint32_t triangle{0};
+        float t{};
+    };
+
+    // every triangle the ray crosses at or beyond its origin, in object space, by the watertight test below
+    std::vector<TriangleIntersection> intersect(const Mesh &mesh, const Ray &ray);
+
+    std::optional<TriangleIntersection> hit(const std::vector<TriangleIntersection> &intersections);
+
+    // unit normal of the triangle's plane, pointing the way its corners turn counter-clockwise
+    Vector normal_at(const Mesh &mesh, uint32_t triangle);
+
+    // Triangles with their corners stored directly instead of through vertex numbers, one array per coordinate of
+    // each corner in the order a.x, a.y, a.z, b.x, ... c.z. The triangles of a BVH leaf are then contiguous in every
+    // array, which is what lets intersect_triangles test several at once.
+    struct TriangleColumns {
+        std::array<const float *, 9> corners{};
+
+        // the same columns starting first triangles further on
+        [[nodiscard]] TriangleColumns from(const size_t first) const {
+            TriangleColumns moved{*this};
+            for (auto &column: moved.corners) {
+                column += first;
+            }
+            return moved;
+        }
+    };
+
+    // A ray set up for the watertight test of Woop, Benthin and Wald. The axis the ray runs most along becomes z,
+    // and the shear that would make the ray run straight down it is applied to the triangles instead. A triangle is
+    // then hit when the origin is inside it in 2D, decided by three edge functions that neighbouring triangles
+    // compute identically for their shared edge, so no ray slips between them.
+    struct TriangleRay {
+        // the original axes that play x, y and z
+        std::array<uint32_t, 3> axes{};
+        std::array<float, 3> shear{};
+        std::array<float, 3> origin{};
+
+        explicit TriangleRay(const Ray &ray);
+    };
+
+    // Lowers nearest to the closest of triangles [first, first + count) that the ray crosses between 0 and
+    // nearest.t. Triangles are tested in blocks with no branches, so the compiler vectorises each block; only a
+    // ray passing exactly through an edge or a corner is tested again in double.
+    void intersect_triangles(const TriangleColumns &triangles, uint32_t first, uint32_t count, const TriangleRay &ray,
+                             TriangleIntersection &nearest);
+
+    // A mesh ready for tracing: a BVH over its triangles and their corners copied out in leaf order. The leaves and
+    // the TriangleIntersection of nearest_triangle number triangles by leaf position; bvh.indices gives the mesh's
+    // own number for each.
+    struct MeshBvh {
+        Bvh bvh;
+        std::array<std::vector<float>, 9> corners;
+
+        [[nodiscard]] TriangleColumns columns() const;
+    };
+
+    MeshBvh build_mesh_bvh(const Mesh &mesh, const BvhOptions &options = {});
+
+    // nearest triangle the ray crosses before max_t, or infinity; ray and result are in object space
+    TriangleIntersection nearest_triangle(std::span<const BvhNode> nodes, const TriangleColumns &triangles,
+                                          const Ray &ray, float max_t);
+
+    // whether the ray crosses any triangle before max_t, stopping at the first it finds, in whatever order
+    bool any_triangle(std::span<const BvhNode> nodes, const TriangleColumns &triangles, const Ray &ray, float max_t);
+
+    // unit normal of the triangle at a leaf position, as normal_at gives for the mesh
+    Vector triangle_normal(const TriangleColumns &triangles, uint32_t triangle);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_MESH_HPP
@@ -0,0 +1,263 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "ObjLoader.hpp"
+#include "Scene.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RAYTRACER_HAS_MMAP 1
+#endif
+
+namespace raytracer {
+    namespace {
+        // One piece of the text and everything parsed from it. Corners are stored as vertex numbers from the start
+        // of the file when written as positive numbers; negative ones count back from a vertex whose number depends
+        // on the chunks before, so they are kept aside relative to this chunk's first vertex until that is known.
+        struct Chunk {
+            std::string_view text;
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::vector<uint32_t> triangles;
+            // position in triangles and vertex number relative to the chunk's first vertex, possibly negative
+            std::vector<std::pair<size_t, int64_t>> relative;
+            uint32_t lines{0};
+            std::optional<ObjParseError> error;
+            // the corners most likely to be out of range once the vertex counts are known, and their lines
+            uint64_t largest_corner{0};
+            uint32_t largest_corner_line{0};
+            int64_t earliest_relative{0};
+            uint32_t earliest_relative_line{0};
+        };
+
+        bool is_blank(const char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        // whitespace separated tokens of one line
+        class LineReader {
+        public:
+            explicit LineReader(const std::string_view line) : cursor(line.data()), end(line.data() + line.size()) {
+            }
+
+            std::string_view next() {
+                while (cursor != end && is_blank(*cursor)) {
+                    ++cursor;
+                }
+                const char *start{cursor};
+                while (cursor != end && !is_blank(*cursor)) {
+                    ++cursor;
+                }
+                return {start, static_cast<size_t>(cursor - start)};
+            }
+
+        private:
+            const char *cursor;
+            const char *end;
+        };
+
+        // the vertex part of a corner, "7", "7/2", "7//3" or "-1/2/3"; 0 for anything that is not a vertex number
+        int64_t corner_vertex(const std::string_view token) {
+            size_t i{0};
+            const bool negative{!token.empty() && token[0] == '-'};
+            i += negative;
+            int64_t value{0};
+            const size_t digits_start{i};
+            for (; i < token.size() && token[i] >= '0' && token[i] <= '9'; ++i) {
+                value = std::min<int64_t>(value * 10 + (token[i] - '0'), int64_t{1} << 40);
+            }
+            if (i == digits_start || (i < token.size() && token[i] != '/')) {
+                return 0;
+            }
+            return negative ? -value : value;
+        }
+
+        void parse_chunk(Chunk &chunk) {
+            std::vector<int64_t> corners;
+            const char *cursor{chunk.text.data()};
+            const char *const end{cursor + chunk.text.size()};
+            const auto fail = [&chunk](const ObjError error) {
+                chunk.error = ObjParseError{error, chunk.lines};
+            };
+            while (cursor != end && !chunk.error.has_value()) {
+                const char *line_end{std::find(cursor, end, '\n')};
+                std::string_view line{cursor, static_cast<size_t>(line_end - cursor)};
+                cursor = line_end == end ? end : line_end + 1;
+                ++chunk.lines;
+                line = line.substr(0, line.find('#'));
+                LineReader reader{line};
+                const std::string_view keyword{reader.next()};
+                if (keyword == "v") {
+                    std::array<double, 3> position{};
+                    for (auto &coordinate: position) {
+                        if (!parse_number(reader.next(), coordinate)) {
+                            fail(ObjError::invalid_number);
+                            break;
+                        }
+                    }
+                    chunk.x.push_back(static_cast<float>(position[0]));
+                    chunk.y.push_back(static_cast<float>(position[1]));
+                    chunk.z.push_back(static_cast<float>(position[2]));
+                } else if (keyword == "f") {
+                    corners.clear();
+                    for (std::string_view token{reader.next()}; !token.empty(); token = reader.next()) {
+                        const int64_t vertex{corner_vertex(token)};
+                        if (vertex == 0) {
+                            fail(ObjError::invalid_face);
+                            break;
+                        }
+                        if (vertex > 0 && static_cast<uint64_t>(vertex) > chunk.largest_corner) {
+                            chunk.largest_corner = static_cast<uint64_t>(vertex);
+                            chunk.largest_corner_line = chunk.lines;
+                        }
+                        corners.push_back(vertex);
+                    }
+                    if (corners.size() < 3) {
+                        fail(ObjError::invalid_face);
+                    }
+                    if (chunk.error.has_value()) {
+                        break;
+                    }
+                    // a fan around the first corner
+                    const auto local_count{static_cast<int64_t>(chunk.x.size())};
+                    for (size_t i = 1; i + 1 < corners.size(); ++i) {
+                        for (const int64_t vertex: {corners[0], corners[i], corners[i + 1]}) {
+                            if (vertex > 0) {
+                                chunk.triangles.push_back(static_cast<uint32_t>(vertex - 1));
+                            } else {
+                                const int64_t relative{local_count + vertex};
+                                if (relative < chunk.earliest_relative) {
+                                    chunk.earliest_relative = relative;
+                                    chunk.earliest_relative_line = chunk.lines;
+                                }
+                                chunk.relative.emplace_back(chunk.triangles.size(), relative);
+                                chunk.triangles.push_back(0);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::expected<Mesh, ObjParseError> parse_obj(const std::string_view text, const ObjOptions &options) {
+        std::vector<Chunk> chunks;
+        for (size_t start = 0; start < text.size();) {
+            const size_t wanted{std::min(text.size(), start + std::max<size_t>(options.chunk_bytes, 1))};
+            const size_t line_end{text.find('\n', wanted - 1)};
+            const size_t stop{line_end == std::string_view::npos ? text.size() : line_end + 1};
+            chunks.push_back(Chunk{
+                .text = text.substr(start, stop - start), .x = {}, .y = {}, .z = {}, .triangles = {}, .relative = {},
+                .error = {}
+            });
+            start = stop;
+        }
+        ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+        pool.parallel_for(0, chunks.size(), 1, [&chunks](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                parse_chunk(chunks[i]);
+            }
+        });
+
+        // where each chunk's vertices and triangles start, checking its corners against the vertices there are
+        std::vector<size_t> vertex_base(chunks.size());
+        std::vector<size_t> triangle_base(chunks.size());
+        size_t vertices{0};
+        size_t corners{0};
+        uint32_t lines_before{0};
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const Chunk &chunk{chunks[i]};
+            if (chunk.error.has_value()) {
+                return std::unexpected(ObjParseError{chunk.error->error, lines_before + chunk.error->line});
+            }
+            vertex_base[i] = vertices;
+            triangle_base[i] = corners;
+            vertices += chunk.x.size();
+            corners += chunk.triangles.size();
+            if (static_cast<int64_t>(vertex_base[i]) + chunk.earliest_relative < 0) {
+                return std::unexpected(ObjParseError{ObjError::invalid_face,
+                                                     lines_before + chunk.earliest_relative_line});
+            }
+            lines_before += chunk.lines;
+        }
+        lines_before = 0;
+        for (const Chunk &chunk: chunks) {
+            if (chunk.largest_corner > vertices) {
+                return std::unexpected(ObjParseError{ObjError::invalid_face,
+                                                     lines_before + chunk.largest_corner_line});
+            }
+            lines_before += chunk.lines;
+        }
+
+        Mesh mesh;
+        mesh.x.resize(vertices);
+        mesh.y.resize(vertices);
+        mesh.z.resize(vertices);
+        mesh.triangles.resize(corners);
+        pool.parallel_for(0, chunks.size(), 1, [&](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const Chunk &chunk{chunks[i]};
+                std::ranges::copy(chunk.x, mesh.x.begin() + static_cast<std::ptrdiff_t>(vertex_base[i]));
+                std::ranges::copy(chunk.y, mesh.y.begin() + static_cast<std::ptrdiff_t>(vertex_base[i]));
+                std::ranges::copy(chunk.z, mesh.z.begin() + static_cast<std::ptrdiff_t>(vertex_base[i]));
+                uint32_t *triangles{mesh.triangles.data() + triangle_base[i]};
+                std::ranges::copy(chunk.triangles, triangles);
+                for (const auto &[position, relative]: chunk.relative) {
+                    triangles[position] = static_cast<uint32_t>(static_cast<int64_t>(vertex_base[i]) + relative);
+                }
+            }
+        });
+        return mesh;
+    }
+
+#ifdef RAYTRACER_HAS_MMAP
+    std::expected<Mesh, ObjParseError> load_obj(const std::string &file_path, const ObjOptions &options) {
+        const int fd{::open(file_path.c_str(), O_RDONLY)};
+        if (fd < 0) {
+            return std::unexpected(ObjParseError{ObjError::invalid_path});
+        }
+        struct stat status{};
+        if (::fstat(fd, &status) != 0) {
+            ::close(fd);
+            return std::unexpected(ObjParseError{ObjError::invalid_path});
+        }
+        const auto size{static_cast<size_t>(status.st_size)};
+        if (size == 0) {
+            ::close(fd);
+            return Mesh{};
+        }
+        void *address{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            return std::unexpected(ObjParseError{ObjError::invalid_path});
+        }
+        auto mesh{parse_obj(std::string_view{static_cast<const char *>(address), size}, options)};
+        ::munmap(address, size);
+        return mesh;
+    }
+#else
+    std::expected<Mesh, ObjParseError> load_obj(const std::string &file_path, const ObjOptions &options) {
+        std::ifstream in_file(file_path, std::ios::binary | std::ios::ate);
+        if (!in_file) {
+            return std::unexpected(ObjParseError{ObjError::invalid_path});
+        }
+        std::string contents(static_cast<size_t>(in_file.tellg()), '\0');
+        in_file.seekg(0);
+        if (!in_file.read(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            return std::unexpected(ObjParseError{ObjError::invalid_path});
+        }
+        return parse_obj(contents, options);
+    }
+#endif
+}
@@ -0,0 +1,48 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_OBJ_LOADER_HPP
+#define THE_RAYTRACER_CHALLENGE_OBJ_LOADER_HPP
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include "Mesh.hpp"
+#include "ThreadPool.hpp"
+
+namespace raytracer {
+    enum class ObjError {
+        invalid_path,
+        invalid_number,
+        // a face with fewer than three corners or a corner that is not a vertex
+        invalid_face
+    };
+
+    struct ObjParseError {
+        ObjError error;
+        // 1-based line the problem was found on; 0 when it is not about the contents
+        uint32_t line{0};
+    };
+
+    struct ObjOptions {
+        // pool the chunks are parsed on; nullptr for ThreadPool::shared()
+        ThreadPool *pool{nullptr};
+        // text per chunk, extended to the end of the line it stops in
+        size_t chunk_bytes{size_t{1} << 20};
+    };
+
+    // Vertices and faces of a Wavefront OBJ file as one mesh. Faces with more than three corners are split into a
+    // fan of triangles, corners may be negative to count back from the latest vertex, and only the vertex part of
+    // "v/vt/vn" corners is used. Texture coordinates, normals, groups, materials and anything else are skipped.
+    //
+    // The text is cut into chunks at line ends and the chunks are parsed in parallel, each into its own arrays,
+    // which are then copied into place once every chunk's size is known.
+    std::expected<Mesh, ObjParseError> parse_obj(std::string_view text, const ObjOptions &options = {});
+
+    // the file is memory-mapped where the platform allows and read whole otherwise
+    std::expected<Mesh, ObjParseError> load_obj(const std::string &file_path, const ObjOptions &options = {});
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_OBJ_LOADER_HPP
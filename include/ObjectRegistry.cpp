@@ -0,0 +1,44 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "ObjectRegistry.hpp"
+
+namespace raytracer {
+    ObjectRegistry::ObjectRegistry(const size_t capacity)
+        : inverses(capacity), object_bounds(capacity), object_materials(capacity) {
+    }
+
+    ObjectRegistry::ObjectRegistry(ObjectRegistry &&other) noexcept
+        : inverses(std::move(other.inverses)), object_bounds(std::move(other.object_bounds)),
+          object_materials(std::move(other.object_materials)), count(other.count.exchange(0)) {
+    }
+
+    ObjectRegistry &ObjectRegistry::operator=(ObjectRegistry &&other) noexcept {
+        inverses = std::move(other.inverses);
+        object_bounds = std::move(other.object_bounds);
+        object_materials = std::move(other.object_materials);
+        count.store(other.count.exchange(0));
+        return *this;
+    }
+
+    std::expected<uint32_t, RegistryError> ObjectRegistry::add(const uint32_t ids) {
+        uint32_t first{count.load(std::memory_order_relaxed)};
+        do {
+            if (ids > capacity() - first) {
+                return std::unexpected(RegistryError::full);
+            }
+        } while (!count.compare_exchange_weak(first, first + ids, std::memory_order_acq_rel));
+        return first;
+    }
+
+    void ObjectRegistry::place(const uint32_t id, const Container<double> &transform) {
+        const auto inverted{invert(transform)};
+        place(id, Matrix4::from(transform), inverted.has_value() ? std::optional{inverted.value()} : std::nullopt);
+    }
+
+    void ObjectRegistry::place(const uint32_t id, const Matrix4 &transform, const std::optional<Matrix4> &inverse) {
+        inverses[id] = inverse.value_or(Matrix4{.m = {}});
+        object_bounds[id] = inverse.has_value() ? sphere_bounds(transform) : Bounds{};
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_OBJECT_REGISTRY_HPP
+#define THE_RAYTRACER_CHALLENGE_OBJECT_REGISTRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <vector>
+#include "Bounds.hpp"
+#include "Matrix.hpp"
+#include "Matrix4.hpp"
+
+namespace raytracer {
+    enum class RegistryError {
+        // more ids asked for than the registry was made with room for
+        full
+    };
+
+    // The objects of one scene numbered 0, 1, 2, ... with what rendering needs of each kept in parallel arrays
+    // indexed by that number: finding an object's inverse transform, bounds or material is an array lookup rather
+    // than a walk through Sphere objects, and two hits are on the same object when their numbers are equal. A
+    // material is kept as its number in the scene's MaterialTable, so equal materials are stored once.
+    //
+    // The arrays are sized once, up front, so ids can be handed out from several threads at once without anything
+    // moving under the others; an id stays the same for as long as the registry exists.
+    class ObjectRegistry {
+    public:
+        explicit ObjectRegistry(size_t capacity);
+
+        ObjectRegistry(ObjectRegistry &&other) noexcept;
+
+        ObjectRegistry &operator=(ObjectRegistry &&other) noexcept;
+
+        // ids consecutive ids, returning the first; safe to call concurrently, and none are handed out when fewer
+        // than that are left
+        std::expected<uint32_t, RegistryError> add(uint32_t ids = 1);
+
+        // inverse transform of object id and the world bounds of the unit sphere it places; a singular transform
+        // gets an all-zero inverse, which no ray can hit, and no extent
+        void place(uint32_t id, const Container<double> &transform);
+
+        // the same from a transform already composed in float and its inverse, nullopt when it has none
+        void place(uint32_t id, const Matrix4 &transform, const std::optional<Matrix4> &inverse);
+
+        // material is its number in the scene's MaterialTable
+        void set_material(const uint32_t id, const uint32_t material) { object_materials[id] = material; }
+
+        // ids handed out so far
+        [[nodiscard]] size_t size() const { return count.load(std::memory_order_acquire); }
+
+        [[nodiscard]] size_t capacity() const { return object_materials.size(); }
+
+        [[nodiscard]] std::span<const Matrix4> inverse_transforms() const { return {inverses.data(), size()}; }
+
+        [[nodiscard]] std::span<const Bounds> bounds() const { return {object_bounds.data(), size()}; }
+
+        // each object's material number
+        [[nodiscard]] std::span<const uint32_t> materials() const { return {object_materials.data(), size()}; }
+
+    private:
+        std::vector<Matrix4> inverses;
+        std::vector<Bounds> object_bounds;
+        std::vector<uint32_t> object_materials;
+        std::atomic<uint32_t> count{0};
+    };
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_OBJECT_REGISTRY_HPP
@@ -0,0 +1,548 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+#include "Arena.hpp"
+#include "Render.hpp"
+
+namespace raytracer {
+    namespace {
+        // The rays through the centres of a tile's pixels, row by row, each one step on from the last
+        void centre_rays(const Camera &camera, const Range2D &tile, const std::span<Ray> rays) {
+            const uint32_t width{tile.x_end - tile.x_begin};
+            for (uint32_t y = tile.y_begin; y < tile.y_end; ++y) {
+                camera.rays_for_row(y, tile.x_begin, rays.subspan((y - tile.y_begin) * width, width));
+            }
+        }
+
+        // Samples of a pixel past the first, which is its centre, go to cells of jitter()'s 4x4 grid in this order:
+        // each run of four has one cell in each quarter of the pixel, so a pixel is covered evenly whenever it stops.
+        constexpr std::array<uint32_t, 16> sample_cells{5, 10, 6, 9, 0, 15, 3, 12, 1, 14, 7, 8, 4, 11, 2, 13};
+
+        // extra samples are taken this many at a time, the pixels that still need them all shaded together
+        constexpr uint32_t samples_per_round{4};
+
+        // the brightness of a sample, for its variance
+        float brightness(const Colour &colour) {
+            return (colour.r + colour.g + colour.b) / 3;
+        }
+
+        // Adds samples to the pixels of tile that differ from a neighbour by more than options.contrast in some
+        // channel, given the centre samples of the whole image. They are taken a round at a time, and a pixel stops
+        // once the standard error of its mean brightness is within a quarter of contrast or it has max_samples.
+        template<typename ShadeRays>
+        void refine_tile(const Camera &camera, const RenderOptions &options, const std::span<const Colour> centres,
+                         const Range2D &tile, Canvas &canvas, ShadeRays &shade_rays) {
+            const uint32_t width{tile.x_end - tile.x_begin};
+            const uint32_t height{tile.y_end - tile.y_begin};
+            const auto centre{[&](const uint32_t x, const uint32_t y) {
+                return centres[size_t{y} * camera.hsize + x];
+            }};
+            std::pmr::vector<Colour> sums(width * height, &thread_arena());
+            std::pmr::vector<float> squares(sums.size(), &thread_arena());
+            std::pmr::vector<uint32_t> counts(sums.size(), 1, &thread_arena());
+            std::pmr::vector<uint32_t> active(&thread_arena());
+            for (uint32_t y = tile.y_begin; y < tile.y_end; ++y) {
+                for (uint32_t x = tile.x_begin; x < tile.x_end; ++x) {
+                    const Colour colour{centre(x, y)};
+                    const uint32_t pixel{(y - tile.y_begin) * width + x - tile.x_begin};
+                    sums[pixel] = colour;
+                    squares[pixel] = brightness(colour) * brightness(colour);
+                    float difference{0};
+                    for (const auto [nx, ny]: std::array<std::array<uint32_t, 2>, 4>{
+                             {{x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}}
+                         }) {
+                        // x - 1 and y - 1 wrap around at 0, past the edge like x + 1 and y + 1 at the other end
+                        if (nx < camera.hsize && ny < camera.vsize) {
+                            const Colour neighbour{centre(nx, ny)};
+                            difference = std::max({
+                                difference, std::abs(colour.r - neighbour.r), std::abs(colour.g - neighbour.g),
+                                std::abs(colour.b - neighbour.b)
+                            });
+                        }
+                    }
+                    if (difference > options.contrast) {
+                        active.push_back(pixel);
+                    }
+                }
+            }
+            std::pmr::vector<Ray> rays(&thread_arena());
+            std::pmr::vector<Colour> colours(&thread_arena());
+            uint32_t taken{1};
+            while (!active.empty() && taken < options.max_samples) {
+                const uint32_t round{std::min(samples_per_round, options.max_samples - taken)};
+                rays.clear();
+                for (const uint32_t pixel: active) {
+                    const uint32_t x{tile.x_begin + pixel % width};
+                    const uint32_t y{tile.y_begin + pixel / width};
+                    for (uint32_t extra = taken - 1; extra < taken - 1 + round; ++extra) {
+                        const uint32_t sample{sample_cells[extra % 16] + extra / 16 * 16};
+                        rays.push_back(camera.ray_for_pixel(x, y, jitter(x, y, sample)));
+                    }
+                }
+                colours.resize(rays.size());
+                shade_rays(std::span<const Ray>{rays}, std::span<Colour>{colours});
+                taken += round;
+                const float limit{options.contrast / 4};
+                size_t kept{0};
+                for (size_t i = 0; i < active.size(); ++i) {
+                    const uint32_t pixel{active[i]};
+                    for (uint32_t j = 0; j < round; ++j) {
+                        const Colour &colour{colours[i * round + j]};
+                        sums[pixel] = sums[pixel] + colour;
+                        squares[pixel] += brightness(colour) * brightness(colour);
+                    }
+                    counts[pixel] = taken;
+                    const auto n{static_cast<float>(taken)};
+                    const float mean{brightness(sums[pixel]) / n};
+                    const float variance{std::max(squares[pixel] / n - mean * mean, 0.0f) * n / (n - 1)};
+                    if (variance / n > limit * limit) {
+                        active[kept++] = pixel;
+                    }
+                }
+                active.resize(kept);
+            }
+            for (uint32_t pixel = 0; pixel < sums.size(); ++pixel) {
+                canvas.write_pixel(tile.x_begin + pixel % width, tile.y_begin + pixel / width,
+                                   sums[pixel] * (1 / static_cast<float>(counts[pixel])));
+            }
+        }
+
+        // Renders the image a tile per task, with shade_rays(rays, colours) filling colours with what is seen along
+        // rays; it is given a whole tile of rays at a time, so whatever it keeps from ray to ray, such as the last
+        // occluder of each light, spans the tile. With more than one sample a pixel, every pixel's centre is shaded
+        // first, into a buffer the size of the image, so that refine_tile() can compare pixels across tiles.
+        template<typename ShadeRays>
+        Canvas render_tiles(const Camera &camera, const RenderOptions &options, ShadeRays &&shade_rays) {
+            Canvas canvas{camera.hsize, camera.vsize};
+            ThreadPool &pool{options.pool != nullptr ? *options.pool : ThreadPool::shared()};
+            const Range2D image{0, camera.hsize, 0, camera.vsize};
+            const bool adaptive{options.max_samples > 1};
+            std::vector<Colour> centres(adaptive ? size_t{camera.hsize} * camera.vsize : 0);
+            pool.parallel_for(image, options.tile_size, options.tile_size, [&](const Range2D &tile) {
+                const ArenaScope scratch{thread_arena()};
+                const uint32_t width{tile.x_end - tile.x_begin};
+                std::pmr::vector<Ray> rays(width * (tile.y_end - tile.y_begin), &thread_arena());
+                std::pmr::vector<Colour> colours(rays.size(), &thread_arena());
+                centre_rays(camera, tile, rays);
+                shade_rays(std::span<const Ray>{rays}, std::span<Colour>{colours});
+                for (uint32_t y = tile.y_begin; y < tile.y_end; ++y) {
+                    for (uint32_t x = tile.x_begin; x < tile.x_end; ++x) {
+                        const Colour &colour{colours[(y - tile.y_begin) * width + x - tile.x_begin]};
+                        if (adaptive) {
+                            centres[size_t{y} * camera.hsize + x] = colour;
+                        } else {
+                            canvas.write_pixel(x, y, colour);
+                        }
+                    }
+                }
+            });
+            if (adaptive) {
+                pool.parallel_for(image, options.tile_size, options.tile_size, [&](const Range2D &tile) {
+                    const ArenaScope scratch{thread_arena()};
+                    refine_tile(camera, options, centres, tile, canvas, shade_rays);
+                });
+            }
+            if (options.stats != nullptr) {
+                options.stats->pixels += size_t{camera.hsize} * camera.vsize;
+            }
+            return canvas;
+        }
+
+        // nearest non-negative t at which the ray meets the unit sphere behind inverse_transform, or infinity
+        float intersect_sphere(const Matrix4 &inverse_transform, const Ray &ray) {
+            const Point origin{inverse_transform.transform_point(ray.origin)};
+            const Vector direction{inverse_transform.transform_vector(ray.direction)};
+            const Vector sphere_to_ray{origin - Point(0, 0, 0)};
+            const float a{Vector::dot(direction, direction)};
+            const float b{2 * Vector::dot(direction, sphere_to_ray)};
+            const float c{Vector::dot(sphere_to_ray, sphere_to_ray) - 1};
+            const float discriminant{b * b - (4 * a * c)};
+            if (discriminant < 0) {
+                return std::numeric_limits<float>::infinity();
+            }
+            const float t1{(-b - std::sqrt(discriminant)) / (2 * a)};
+            const float t2{(-b + std::sqrt(discriminant)) / (2 * a)};
+            if (t1 >= 0) {
+                return t1;
+            }
+            return t2 >= 0 ? t2 : std::numeric_limits<float>::infinity();
+        }
+
+        struct NearestHit {
+            size_t object;
+            float t;
+            // which triangle of a mesh
+            uint32_t primitive{0};
+        };
+
+        // t at which the ray meets an object no further than max_t, infinity otherwise, and the triangle it meets
+        // when the object is a mesh
+        TriangleIntersection intersect_object(const CompiledScene &scene, const size_t object, const Ray &ray,
+                                              const float max_t) {
+            const Matrix4 &inverse_transform{scene.inverse_transforms()[object]};
+            const CompiledGeometry &geometry{scene.geometries()[scene.object_geometries()[object]]};
+            if (geometry.shape == Shape::sphere) {
+                return {0, intersect_sphere(inverse_transform, ray)};
+            }
+            const Ray object_ray{
+                inverse_transform.transform_point(ray.origin), inverse_transform.transform_vector(ray.direction)
+            };
+            return nearest_triangle(scene.mesh_nodes(geometry), scene.triangles(geometry), object_ray, max_t);
+        }
+
+        TriangleIntersection intersect_object(const DynamicScene &scene, const size_t object, const Ray &ray,
+                                              float) {
+            return {0, intersect_sphere(scene.inverse_transforms()[object], ray)};
+        }
+
+        // Normal in object space at point, given in object space too: out of a sphere, and for a triangle the way
+        // its corners turn counter-clockwise, which is out of a closed mesh wound that way.
+        Vector object_normal(const CompiledScene &scene, const size_t object, const uint32_t primitive,
+                             const Point &point) {
+            const CompiledGeometry &geometry{scene.geometries()[scene.object_geometries()[object]]};
+            if (geometry.shape == Shape::sphere) {
+                return point - Point(0, 0, 0);
+            }
+            return triangle_normal(scene.triangles(geometry), primitive);
+        }
+
+        Vector object_normal(const DynamicScene &, size_t, uint32_t, const Point &point) {
+            return point - Point(0, 0, 0);
+        }
+
+        // whether object is in the way of ray before ray.origin + ray.direction, that is for t in [0, 1)
+        bool occludes(const CompiledScene &scene, const size_t object, const Ray &ray) {
+            const Matrix4 &inverse_transform{scene.inverse_transforms()[object]};
+            const CompiledGeometry &geometry{scene.geometries()[scene.object_geometries()[object]]};
+            if (geometry.shape == Shape::sphere) {
+                return intersect_sphere(inverse_transform, ray) < 1;
+            }
+            const Ray object_ray{
+                inverse_transform.transform_point(ray.origin), inverse_transform.transform_vector(ray.direction)
+            };
+            return any_triangle(scene.mesh_nodes(geometry), scene.triangles(geometry), object_ray, 1);
+        }
+
+        bool occludes(const DynamicScene &scene, const size_t object, const Ray &ray) {
+            return intersect_sphere(scene.inverse_transforms()[object], ray) < 1;
+        }
+
+        // the number of object's material among the scene's distinct ones
+        uint32_t material_of(const CompiledScene &scene, const size_t object) {
+            return scene.materials().object_material[object];
+        }
+
+        uint32_t material_of(const DynamicScene &scene, const size_t object) {
+            return scene.object_materials()[object];
+        }
+
+        // Nearest object along the ray through the BVH. Equal distances go to the lower object number, as a loop over
+        // every object would.
+        template<typename AcceleratedScene>
+        NearestHit nearest_object(const AcceleratedScene &scene, const Ray &ray) {
+            const auto indices{scene.bvh_indices()};
+            NearestHit nearest{scene.inverse_transforms().size(), std::numeric_limits<float>::infinity()};
+            traverse_bvh(scene.bvh_nodes(), ray, nearest.t, [&](const uint32_t first, const uint32_t count) {
+                for (uint32_t i = first; i < first + count; ++i) {
+                    const uint32_t object{indices[i]};
+                    const auto [primitive, t]{intersect_object(scene, object, ray, nearest.t)};
+                    if (t < nearest.t || (t == nearest.t && object < nearest.object && std::isfinite(t))) {
+                        nearest = {object, t, primitive};
+                    }
+                }
+            });
+            return nearest;
+        }
+
+        // Some object in the way of ray before ray.origin + ray.direction, or the number of objects when there is
+        // none. This is an any-hit query: the walk through the BVH ends at the first occluder found, which need not
+        // be the nearest.
+        template<typename AcceleratedScene>
+        size_t find_occluder(const AcceleratedScene &scene, const Ray &ray) {
+            const auto indices{scene.bvh_indices()};
+            size_t occluder{scene.inverse_transforms().size()};
+            float limit{1};
+            traverse_bvh(scene.bvh_nodes(), ray, limit, [&](const uint32_t first, const uint32_t count) {
+                for (uint32_t i = first; i < first + count && limit >= 0; ++i) {
+                    if (occludes(scene, indices[i], ray)) {
+                        occluder = indices[i];
+                        limit = -1;
+                    }
+                }
+            });
+            return occluder;
+        }
+
+        // How far a shadow ray starts off the surface, along the normal, so that rounding does not put the surface
+        // itself in the way; in world units, for scenes some units across shaded in float.
+        constexpr float shadow_bias{1e-3f};
+
+        // A ray still to be traced for shade_rays(): the ray it was given that this one adds to, how much of what it
+        // sees gets there, and how many bounces on from that ray it is.
+        struct PathRay {
+            Ray ray;
+            uint32_t pixel;
+            uint32_t depth;
+            float weight;
+        };
+
+        // A number in [0, 1) for Russian roulette, fixed by the ray: the same ray always makes the same choice, so a
+        // render is the same every time and a pixel is still its colour_at().
+        float roulette_draw(const Ray &ray) {
+            // one round of a 64-bit mix over the bits of the ray
+            uint64_t h{0};
+            for (const float value: {
+                     ray.origin.x, ray.origin.y, ray.origin.z, ray.direction.x, ray.direction.y, ray.direction.z
+                 }) {
+                h = (h ^ std::bit_cast<uint32_t>(value)) * 0x9e3779b97f4a7c15u;
+            }
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9u;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebu;
+            h ^= h >> 31;
+            return static_cast<float>(h & 0xffffff) / 0x1000000;
+        }
+
+        // Fraction of the light reflected rather than refracted where a ray passes from index n1 into index n2 at
+        // a cosine of cos_i to the normal, by Schlick's approximation; 1 for total internal reflection.
+        float schlick(const float cos_i, const float n1, const float n2) {
+            float cos{cos_i};
+            if (n1 > n2) {
+                const float sin2_t{(n1 / n2) * (n1 / n2) * (1 - cos_i * cos_i)};
+                if (sin2_t > 1) {
+                    return 1;
+                }
+                cos = std::sqrt(1 - sin2_t);
+            }
+            const float r0{((n1 - n2) / (n1 + n2)) * ((n1 - n2) / (n1 + n2))};
+            const float x{1 - cos};
+            return r0 + (1 - r0) * x * x * x * x * x;
+        }
+
+        // What is seen along each ray: the nearest object lit by every light, or black when nothing is hit. The
+        // points hit are gathered into batches, each lane referring to its material by number in table, and each
+        // batch is shaded against all of the lights at once by the batched lighting(), which skips those below cutoff.
+        //
+        // With shadows, each lane that faces a light casts a ray towards it. The object that last blocked a light is
+        // tested first, before the BVH, since neighbouring points are usually in the shadow of the same object; the
+        // cache is kept for the rays of one call, which render_tiles() makes a tile, so it is per thread.
+        //
+        // Reflective and transparent materials send secondary rays, which are traced a generation at a time: every
+        // ray of one bounce is traced and shaded in batches like the first, and what they spawn makes up the next.
+        // A secondary ray carries its weight, the product of the reflectivities and transparencies along its path,
+        // and is not traced past options.max_depth bounces or once its weight is below options.min_weight, when it
+        // could not move a pixel by half an 8-bit step under light of intensity 1; with Russian roulette such a ray
+        // is instead traced with probability weight / min_weight, at weight min_weight, which keeps the image
+        // unbiased. An object is entered or left according to which side of it a ray meets, and a ray leaving one
+        // goes into air, so transparent objects are not nested.
+        template<typename AcceleratedScene>
+        void shade_rays(const AcceleratedScene &scene, const ShadingTable &table, const RenderOptions &options,
+                        const std::span<const Ray> rays, const std::span<Colour> colours, RenderStats &stats) {
+            const auto inverse_transforms{scene.inverse_transforms()};
+            const size_t none{inverse_transforms.size()};
+            ShadingBatch batch;
+            // the path ray of each lane, and whether it met its object from the inside
+            std::array<uint32_t, ShadingBatch::width> lane_paths{};
+            std::array<bool, ShadingBatch::width> lane_inside{};
+            // the object that last blocked each light of table, or none
+            std::pmr::vector<size_t> last_occluders(options.shadows ? table.lights.size() : 0, none,
+                                                    &thread_arena());
+            // the rays of this bounce and those they spawn, and the deepest bounce of each ray given
+            std::pmr::vector<PathRay> paths(&thread_arena());
+            std::pmr::vector<PathRay> spawned(&thread_arena());
+            std::pmr::vector<uint32_t> depths(rays.size(), 0, &thread_arena());
+            const ShadowTest shadowed{[&](const size_t light, const Point &position, const uint32_t lanes) {
+                uint32_t blocked{0};
+                for (uint32_t lane = 0; lane < batch.count; ++lane) {
+                    if ((lanes >> lane & 1) == 0) {
+                        continue;
+                    }
+                    const Point origin{
+                        batch.point_x[lane] + batch.normal_x[lane] * shadow_bias,
+                        batch.point_y[lane] + batch.normal_y[lane] * shadow_bias,
+                        batch.point_z[lane] + batch.normal_z[lane] * shadow_bias
+                    };
+                    const Ray shadow_ray{origin, position - origin};
+                    size_t &last{last_occluders[light]};
+                    if (last != none && occludes(scene, last, shadow_ray)) {
+                        blocked |= 1u << lane;
+                    } else if (const size_t occluder{find_occluder(scene, shadow_ray)}; occluder != none) {
+                        last = occluder;
+                        blocked |= 1u << lane;
+                    }
+                }
+                return blocked;
+            }};
+            // queues a secondary ray of path unless it is too deep or too faint, as above
+            const auto spawn{[&](const PathRay &path, const Ray &ray, float weight) {
+                if (path.depth >= options.max_depth || weight <= 0) {
+                    return;
+                }
+                if (weight < options.min_weight) {
+                    if (!options.russian_roulette || roulette_draw(ray) * options.min_weight >= weight) {
+                        return;
+                    }
+                    weight = options.min_weight;
+                }
+                spawned.push_back({ray, path.pixel, path.depth + 1, weight});
+                depths[path.pixel] = std::max(depths[path.pixel], path.depth + 1);
+                ++stats.secondary_rays;
+            }};
+            const auto shade_batch{[&] {
+                ColourBatch lit;
+                if (options.shadows) {
+                    lighting(table, batch, lit, options.light_cutoff, shadowed);
+                } else {
+                    lighting(table, batch, lit, options.light_cutoff);
+                }
+                for (uint32_t lane = 0; lane < batch.count; ++lane) {
+                    const PathRay &path{paths[lane_paths[lane]]};
+                    colours[path.pixel] = colours[path.pixel] + Colour{lit.r[lane], lit.g[lane], lit.b[lane]} *
+                                          path.weight;
+                    const uint32_t material{batch.material[lane]};
+                    const float reflective{table.reflective[material]};
+                    const float transparency{table.transparency[material]};
+                    if (reflective <= 0 && transparency <= 0) {
+                        continue;
+                    }
+                    const Point point{batch.point_x[lane], batch.point_y[lane], batch.point_z[lane]};
+                    const Vector normal{batch.normal_x[lane], batch.normal_y[lane], batch.normal_z[lane]};
+                    const Vector eye{batch.eye_x[lane], batch.eye_y[lane], batch.eye_z[lane]};
+                    const float n1{lane_inside[lane] ? table.refractive_index[material] : 1.0f};
+                    const float n2{lane_inside[lane] ? 1.0f : table.refractive_index[material]};
+                    const float cos_i{Vector::dot(eye, normal)};
+                    // with both, the split between them follows the angle, as for glass
+                    const float reflectance{reflective > 0 && transparency > 0 ? schlick(cos_i, n1, n2) : 1.0f};
+                    float reflected{reflective * reflectance};
+                    const float ratio{n1 / n2};
+                    const float sin2_t{ratio * ratio * (1 - cos_i * cos_i)};
+                    if (sin2_t > 1) {
+                        // total internal reflection: what would have passed through is reflected too
+                        reflected += transparency;
+                    } else if (transparency > 0) {
+                        const Vector direction{normal * (ratio * cos_i - std::sqrt(1 - sin2_t)) - eye * ratio};
+                        spawn(path, Ray{point - normal * shadow_bias, direction},
+                              path.weight * transparency * (reflective > 0 ? 1 - reflectance : 1.0f));
+                    }
+                    if (reflected > 0) {
+                        spawn(path, Ray{point + normal * shadow_bias, Vector::reflect(-eye, normal)},
+                              path.weight * reflected);
+                    }
+                }
+                batch.count = 0;
+            }};
+            stats.camera_rays += rays.size();
+            for (uint32_t i = 0; i < rays.size(); ++i) {
+                colours[i] = Colour{0, 0, 0};
+                paths.push_back({rays[i], i, 0, 1});
+            }
+            while (!paths.empty()) {
+                for (uint32_t i = 0; i < paths.size(); ++i) {
+                    const Ray &ray{paths[i].ray};
+                    const auto [nearest, nearest_t, primitive]{nearest_object(scene, ray)};
+                    if (nearest == none) {
+                        continue;
+                    }
+                    const Matrix4 &inverse_transform{inverse_transforms[nearest]};
+                    const Point point{position(ray, nearest_t)};
+                    const Vector surface{
+                        object_normal(scene, nearest, primitive, inverse_transform.transform_point(point))
+                    };
+                    const Vector outward{Vector::normalize(inverse_transform.transpose_transform_vector(surface))};
+                    // the side facing back along the ray is the one shaded
+                    const bool inside{Vector::dot(outward, ray.direction) > 0};
+                    lane_paths[batch.count] = i;
+                    lane_inside[batch.count] = inside;
+                    batch.add(point, inside ? -outward : outward, -ray.direction, material_of(scene, nearest));
+                    if (batch.count == ShadingBatch::width) {
+                        shade_batch();
+                    }
+                }
+                if (batch.count > 0) {
+                    shade_batch();
+                }
+                std::swap(paths, spawned);
+                spawned.clear();
+            }
+            for (const uint32_t depth: depths) {
+                stats.depth_total += depth;
+            }
+        }
+
+        // adds a tile's counts to the render's, which other tiles are adding to at the same time
+        void add_stats(const RenderStats &from, RenderStats &to) {
+            std::atomic_ref{to.camera_rays}.fetch_add(from.camera_rays, std::memory_order_relaxed);
+            std::atomic_ref{to.secondary_rays}.fetch_add(from.secondary_rays, std::memory_order_relaxed);
+            std::atomic_ref{to.depth_total}.fetch_add(from.depth_total, std::memory_order_relaxed);
+        }
+
+        template<typename AcceleratedScene>
+        Colour shade_ray(const AcceleratedScene &scene, const Ray &ray, const RenderOptions &options) {
+            const ArenaScope scratch{thread_arena()};
+            Colour colour{0, 0, 0};
+            RenderStats stats;
+            shade_rays(scene, scene.shading_table(), options, {&ray, 1}, {&colour, 1}, stats);
+            if (options.stats != nullptr) {
+                add_stats(stats, *options.stats);
+            }
+            return colour;
+        }
+
+        template<typename AcceleratedScene>
+        Canvas render_scene(const AcceleratedScene &scene, const RenderOptions &options) {
+            return render_tiles(scene.camera(), options, [&](const auto rays, const auto colours) {
+                RenderStats stats;
+                shade_rays(scene, scene.shading_table(), options, rays, colours, stats);
+                if (options.stats != nullptr) {
+                    add_stats(stats, *options.stats);
+                }
+            });
+        }
+    }
+
+    Colour colour_at(const Scene &scene, const Ray &ray) {
+        std::optional<Intersection> nearest;
+        for (const auto &sphere: scene.spheres) {
+            if (const auto xs_hit{hit(intersect(sphere, ray))};
+                xs_hit.has_value() && (!nearest.has_value() || xs_hit->t < nearest->t)) {
+                nearest = xs_hit;
+            }
+        }
+        if (!nearest.has_value()) {
+            return Colour{0, 0, 0};
+        }
+        const Point point{position(ray, nearest->t)};
+        const Vector normal{normal_at(nearest->object, point)};
+        return lighting(nearest->object.material, LightSet::from(scene.lights), point, -ray.direction, normal);
+    }
+
+    Canvas render(const Scene &scene, const RenderOptions &options) {
+        return render(CompiledScene::compile(scene), options);
+    }
+
+    Colour colour_at(const CompiledScene &scene, const Ray &ray, const RenderOptions &options) {
+        return shade_ray(scene, ray, options);
+    }
+
+    Canvas render(const CompiledScene &scene, const RenderOptions &options) {
+        return render_scene(scene, options);
+    }
+
+    Colour colour_at(const DynamicScene &scene, const Ray &ray, const RenderOptions &options) {
+        return shade_ray(scene, ray, options);
+    }
+
+    Canvas render(const DynamicScene &scene, const RenderOptions &options) {
+        return render_scene(scene, options);
+    }
+}
@@ -0,0 +1,83 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_RENDER_HPP
+#define THE_RAYTRACER_CHALLENGE_RENDER_HPP
+
+#include "Canvas.hpp"
+#include "CompiledScene.hpp"
+#include "DynamicScene.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+namespace raytracer {
+    // What a render traced, added to as it goes when RenderOptions::stats points here; colour_at() adds its one ray.
+    struct RenderStats {
+        // pixels rendered, and rays from the camera through them, one per sample
+        uint64_t pixels{0};
+        uint64_t camera_rays{0};
+        // reflected and refracted rays, at every depth
+        uint64_t secondary_rays{0};
+        // the deepest bounce each camera ray led to, summed
+        uint64_t depth_total{0};
+
+        // bounces per camera ray, to weigh the cost of max_depth and min_weight against what they add
+        [[nodiscard]] double average_depth() const {
+            return camera_rays == 0 ? 0 : static_cast<double>(depth_total) / static_cast<double>(camera_rays);
+        }
+
+        // samples per pixel, to weigh the cost of max_samples and contrast against what they add
+        [[nodiscard]] double average_samples() const {
+            return pixels == 0 ? 0 : static_cast<double>(camera_rays) / static_cast<double>(pixels);
+        }
+    };
+
+    // Each tile is rendered inside an ArenaScope on the rendering thread's thread_arena(), so per-ray scratch taken
+    // from it is released tile by tile and, once the arenas have grown, rendering makes no heap allocations per ray.
+    struct RenderOptions {
+        // pool the image is rendered on, a tile per task; nullptr for ThreadPool::shared()
+        ThreadPool *pool{nullptr};
+        uint32_t tile_size{16};
+        // a light is left out of a point's shading when it cannot add this much to any channel there, see lighting();
+        // 0 leaves out only lights that add nothing, so the image is exactly colour_at() pixel by pixel
+        float light_cutoff{0};
+        // whether points are left unlit by a light with something in between, for the ambient term alone
+        bool shadows{false};
+        // bounces of reflected and refracted rays at most; 0 shades only what the camera sees
+        uint32_t max_depth{5};
+        // weight below which a secondary ray is not traced: how much of what it sees would reach the pixel
+        float min_weight{1.0f / 512};
+        // rather than dropping a ray below min_weight, trace it with probability weight / min_weight at min_weight
+        bool russian_roulette{false};
+        // Samples a pixel at most. Each pixel is shaded at its centre first, and only those that differ from a
+        // neighbour by more than contrast in some channel get more, jittered over the pixel, until the standard error
+        // of their mean brightness is within contrast / 4. 1 takes the centre alone.
+        uint32_t max_samples{1};
+        float contrast{0.05f};
+        // counts of what was traced are added here when set
+        RenderStats *stats{nullptr};
+    };
+
+    // colour seen along ray: the nearest sphere lit by every light, or black when nothing is hit
+    Colour colour_at(const Scene &scene, const Ray &ray);
+
+    // renders the compiled form: colour_at above inverts every transform on every ray, which is fine for a single
+    // ray but not for an image
+    Canvas render(const Scene &scene, const RenderOptions &options = {});
+
+    // the same, from the flattened form: inverse transforms are already there, so nothing is inverted per ray. Points
+    // are shaded by the batched lighting(), so colours are within its tolerance of the Scene overload rather than
+    // equal to them; rendering shades a tile of rays at a time the same way, so a pixel is exactly its colour_at()
+    // with the same options when it has one sample. colour_at() of a Scene casts no shadows and no secondary rays.
+    Colour colour_at(const CompiledScene &scene, const Ray &ray, const RenderOptions &options = {});
+
+    Canvas render(const CompiledScene &scene, const RenderOptions &options = {});
+
+    // a frame of a moving scene, as it was at its last update()
+    Colour colour_at(const DynamicScene &scene, const Ray &ray, const RenderOptions &options = {});
+
+    Canvas render(const DynamicScene &scene, const RenderOptions &options = {});
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_RENDER_HPP
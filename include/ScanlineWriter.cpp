@@ -0,0 +1,58 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "ScanlineWriter.hpp"
+
+namespace raytracer {
+    std::expected<ScanlineWriter, CanvasError> ScanlineWriter::open(const std::string &file_path, const uint32_t width,
+                                                                    const uint32_t height, const PpmFormat format) {
+        std::ofstream out_file(file_path, std::ios::trunc | std::ios::binary);
+        if (!out_file) {
+            return std::unexpected(CanvasError::invalid_path);
+        }
+        out_file << ppm_header(format, width, height);
+        ScanlineWriter writer{std::move(out_file), width, height, format};
+        // rows of no pixels are all there as soon as the header is
+        if (width == 0) {
+            writer.next_row = height;
+        }
+        return writer;
+    }
+
+    std::expected<bool, CanvasError> ScanlineWriter::write_band(const std::span<const uint8_t> rgb) {
+        const size_t row_bytes{size_t{width} * Canvas::channels};
+        if (row_bytes == 0) {
+            return rgb.empty() ? std::expected<bool, CanvasError>{true}
+                               : std::unexpected(CanvasError::dimension_mismatch);
+        }
+        if (rgb.size() % row_bytes != 0 || next_row + rgb.size() / row_bytes > height) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        write_ppm_rows(out_file, format, width, rgb);
+        if (!out_file) {
+            return std::unexpected(CanvasError::write_failed);
+        }
+        next_row += static_cast<uint32_t>(rgb.size() / row_bytes);
+        return true;
+    }
+
+    std::expected<bool, CanvasError> ScanlineWriter::write_band(const Canvas &band) {
+        if (band.width != width) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        Canvas scratch{0, 0};
+        return write_band(std::span<const uint8_t>{linear_view(band, scratch).storage});
+    }
+
+    std::expected<bool, CanvasError> ScanlineWriter::finish() {
+        out_file.flush();
+        if (!out_file) {
+            return std::unexpected(CanvasError::write_failed);
+        }
+        if (next_row != height) {
+            return std::unexpected(CanvasError::incomplete);
+        }
+        return true;
+    }
+}
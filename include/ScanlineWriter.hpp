@@ -0,0 +1,76 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_SCANLINE_WRITER_HPP
+#define THE_RAYTRACER_CHALLENGE_SCANLINE_WRITER_HPP
+
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <span>
+#include <string>
+#include "Canvas.hpp"
+#include "Colour.hpp"
+
+namespace raytracer {
+    // Writes a PPM file a band of scanlines at a time: the header goes out when the file is opened and every band is
+    // appended as soon as it is handed over, so the caller only ever holds the rows it is currently rendering.
+    class ScanlineWriter {
+    public:
+        static std::expected<ScanlineWriter, CanvasError> open(const std::string &file_path, uint32_t width,
+                                                               uint32_t height,
+                                                               PpmFormat format = PpmFormat::ascii);
+
+        // append whole rows of packed RGB bytes directly below the rows already written
+        std::expected<bool, CanvasError> write_band(std::span<const uint8_t> rgb);
+
+        std::expected<bool, CanvasError> write_band(const Canvas &band);
+
+        // flush and check that every row of the image has been written
+        std::expected<bool, CanvasError> finish();
+
+        [[nodiscard]] uint32_t rows_written() const { return next_row; }
+
+    private:
+        ScanlineWriter(std::ofstream &&out, const uint32_t w, const uint32_t h, const PpmFormat f)
+            : out_file(std::move(out)), width(w), height(h), format(f) {};
+
+        std::ofstream out_file;
+        uint32_t width;
+        uint32_t height;
+        PpmFormat format;
+        uint32_t next_row{0};
+    };
+
+    // Render an image top to bottom through a window of band_rows rows, calling shade(x, y) for each pixel and
+    // writing each band out before starting the next. A window of no rows is a dimension mismatch.
+    template<typename Shade>
+    std::expected<bool, CanvasError> stream_render(const std::string &file_path, const uint32_t width,
+                                                   const uint32_t height, const uint32_t band_rows, Shade &&shade,
+                                                   const PpmFormat format = PpmFormat::ascii) {
+        if (band_rows == 0) {
+            return std::unexpected(CanvasError::dimension_mismatch);
+        }
+        auto writer{ScanlineWriter::open(file_path, width, height, format)};
+        if (!writer.has_value()) {
+            return std::unexpected(writer.error());
+        }
+        Canvas band{width, std::min(band_rows, height)};
+        for (uint32_t first_row = 0; first_row < height; first_row += band.height) {
+            const uint32_t rows{std::min(band.height, height - first_row)};
+            for (uint32_t y = 0; y < rows; ++y) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    band.write_pixel(x, y, shade(x, first_row + y));
+                }
+            }
+            const std::span<const uint8_t> rgb{band.storage.data(), size_t{rows} * width * Canvas::channels};
+            if (const auto written{writer->write_band(rgb)}; !written.has_value()) {
+                return written;
+            }
+        }
+        return writer->finish();
+    }
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_SCANLINE_WRITER_HPP
@@ -0,0 +1,370 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include "Scene.hpp"
+
+namespace raytracer {
+    // Up to 19 significant digits are gathered into an integer and scaled once by an exact power of ten, which
+    // rounds correctly whenever both fit in a double; anything longer goes through strtod.
+    bool parse_number(const std::string_view token, double &value) {
+        constexpr std::array<double, 23> powers_of_ten{
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+            1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        const char *p{token.data()};
+        const char *const end{p + token.size()};
+        bool negative{false};
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+        uint64_t mantissa{0};
+        int significant{0};
+        int exponent{0};
+        bool any_digits{false};
+        const auto digit = [&](const int d, const bool fraction) {
+            any_digits = true;
+            if (significant < 19) {
+                mantissa = mantissa * 10 + d;
+                significant += mantissa != 0;
+                exponent -= fraction;
+            } else {
+                exponent += !fraction;
+            }
+        };
+        for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+            digit(*p - '0', false);
+        }
+        if (p != end && *p == '.') {
+            for (++p; p != end && *p >= '0' && *p <= '9'; ++p) {
+                digit(*p - '0', true);
+            }
+        }
+        if (!any_digits) {
+            return false;
+        }
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negative_exponent{false};
+            if (p != end && (*p == '-' || *p == '+')) {
+                negative_exponent = *p++ == '-';
+            }
+            if (p == end) {
+                return false;
+            }
+            int written{0};
+            for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+                written = std::min(written * 10 + (*p - '0'), 100000);
+            }
+            exponent += negative_exponent ? -written : written;
+        }
+        if (p != end) {
+            return false;
+        }
+        if (mantissa == 0) {
+            value = negative ? -0.0 : 0.0;
+        } else if (mantissa < (uint64_t{1} << 53) && exponent >= -22 && exponent <= 22) {
+            const auto m{static_cast<double>(mantissa)};
+            value = exponent < 0 ? m / powers_of_ten[-exponent] : m * powers_of_ten[exponent];
+            value = negative ? -value : value;
+        } else {
+            value = std::strtod(std::string{token}.c_str(), nullptr);
+        }
+        return std::isfinite(value);
+    }
+
+    namespace {
+
+        // 4x4 row-major, composed in place so a sphere's transform costs no allocation until it is stored
+        using Transform = std::array<double, 16>;
+
+        constexpr Transform identity_transform{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+        // transform = m * transform, i.e. m applies after everything so far
+        void compose(Transform &transform, const Transform &m) {
+            Transform result{};
+            for (size_t row = 0; row < 4; ++row) {
+                for (size_t col = 0; col < 4; ++col) {
+                    double sum{0};
+                    for (size_t k = 0; k < 4; ++k) {
+                        sum += m[row * 4 + k] * transform[k * 4 + col];
+                    }
+                    result[row * 4 + col] = sum;
+                }
+            }
+            transform = result;
+        }
+
+        enum class Entity {
+            none,
+            canvas,
+            camera,
+            light,
+            sphere
+        };
+
+        class SceneReader {
+        public:
+            explicit SceneReader(const std::string_view text) : cursor(text.data()), end(text.data() + text.size()) {
+            }
+
+            // the next whitespace separated token, or an empty view at the end of the text
+            std::string_view next() {
+                while (cursor != end) {
+                    if (*cursor == '\n') {
+                        ++line;
+                        ++cursor;
+                    } else if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+                        ++cursor;
+                    } else if (*cursor == '#') {
+                        while (cursor != end && *cursor != '\n') {
+                            ++cursor;
+                        }
+                    } else {
+                        break;
+                    }
+                }
+                const char *start{cursor};
+                while (cursor != end && *cursor != ' ' && *cursor != '\n' && *cursor != '\t' && *cursor != '\r' &&
+                       *cursor != '#') {
+                    ++cursor;
+                }
+                return {start, static_cast<size_t>(cursor - start)};
+            }
+
+            template<size_t N>
+            bool numbers(std::array<double, N> &values) {
+                for (auto &value: values) {
+                    const std::string_view token{next()};
+                    if (token.empty()) {
+                        return fail(SceneError::unexpected_end);
+                    }
+                    if (!parse_number(token, value)) {
+                        return fail(SceneError::invalid_number);
+                    }
+                }
+                return true;
+            }
+
+            bool number(double &value) {
+                std::array<double, 1> values{};
+                if (!numbers(values)) {
+                    return false;
+                }
+                value = values[0];
+                return true;
+            }
+
+            bool number(float &value) {
+                double read{};
+                if (!number(read)) {
+                    return false;
+                }
+                value = static_cast<float>(read);
+                return true;
+            }
+
+            bool point(Point &p) {
+                std::array<double, 3> values{};
+                if (!numbers(values)) {
+                    return false;
+                }
+                p = Point{static_cast<float>(values[0]), static_cast<float>(values[1]), static_cast<float>(values[2])};
+                return true;
+            }
+
+            bool vector(Vector &v) {
+                Point p{};
+                if (!point(p)) {
+                    return false;
+                }
+                v = Vector{p.x, p.y, p.z};
+                return true;
+            }
+
+            bool colour(Colour &c) {
+                Point p{};
+                if (!point(p)) {
+                    return false;
+                }
+                c = Colour{p.x, p.y, p.z};
+                return true;
+            }
+
+            bool fail(const SceneError error) {
+                failure = SceneParseError{error, line};
+                return false;
+            }
+
+            [[nodiscard]] uint32_t current_line() const { return line; }
+
+            SceneParseError failure{SceneError::unexpected_end, 0};
+
+        private:
+            const char *cursor;
+            const char *end;
+            uint32_t line{1};
+        };
+
+        bool read_transform(SceneReader &reader, const std::string_view keyword, Transform &transform) {
+            if (keyword == "translation" || keyword == "scale") {
+                std::array<double, 3> v{};
+                if (!reader.numbers(v)) {
+                    return false;
+                }
+                compose(transform, keyword == "scale"
+                                     ? Transform{v[0], 0, 0, 0, 0, v[1], 0, 0, 0, 0, v[2], 0, 0, 0, 0, 1}
+                                     : Transform{1, 0, 0, v[0], 0, 1, 0, v[1], 0, 0, 1, v[2], 0, 0, 0, 1});
+                return true;
+            }
+            if (keyword == "shearing") {
+                std::array<double, 6> s{};
+                if (!reader.numbers(s)) {
+                    return false;
+                }
+                compose(transform, Transform{1, s[0], s[1], 0, s[2], 1, s[3], 0, s[4], s[5], 1, 0, 0, 0, 0, 1});
+                return true;
+            }
+            double radians{};
+            if (!reader.number(radians)) {
+                return false;
+            }
+            const double c{std::cos(radians)};
+            const double s{std::sin(radians)};
+            if (keyword == "rotation_x") {
+                compose(transform, Transform{1, 0, 0, 0, 0, c, -s, 0, 0, s, c, 0, 0, 0, 0, 1});
+            } else if (keyword == "rotation_y") {
+                compose(transform, Transform{c, 0, s, 0, 0, 1, 0, 0, -s, 0, c, 0, 0, 0, 0, 1});
+            } else {
+                compose(transform, Transform{c, -s, 0, 0, s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1});
+            }
+            return true;
+        }
+
+        // a whole number of pixels that fits the camera's uint32_t
+        bool is_canvas_size(const double size) {
+            return size >= 1 && size <= std::numeric_limits<uint32_t>::max() && size == std::floor(size);
+        }
+
+        bool is_transform(const std::string_view keyword) {
+            return keyword == "translation" || keyword == "scale" || keyword == "shearing" ||
+                   keyword == "rotation_x" || keyword == "rotation_y" || keyword == "rotation_z";
+        }
+    }
+
+    std::expected<Scene, SceneParseError> parse_scene(const std::string_view text) {
+        SceneReader reader{text};
+        Scene scene;
+        std::array<double, 2> canvas_size{100, 100};
+        double field_of_view{std::numbers::pi / 3};
+        Point from{0, 0, -5};
+        Point to{0, 0, 0};
+        Vector up{0, 1, 0};
+        // where the camera was set, to report a view it cannot take
+        uint32_t camera_line{0};
+        Entity entity{Entity::none};
+        Transform transform{identity_transform};
+        Material material{};
+
+        const auto finish_entity = [&] {
+            if (entity == Entity::sphere) {
+                Sphere sphere{Sphere::make_sphere()};
+                sphere.set_transform(Container<double>{4, 4, transform});
+                sphere.material = material;
+                scene.spheres.push_back(std::move(sphere));
+            }
+        };
+
+        for (std::string_view token{reader.next()}; !token.empty(); token = reader.next()) {
+            bool ok{true};
+            if (token == "canvas") {
+                finish_entity();
+                entity = Entity::canvas;
+                ok = reader.numbers(canvas_size);
+                if (ok && !(is_canvas_size(canvas_size[0]) && is_canvas_size(canvas_size[1]))) {
+                    ok = reader.fail(SceneError::invalid_number);
+                }
+            } else if (token == "camera") {
+                finish_entity();
+                entity = Entity::camera;
+                camera_line = reader.current_line();
+            } else if (token == "light") {
+                finish_entity();
+                entity = Entity::light;
+                scene.lights.push_back(PointLight{Point{0, 0, 0}, Colour{1, 1, 1}});
+            } else if (token == "sphere") {
+                finish_entity();
+                entity = Entity::sphere;
+                transform = identity_transform;
+                material = Material{};
+            } else if (entity == Entity::camera && token == "fov") {
+                ok = reader.number(field_of_view);
+                // a view of pi or more flips the image, one of 0 collapses it
+                if (ok && !(field_of_view > 0 && field_of_view < std::numbers::pi)) {
+                    ok = reader.fail(SceneError::invalid_number);
+                }
+            } else if (entity == Entity::camera && token == "from") {
+                ok = reader.point(from);
+            } else if (entity == Entity::camera && token == "to") {
+                ok = reader.point(to);
+            } else if (entity == Entity::camera && token == "up") {
+                ok = reader.vector(up);
+            } else if (entity == Entity::light && token == "position") {
+                ok = reader.point(scene.lights.back().position);
+            } else if (entity == Entity::light && token == "intensity") {
+                ok = reader.colour(scene.lights.back().intensity);
+            } else if (entity == Entity::sphere && is_transform(token)) {
+                ok = read_transform(reader, token, transform);
+            } else if (entity == Entity::sphere && token == "colour") {
+                ok = reader.colour(material.colour);
+            } else if (entity == Entity::sphere && token == "ambient") {
+                ok = reader.number(material.ambient);
+            } else if (entity == Entity::sphere && token == "diffuse") {
+                ok = reader.number(material.diffuse);
+            } else if (entity == Entity::sphere && token == "specular") {
+                ok = reader.number(material.specular);
+            } else if (entity == Entity::sphere && token == "shininess") {
+                ok = reader.number(material.shininess);
+            } else if (entity == Entity::sphere && token == "reflective") {
+                ok = reader.number(material.reflective);
+            } else if (entity == Entity::sphere && token == "transparency") {
+                ok = reader.number(material.transparency);
+            } else if (entity == Entity::sphere && token == "refractive_index") {
+                ok = reader.number(material.refractive_index);
+            } else {
+                ok = reader.fail(SceneError::unknown_keyword);
+            }
+            if (!ok) {
+                return std::unexpected(reader.failure);
+            }
+        }
+        finish_entity();
+
+        scene.camera = Camera{static_cast<uint32_t>(canvas_size[0]), static_cast<uint32_t>(canvas_size[1]),
+                              field_of_view};
+        // looking nowhere, or with up along the line of sight, leaves the view with no orientation
+        if (Vector::magnitude(Vector::cross(to - from, up)) == 0 ||
+            !scene.camera.set_transform(view_transform(from, to, up))) {
+            return std::unexpected(SceneParseError{SceneError::invalid_number, camera_line});
+        }
+        return scene;
+    }
+
+    std::expected<Scene, SceneParseError> load_scene(const std::string &file_path) {
+        std::ifstream in_file(file_path, std::ios::binary | std::ios::ate);
+        if (!in_file) {
+            return std::unexpected(SceneParseError{SceneError::invalid_path});
+        }
+        std::string contents(static_cast<size_t>(in_file.tellg()), '\0');
+        in_file.seekg(0);
+        if (!in_file.read(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            return std::unexpected(SceneParseError{SceneError::invalid_path});
+        }
+        return parse_scene(contents);
+    }
+}
@@ -0,0 +1,59 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_SCENE_HPP
+#define THE_RAYTRACER_CHALLENGE_SCENE_HPP
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Camera.hpp"
+#include "Intersect.hpp"
+#include "Light.hpp"
+
+namespace raytracer {
+    enum class SceneError {
+        invalid_path,
+        unknown_keyword,
+        invalid_number,
+        unexpected_end
+    };
+
+    struct SceneParseError {
+        SceneError error;
+        // 1-based line the problem was found on; 0 when it is not about the contents
+        uint32_t line{0};
+    };
+
+    struct Scene {
+        Camera camera{100, 100, std::numbers::pi / 3};
+        std::vector<PointLight> lights;
+        std::vector<Sphere> spheres;
+    };
+
+    // Scene files are whitespace separated keywords and numbers; line breaks are only significant for ending '#'
+    // comments. Each of canvas, camera, light and sphere starts a new entity and the attributes after it, in any
+    // order, apply to that entity:
+    //
+    //     canvas 640 480
+    //     camera fov 1.047 from 0 1.5 -5 to 0 1 0 up 0 1 0
+    //     light position -10 10 -10 intensity 1 1 1
+    //     sphere translation 0 1 0 scale 0.5 0.5 0.5 colour 1 0.2 1 diffuse 0.7 specular 0.3
+    //
+    // Sphere transforms are translation, scale, rotation_x/y/z (radians) and shearing (six values), applied in the
+    // order written, so "scale 2 2 2 translation 0 1 0" scales first. Material attributes are colour, ambient,
+    // diffuse, specular, shininess, reflective, transparency and refractive_index. Anything not given keeps the
+    // defaults of Camera and Material; a light without an intensity is white.
+    std::expected<Scene, SceneParseError> parse_scene(std::string_view text);
+
+    // A decimal number as scene files write them: optional sign, digits with an optional fraction and exponent.
+    // False for anything else and for numbers too large to be finite.
+    bool parse_number(std::string_view token, double &value);
+
+    std::expected<Scene, SceneParseError> load_scene(const std::string &file_path);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_SCENE_HPP
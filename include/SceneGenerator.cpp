@@ -0,0 +1,155 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <numbers>
+#include <vector>
+#include "SceneGenerator.hpp"
+
+namespace raytracer {
+    namespace {
+        // SplitMix64: tiny, fast and fully specified, unlike the standard distributions whose output differs
+        // between library implementations
+        class Random {
+        public:
+            explicit Random(const uint64_t seed) : state(seed) {
+            }
+
+            uint64_t next() {
+                uint64_t z{state += 0x9e3779b97f4a7c15};
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                return z ^ (z >> 31);
+            }
+
+            // uniform in [low, high)
+            float uniform(const float low, const float high) {
+                return low + (high - low) * static_cast<float>(next() >> 40) * 0x1p-24f;
+            }
+
+            // roughly normal around 0 with the given spread, from the sum of three uniforms
+            float bell(const float spread) {
+                return (uniform(-1, 1) + uniform(-1, 1) + uniform(-1, 1)) * spread / 3;
+            }
+
+        private:
+            uint64_t state;
+        };
+
+        class SceneWriter {
+        public:
+            explicit SceneWriter(std::string &text) : text(text) {
+            }
+
+            SceneWriter &operator<<(const char *keyword) {
+                if (keyword[0] != '\n' && !text.empty() && text.back() != '\n') {
+                    text += ' ';
+                }
+                text += keyword;
+                return *this;
+            }
+
+            SceneWriter &operator<<(const float value) {
+                char buffer[32];
+                text += ' ';
+                text.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+                return *this;
+            }
+
+            SceneWriter &operator<<(const uint32_t value) {
+                char buffer[16];
+                text += ' ';
+                text.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+                return *this;
+            }
+
+        private:
+            std::string &text;
+        };
+    }
+
+    std::string generate_scene_text(const GeneratorOptions &options) {
+        Random random{options.seed};
+        const float extent{options.extent};
+        std::string text;
+        // generated lines are well under 200 characters
+        text.reserve(size_t{options.count} * 200 + 1024);
+        SceneWriter out{text};
+
+        out << "canvas" << options.width << options.height << "\n";
+        out << "camera fov" << std::numbers::pi_v<float> / 3 << "from" << 0.0f << extent * 0.5f << extent * -3.5f
+                << "to" << 0.0f << 0.0f << 0.0f << "up" << 0.0f << 1.0f << 0.0f << "\n";
+        // lights on a ring above and in front of the scene, sharing out the total intensity
+        for (uint32_t i = 0; i < options.lights; ++i) {
+            const float angle{2 * std::numbers::pi_v<float> * static_cast<float>(i) / options.lights};
+            const float intensity{1.0f / static_cast<float>(options.lights)};
+            out << "light position" << extent * 3 * std::sin(angle) << extent * 3 << extent * -3 * std::cos(angle)
+                    << "intensity" << intensity << intensity << intensity << "\n";
+        }
+
+        // cluster centres come first so the sphere sequence does not depend on the number of clusters drawn later
+        std::vector<std::array<float, 3>> centres(std::max(options.clusters, 1u));
+        for (auto &centre: centres) {
+            centre = {random.uniform(-extent, extent), random.uniform(-extent, extent), random.uniform(-extent, extent)};
+        }
+        // drawn after the centres, so without a palette the spheres come out as they always have
+        struct PaletteEntry {
+            float r, g, b, diffuse, specular, shininess;
+        };
+        const auto random_material = [&random] {
+            return PaletteEntry{
+                random.uniform(0.2f, 1), random.uniform(0.2f, 1), random.uniform(0.2f, 1), random.uniform(0.5f, 0.9f),
+                random.uniform(0.1f, 0.9f), random.uniform(10, 200)
+            };
+        };
+        std::vector<PaletteEntry> palette(options.materials);
+        for (auto &entry: palette) {
+            entry = random_material();
+        }
+        // uniform spheres take up about the same fraction of the cube whatever the count
+        const float uniform_radius{extent * 0.6f / std::cbrt(static_cast<float>(std::max(options.count, 1u)))};
+        for (uint32_t i = 0; i < options.count; ++i) {
+            float radius{};
+            std::array<float, 3> position{};
+            switch (options.distribution) {
+                case Distribution::clustered: {
+                    const auto &centre{centres[random.next() % centres.size()]};
+                    const float spread{extent * 0.08f};
+                    position = {
+                        centre[0] + random.bell(spread), centre[1] + random.bell(spread),
+                        centre[2] + random.bell(spread)
+                    };
+                    radius = uniform_radius * random.uniform(0.3f, 0.6f);
+                    break;
+                }
+                case Distribution::overlapping:
+                    position = {random.bell(extent * 0.1f), random.bell(extent * 0.1f), random.bell(extent * 0.1f)};
+                    radius = extent * random.uniform(0.3f, 0.6f);
+                    break;
+                default:
+                    position = {
+                        random.uniform(-extent, extent), random.uniform(-extent, extent),
+                        random.uniform(-extent, extent)
+                    };
+                    radius = uniform_radius * random.uniform(0.5f, 1.0f);
+                    break;
+            }
+            out << "sphere scale" << radius * random.uniform(0.7f, 1.3f) << radius * random.uniform(0.7f, 1.3f)
+                    << radius * random.uniform(0.7f, 1.3f)
+                    << "rotation_x" << random.uniform(0, std::numbers::pi_v<float>)
+                    << "rotation_y" << random.uniform(0, std::numbers::pi_v<float>)
+                    << "translation" << position[0] << position[1] << position[2];
+            const PaletteEntry material{palette.empty() ? random_material() : palette[random.next() % palette.size()]};
+            out << "colour" << material.r << material.g << material.b << "diffuse" << material.diffuse
+                    << "specular" << material.specular << "shininess" << material.shininess << "\n";
+        }
+        return text;
+    }
+
+    std::expected<Scene, SceneParseError> generate_scene(const GeneratorOptions &options) {
+        return parse_scene(generate_scene_text(options));
+    }
+}
@@ -0,0 +1,49 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_SCENE_GENERATOR_HPP
+#define THE_RAYTRACER_CHALLENGE_SCENE_GENERATOR_HPP
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include "Scene.hpp"
+
+namespace raytracer {
+    enum class Distribution {
+        // centres spread evenly through a cube, sized so the cube stays about equally full at any count
+        uniform,
+        // tight groups around a few random centres, leaving most of the cube empty
+        clustered,
+        // large spheres piled on the origin, so every ray near the middle crosses many of them; the worst case for
+        // any spatial subdivision
+        overlapping
+    };
+
+    struct GeneratorOptions {
+        uint32_t count{1000};
+        uint64_t seed{1};
+        Distribution distribution{Distribution::uniform};
+        // spheres are placed within [-extent, extent] on every axis
+        float extent{10};
+        uint32_t clusters{8};
+        // spheres take their material from a palette of this many, as copies of the same few objects would; 0
+        // gives every sphere its own
+        uint32_t materials{0};
+        uint32_t lights{1};
+        uint32_t width{160};
+        uint32_t height{120};
+    };
+
+    // The scene in the text format of parse_scene: every sphere gets a random scale, rotation and translation and
+    // its own material or one from the palette. The same options always give the same text with the same maths
+    // library, so generated scenes can be written out, cached and compared across runs.
+    std::string generate_scene_text(const GeneratorOptions &options);
+
+    // generate_scene_text() parsed; options that make no valid scene, such as a canvas of no pixels or an extent of
+    // 0 that puts the camera where it looks, fail as parse_scene() reports them
+    std::expected<Scene, SceneParseError> generate_scene(const GeneratorOptions &options);
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_SCENE_GENERATOR_HPP
@@ -0,0 +1,69 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <algorithm>
+#include "SceneGraph.hpp"
+
+namespace raytracer {
+    SceneGraph::SceneGraph()
+        : parents{root}, locals(1), inverse_locals(1), local_invertible{1}, worlds(1), inverse_worlds(1),
+          world_invertible{1}, dirty{0}, first_dirty(1) {
+    }
+
+    std::expected<uint32_t, SceneGraphError> SceneGraph::add_group(const uint32_t parent, const Matrix4 &transform) {
+        // every existing group comes before the new one, so update() still sees parents first
+        if (parent >= parents.size()) {
+            return std::unexpected(SceneGraphError::unknown_parent);
+        }
+        const auto group{static_cast<uint32_t>(parents.size())};
+        parents.push_back(parent);
+        locals.emplace_back();
+        inverse_locals.emplace_back();
+        local_invertible.push_back(1);
+        worlds.emplace_back();
+        inverse_worlds.emplace_back();
+        world_invertible.push_back(1);
+        dirty.push_back(0);
+        set_transform(group, transform);
+        return group;
+    }
+
+    void SceneGraph::set_transform(const uint32_t group, const Matrix4 &transform) {
+        locals[group] = transform;
+        const auto inverted{invert(transform)};
+        inverse_locals[group] = inverted.value_or(Matrix4{.m = {}});
+        local_invertible[group] = inverted.has_value();
+        dirty[group] = 1;
+        first_dirty = std::min(first_dirty, group);
+    }
+
+    std::vector<uint32_t> SceneGraph::update() {
+        std::vector<uint32_t> changed;
+        // dirty[g] ends up set for every group below one that was set, so children see it from their parent
+        for (uint32_t group = first_dirty; group < parents.size(); ++group) {
+            const uint32_t parent{parents[group]};
+            if (dirty[group] == 0 && dirty[parent] == 0) {
+                continue;
+            }
+            dirty[group] = 1;
+            if (group == root) {
+                worlds[group] = locals[group];
+                world_invertible[group] = local_invertible[group];
+                inverse_worlds[group] = inverse_locals[group];
+            } else {
+                worlds[group] = multiply(worlds[parent], locals[group]);
+                world_invertible[group] = local_invertible[group] & world_invertible[parent];
+                inverse_worlds[group] = world_invertible[group] != 0
+                                            ? multiply(inverse_locals[group], inverse_worlds[parent])
+                                            : Matrix4{.m = {}};
+            }
+            changed.push_back(group);
+        }
+        for (const uint32_t group: changed) {
+            dirty[group] = 0;
+        }
+        first_dirty = static_cast<uint32_t>(parents.size());
+        return changed;
+    }
+}
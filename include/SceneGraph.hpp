@@ -0,0 +1,74 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_SCENE_GRAPH_HPP
+#define THE_RAYTRACER_CHALLENGE_SCENE_GRAPH_HPP
+
+#include <cstdint>
+#include <expected>
+#include <vector>
+#include "Matrix4.hpp"
+
+namespace raytracer {
+    enum class SceneGraphError {
+        // the parent given is not a group of the graph
+        unknown_parent
+    };
+
+    // A tree of groups, each placed by a transform relative to its parent, so that moving a group moves everything
+    // in it. Every group caches its world transform, the product of its own and its ancestors', and the inverse of
+    // that. set_transform() only records the change; update() then recomputes the cached matrices of the groups
+    // that were changed and of those below them, one product each, and leaves the rest alone.
+    //
+    // A group is always added after its parent, so the groups are stored parents first and update() is a single
+    // pass in order, starting at the first changed group.
+    class SceneGraph {
+    public:
+        // the group everything else hangs from, placed at the identity to begin with
+        static constexpr uint32_t root{0};
+
+        SceneGraph();
+
+        // a new group under parent, which has to be an existing group; returns its number
+        std::expected<uint32_t, SceneGraphError> add_group(uint32_t parent, const Matrix4 &transform = {});
+
+        // group relative to its parent; takes effect at the next update()
+        void set_transform(uint32_t group, const Matrix4 &transform);
+
+        // recomputes the world transforms that set_transform() has made stale; returns the groups whose world
+        // transform changed, parents before children
+        std::vector<uint32_t> update();
+
+        [[nodiscard]] size_t group_count() const { return parents.size(); }
+
+        [[nodiscard]] uint32_t parent(const uint32_t group) const { return parents[group]; }
+
+        [[nodiscard]] const Matrix4 &transform(const uint32_t group) const { return locals[group]; }
+
+        // as of the last update()
+        [[nodiscard]] const Matrix4 &world_transform(const uint32_t group) const { return worlds[group]; }
+
+        // all zero when the group or one above it has a singular transform
+        [[nodiscard]] const Matrix4 &inverse_world_transform(const uint32_t group) const {
+            return inverse_worlds[group];
+        }
+
+        // whether anything in the group can be seen; false when its world transform is singular
+        [[nodiscard]] bool invertible(const uint32_t group) const { return world_invertible[group] != 0; }
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<Matrix4> locals;
+        std::vector<Matrix4> inverse_locals;
+        std::vector<uint8_t> local_invertible;
+        std::vector<Matrix4> worlds;
+        std::vector<Matrix4> inverse_worlds;
+        std::vector<uint8_t> world_invertible;
+        std::vector<uint8_t> dirty;
+        // no group before this one is dirty
+        uint32_t first_dirty;
+    };
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_SCENE_GRAPH_HPP
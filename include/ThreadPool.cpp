@@ -0,0 +1,266 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <utility>
+#include "ThreadPool.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace raytracer {
+    namespace {
+        // the pool and worker index of the current thread, if it is a worker
+        thread_local ThreadPool *current_pool{nullptr};
+        thread_local size_t current_worker{0};
+
+        // xorshift for picking steal victims; quality hardly matters, cost does
+        uint32_t next_victim_seed() {
+            thread_local uint32_t state{
+                static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1u
+            };
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+    }
+
+    TaskDeque::TaskDeque(const int64_t capacity) {
+        int64_t rounded{1};
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        rings.push_back(std::make_unique<Ring>(rounded));
+        ring.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    TaskDeque::Ring *TaskDeque::grow(Ring *old_ring, const int64_t bottom_index, const int64_t top_index) {
+        auto bigger{std::make_unique<Ring>(old_ring->capacity * 2)};
+        for (int64_t i = top_index; i < bottom_index; ++i) {
+            bigger->put(i, old_ring->get(i));
+        }
+        Ring *result{bigger.get()};
+        rings.push_back(std::move(bigger));
+        ring.store(result, std::memory_order_release);
+        return result;
+    }
+
+    void TaskDeque::push(Task *task) {
+        const int64_t b{bottom.load(std::memory_order_relaxed)};
+        const int64_t t{top.load(std::memory_order_acquire)};
+        Ring *r{ring.load(std::memory_order_relaxed)};
+        if (b - t > r->capacity - 1) {
+            r = grow(r, b, t);
+        }
+        r->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    Task *TaskDeque::pop() {
+        const int64_t b{bottom.load(std::memory_order_relaxed) - 1};
+        Ring *r{ring.load(std::memory_order_relaxed)};
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t{top.load(std::memory_order_relaxed)};
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Task *task{r->get(b)};
+        if (t == b) {
+            // the last task: race any thief for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    Task *TaskDeque::steal() {
+        int64_t t{top.load(std::memory_order_acquire)};
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b{bottom.load(std::memory_order_acquire)};
+        if (t >= b) {
+            return nullptr;
+        }
+        Task *task{ring.load(std::memory_order_acquire)->get(t)};
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+    ThreadPool::ThreadPool(const ThreadPoolOptions options) {
+        // every deque exists before any worker starts looking for victims
+        for (unsigned i = 0; i < options.threads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i]->thread = std::jthread([this, i, pin = options.pin_threads] { run_worker(i, pin); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        stopping.store(true);
+        epoch.fetch_add(1);
+        epoch.notify_all();
+        for (const auto &worker: workers) {
+            worker->thread.join();
+        }
+    }
+
+    ThreadPool &ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::submit(Task *task) {
+        if (current_pool == this) {
+            workers[current_worker]->deque.push(task);
+        } else {
+            std::scoped_lock lock{injected_mutex};
+            injected.push_back(task);
+            injected_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake_one();
+    }
+
+    void ThreadPool::wake_one() {
+        epoch.fetch_add(1);
+        if (sleeping.load() > 0) {
+            epoch.notify_one();
+        }
+    }
+
+    Task *ThreadPool::find_task() {
+        if (current_pool == this) {
+            if (Task *task{workers[current_worker]->deque.pop()}) {
+                return task;
+            }
+        }
+        if (injected_count.load(std::memory_order_relaxed) > 0) {
+            std::scoped_lock lock{injected_mutex};
+            if (!injected.empty()) {
+                Task *task{injected.front()};
+                injected.pop_front();
+                injected_count.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        if (workers.empty()) {
+            return nullptr;
+        }
+        const size_t start{next_victim_seed() % workers.size()};
+        for (size_t i = 0; i < workers.size(); ++i) {
+            const size_t victim{(start + i) % workers.size()};
+            if (current_pool == this && victim == current_worker) {
+                continue;
+            }
+            if (Task *task{workers[victim]->deque.steal()}) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void ThreadPool::execute(Task *task) {
+        std::exception_ptr error;
+        try {
+            task->work();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        TaskGroup *group{task->group};
+        delete task;
+        if (error) {
+            group->record(error);
+        }
+        group->pending.fetch_sub(1, std::memory_order_acq_rel);
+        task_finished();
+    }
+
+    void ThreadPool::task_finished() {
+        completions.fetch_add(1);
+        if (waiting.load() > 0) {
+            completions.notify_all();
+        }
+    }
+
+    void ThreadPool::run_worker(const size_t index, const bool pin) {
+        current_pool = this;
+        current_worker = index;
+#if defined(__linux__)
+        if (pin) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET((index + 1) % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+#else
+        static_cast<void>(pin);
+#endif
+        while (true) {
+            const uint64_t seen{epoch.load()};
+            if (Task *task{find_task()}) {
+                execute(task);
+                continue;
+            }
+            // only once nothing is left to run, so queued work still completes on shutdown
+            if (stopping.load()) {
+                return;
+            }
+            sleeping.fetch_add(1);
+            epoch.wait(seen);
+            sleeping.fetch_sub(1);
+        }
+    }
+
+    TaskGroup::~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+            // a destructor cannot rethrow; call wait() first to see task errors
+        }
+    }
+
+    void TaskGroup::run(std::function<void()> work) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit(new Task{std::move(work), this});
+    }
+
+    void TaskGroup::wait() {
+        while (true) {
+            const uint64_t seen{pool.completions.load()};
+            if (pending.load(std::memory_order_acquire) == 0) {
+                break;
+            }
+            if (Task *task{pool.find_task()}) {
+                pool.execute(task);
+                continue;
+            }
+            pool.waiting.fetch_add(1);
+            pool.completions.wait(seen);
+            pool.waiting.fetch_sub(1);
+        }
+        std::exception_ptr error;
+        {
+            std::scoped_lock lock{error_mutex};
+            error = std::exchange(first_error, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void TaskGroup::record(std::exception_ptr error) {
+        std::scoped_lock lock{error_mutex};
+        if (!first_error) {
+            first_error = std::move(error);
+        }
+    }
+}
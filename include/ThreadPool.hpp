@@ -0,0 +1,225 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#ifndef THE_RAYTRACER_CHALLENGE_THREAD_POOL_HPP
+#define THE_RAYTRACER_CHALLENGE_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace raytracer {
+    class TaskGroup;
+
+    struct Task {
+        std::function<void()> work;
+        TaskGroup *group{nullptr};
+    };
+
+    // Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models"). The
+    // owning thread pushes and pops at the bottom without locking; any other thread may steal from the top. The ring
+    // doubles when full and replaced rings are kept until the deque is destroyed, since a thief may still be reading
+    // one.
+    class TaskDeque {
+    public:
+        explicit TaskDeque(int64_t capacity = 256);
+
+        TaskDeque(const TaskDeque &) = delete;
+        TaskDeque &operator=(const TaskDeque &) = delete;
+
+        // owner only
+        void push(Task *task);
+
+        // owner only; the most recently pushed task, or nullptr
+        Task *pop();
+
+        // any thread; the oldest task, or nullptr when empty or another thread won the race for it
+        Task *steal();
+
+        [[nodiscard]] bool empty() const {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Ring {
+            explicit Ring(const int64_t capacity) : capacity(capacity), slots(new std::atomic<Task *>[capacity]) {
+            }
+
+            Task *get(const int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+
+            void put(const int64_t i, Task *task) { slots[i & (capacity - 1)].store(task, std::memory_order_relaxed); }
+
+            int64_t capacity;
+            std::unique_ptr<std::atomic<Task *>[]> slots;
+        };
+
+        Ring *grow(Ring *ring, int64_t bottom_index, int64_t top_index);
+
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Ring *> ring;
+        std::vector<std::unique_ptr<Ring>> rings;
+    };
+
+    struct ThreadPoolOptions {
+        // workers besides the thread that waits on the work, which helps run it; 0 runs everything on that thread
+        unsigned threads{std::max(1u, std::thread::hardware_concurrency()) - 1};
+        // pin worker i to core i + 1, leaving core 0 to the main thread; Linux only, ignored elsewhere
+        bool pin_threads{false};
+    };
+
+    // a half-open rectangle of cells, [x_begin, x_end) x [y_begin, y_end)
+    struct Range2D {
+        uint32_t x_begin{0};
+        uint32_t x_end{0};
+        uint32_t y_begin{0};
+        uint32_t y_end{0};
+    };
+
+    // Work-stealing scheduler. Every worker owns a TaskDeque: tasks spawned on a worker go to the bottom of its own
+    // deque and are popped from there, so a worker keeps working on what it just split off while idle workers steal
+    // the older, larger pieces from the top. Threads outside the pool submit through a shared queue and help run
+    // tasks while they wait.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(ThreadPoolOptions options = {});
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // finishes queued work before the workers exit
+        ~ThreadPool();
+
+        // process-wide pool with the default options, started on first use
+        static ThreadPool &shared();
+
+        // worker threads, not counting the waiting thread
+        [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+        // body(begin, end) over [begin, end), split in halves until pieces are at most grain long
+        template<typename Body>
+        void parallel_for(size_t begin, size_t end, size_t grain, Body &&body);
+
+        // body(tile) over range cut into tile_width x tile_height tiles, one task per tile, rows of tiles first
+        template<typename Body>
+        void parallel_for(const Range2D &range, uint32_t tile_width, uint32_t tile_height, Body &&body);
+
+    private:
+        friend class TaskGroup;
+
+        struct Worker {
+            TaskDeque deque;
+            std::jthread thread;
+        };
+
+        void submit(Task *task);
+
+        // a task from this thread's own deque, the shared queue or another worker, in that order
+        Task *find_task();
+
+        void execute(Task *task);
+
+        void run_worker(size_t index, bool pin);
+
+        void wake_one();
+
+        void task_finished();
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex injected_mutex;
+        std::deque<Task *> injected;
+        std::atomic<size_t> injected_count{0};
+        // bumped whenever work is published, so sleeping workers can wait for a change without missing one
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<uint32_t> sleeping{0};
+        // bumped whenever a task finishes; TaskGroup::wait sleeps on it, since a group may be gone by the time its
+        // last task could notify it
+        std::atomic<uint64_t> completions{0};
+        std::atomic<uint32_t> waiting{0};
+        std::atomic<bool> stopping{false};
+    };
+
+    // A set of tasks that can be waited for together. Tasks may add more tasks to their own group, which is how
+    // parallel_for splits work recursively. The first exception a task throws is rethrown by wait().
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool &pool) : pool(pool) {
+        }
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        ~TaskGroup();
+
+        void run(std::function<void()> work);
+
+        // runs tasks, from this group or any other, until every task in the group has finished
+        void wait();
+
+    private:
+        friend class ThreadPool;
+
+        void record(std::exception_ptr error);
+
+        ThreadPool &pool;
+        std::atomic<uint32_t> pending{0};
+        std::mutex error_mutex;
+        std::exception_ptr first_error;
+    };
+
+    template<typename Body>
+    void ThreadPool::parallel_for(const size_t begin, const size_t end, const size_t grain, Body &&body) {
+        if (begin >= end) {
+            return;
+        }
+        TaskGroup group{*this};
+        const size_t piece{std::max<size_t>(grain, 1)};
+        // keep the first half of every split on this thread and hand the second half out, so the pieces left for
+        // thieves are always the largest ones
+        std::function<void(size_t, size_t)> split = [&](size_t from, size_t to) {
+            while (to - from > piece) {
+                const size_t middle{from + (to - from) / 2};
+                group.run([&split, middle, to] { split(middle, to); });
+                to = middle;
+            }
+            body(from, to);
+        };
+        // tasks still running refer to split, so they must finish before an exception leaves this frame
+        try {
+            split(begin, end);
+        } catch (...) {
+            group.record(std::current_exception());
+        }
+        group.wait();
+    }
+
+    template<typename Body>
+    void ThreadPool::parallel_for(const Range2D &range, const uint32_t tile_width, const uint32_t tile_height,
+                                  Body &&body) {
+        if (range.x_begin >= range.x_end || range.y_begin >= range.y_end) {
+            return;
+        }
+        const uint32_t width{std::max(tile_width, 1u)};
+        const uint32_t height{std::max(tile_height, 1u)};
+        const uint32_t tiles_x{(range.x_end - range.x_begin + width - 1) / width};
+        const uint32_t tiles_y{(range.y_end - range.y_begin + height - 1) / height};
+        parallel_for(0, size_t{tiles_x} * tiles_y, 1, [&](const size_t first, const size_t last) {
+            for (size_t tile = first; tile < last; ++tile) {
+                const uint32_t x{range.x_begin + static_cast<uint32_t>(tile % tiles_x) * width};
+                const uint32_t y{range.y_begin + static_cast<uint32_t>(tile / tiles_x) * height};
+                body(Range2D{x, std::min(x + width, range.x_end), y, std::min(y + height, range.y_end)});
+            }
+        });
+    }
+}
+
+#endif //THE_RAYTRACER_CHALLENGE_THREAD_POOL_HPP
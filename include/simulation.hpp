@@ -13,4 +13,8 @@ void simulate_sphere();
 
 void simulate_material_sphere();
 
+void simulate_poster_sphere();
+
+void simulate_orbiting_light();
+
 #endif //THE_RAYTRACER_CHALLENGE_SIMULATION_HPP
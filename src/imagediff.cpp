@@ -0,0 +1,155 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include <charconv>
+#include <filesystem>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Canvas.hpp"
+#include "ImageCodecs.hpp"
+#include "ImageDiff.hpp"
+
+// Compare rendered images against golden ones.
+//
+//   imagediff <expected> <actual> [--max-error N] [--min-psnr DB] [--diff PATH] [--gain N]
+//
+// <expected> and <actual> are either two images (PPM, PNG or QOI) or two directories, in which case every image in
+// <expected> is compared with the file of the same name in <actual>. --diff writes the difference image, or one per
+// failing pair into a directory. Exit status is 0 when everything is within tolerance, 1 when anything is not and 2
+// for usage or I/O errors.
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct Options {
+        fs::path expected;
+        fs::path actual;
+        std::optional<fs::path> diff;
+        uint32_t gain{8};
+        uint32_t max_error{0};
+        double min_psnr{0.0};
+    };
+
+    enum class Outcome {
+        pass,
+        fail,
+        error
+    };
+
+    template<typename T>
+    bool parse_number(const std::string_view text, T &value) {
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc{} && end == text.data() + text.size();
+    }
+
+    std::optional<Options> parse_arguments(const int argc, char **argv) {
+        Options options;
+        std::vector<std::string_view> positional;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view argument{argv[i]};
+            const bool has_value{i + 1 < argc};
+            if (argument == "--diff" && has_value) {
+                options.diff = argv[++i];
+            } else if (argument == "--gain" && has_value) {
+                if (!parse_number(argv[++i], options.gain)) {
+                    return std::nullopt;
+                }
+            } else if (argument == "--max-error" && has_value) {
+                if (!parse_number(argv[++i], options.max_error)) {
+                    return std::nullopt;
+                }
+            } else if (argument == "--min-psnr" && has_value) {
+                if (!parse_number(argv[++i], options.min_psnr)) {
+                    return std::nullopt;
+                }
+            } else if (argument.starts_with("--")) {
+                return std::nullopt;
+            } else {
+                positional.push_back(argument);
+            }
+        }
+        if (positional.size() != 2) {
+            return std::nullopt;
+        }
+        options.expected = positional[0];
+        options.actual = positional[1];
+        return options;
+    }
+
+    Outcome compare_files(const fs::path &expected_path, const fs::path &actual_path, const Options &options,
+                          const std::optional<fs::path> &diff_path) {
+        const auto expected{raytracer::load_image(expected_path.string())};
+        const auto actual{raytracer::load_image(actual_path.string())};
+        if (!expected.has_value() || !actual.has_value()) {
+            std::println("{}: cannot read {}", expected_path.filename().string(),
+                         expected.has_value() ? actual_path.string() : expected_path.string());
+            return Outcome::error;
+        }
+        const auto stats{raytracer::compare(*expected, *actual)};
+        if (!stats.has_value()) {
+            std::println("{}: FAIL size {}x{} != {}x{}", expected_path.filename().string(), expected->width,
+                         expected->height, actual->width, actual->height);
+            return Outcome::fail;
+        }
+        const bool pass{stats->max_abs_error <= options.max_error && stats->psnr >= options.min_psnr};
+        std::println("{}: {} max {} rmse {:.4f} psnr {:.2f} dB, {} pixels differ", expected_path.filename().string(),
+                     pass ? "ok" : "FAIL", stats->max_abs_error, stats->rmse, stats->psnr, stats->differing_pixels);
+        if (!pass && diff_path.has_value()) {
+            const auto diff{raytracer::diff_image(*expected, *actual, options.gain)};
+            if (!diff.has_value() || !raytracer::save_image(*diff, diff_path->string()).has_value()) {
+                std::println("{}: cannot write {}", expected_path.filename().string(), diff_path->string());
+            }
+        }
+        return pass ? Outcome::pass : Outcome::fail;
+    }
+}
+
+int main(const int argc, char **argv) {
+    const auto options{parse_arguments(argc, argv)};
+    if (!options.has_value()) {
+        std::println("usage: imagediff <expected> <actual> [--max-error N] [--min-psnr DB] [--diff PATH] [--gain N]");
+        return 2;
+    }
+    if (!fs::is_directory(options->expected)) {
+        switch (compare_files(options->expected, options->actual, *options, options->diff)) {
+            case Outcome::pass:
+                return 0;
+            case Outcome::fail:
+                return 1;
+            default:
+                return 2;
+        }
+    }
+
+    if (options->diff.has_value()) {
+        fs::create_directories(*options->diff);
+    }
+    size_t passed{0};
+    size_t failed{0};
+    size_t errors{0};
+    for (const auto &entry: fs::directory_iterator(options->expected)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        const fs::path name{entry.path().filename()};
+        const std::optional<fs::path> diff_path{
+            options->diff.has_value() ? std::optional{*options->diff / name} : std::nullopt
+        };
+        switch (compare_files(entry.path(), options->actual / name, *options, diff_path)) {
+            case Outcome::pass:
+                ++passed;
+                break;
+            case Outcome::fail:
+                ++failed;
+                break;
+            default:
+                ++errors;
+        }
+    }
+    std::println("{} passed, {} failed, {} unreadable", passed, failed, errors);
+    return errors != 0 ? 2 : failed != 0 ? 1 : 0;
+}
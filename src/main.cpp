@@ -1,10 +1,22 @@
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <random>
 #include <print>
 #include "Canvas.hpp"
+#include "CompiledScene.hpp"
+#include "ImageCodecs.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
 #include "simulation.hpp"
 #include "Utils.hpp"
 
+// raytracer [scene-file [output-image]]
+//
+// Renders a scene file (see Scene.hpp for the format), with shadows and up to 16 samples a pixel at edges, to the
+// given image, PPM, PNG or QOI by extension, or next to the scene as a PNG. The compiled scene is cached in
+// <scene-file>.cache. Without arguments it runs the built-in simulations below.
+
 void test() {
     raytracer::Canvas c(16, 16);
     const raytracer::Colour color(0.66, 0.33, 0.33);
@@ -18,11 +30,68 @@ void test() {
     [[maybe_unused]] auto ret = raytracer::canvas_to_ppm(c, "testfile.ppm");
 }
 
-int main() {
+namespace {
+    const char *describe(const raytracer::SceneError error) {
+        switch (error) {
+            case raytracer::SceneError::invalid_path:
+                return "cannot be read";
+            case raytracer::SceneError::unknown_keyword:
+                return "unknown keyword";
+            case raytracer::SceneError::invalid_number:
+                return "invalid number";
+            default:
+                return "unexpected end of file";
+        }
+    }
+
+    int render_scene_file(const std::filesystem::path &scene_path, const std::filesystem::path &output_path) {
+        using clock = std::chrono::steady_clock;
+        const auto start{clock::now()};
+        const auto scene{raytracer::load_compiled_scene(scene_path.string(), scene_path.string() + ".cache")};
+        if (!scene.has_value()) {
+            std::println(stderr, "{}:{}: {}", scene_path.string(), scene.error().line,
+                         describe(scene.error().error));
+            return 1;
+        }
+        const auto loaded{clock::now()};
+        raytracer::RenderStats stats;
+        const raytracer::Canvas canvas{raytracer::render(scene.value(), {
+            .shadows = true, .max_samples = 16, .stats = &stats
+        })};
+        const auto rendered{clock::now()};
+        if (!raytracer::save_image(canvas, output_path.string()).has_value()) {
+            std::println(stderr, "Cannot write {}", output_path.string());
+            return 1;
+        }
+        const auto ms = [](const auto duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        };
+        std::println("{} spheres, {} lights: {} in {:.1f} ms, rendered in {:.1f} ms, written to {}",
+                     scene->object_count(), scene->lights().size(), scene->is_mapped() ? "mapped" : "compiled",
+                     ms(loaded - start), ms(rendered - loaded), output_path.string());
+        std::println("{:.2f} samples a pixel, {} reflected or refracted rays, average depth {:.2f}",
+                     stats.average_samples(), stats.secondary_rays, stats.average_depth());
+        const auto &bvh{scene->bvh_stats()};
+        std::println("BVH: {} nodes, {} leaves, depth {}, SAH cost {:.2f}, built in {:.1f} ms", bvh.node_count,
+                     bvh.leaf_count, bvh.depth, bvh.sah_cost, bvh.build_ms);
+        return 0;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    if (argc > 1) {
+        const std::filesystem::path scene_path{argv[1]};
+        return render_scene_file(scene_path, argc > 2
+                                                 ? std::filesystem::path{argv[2]}
+                                                 : std::filesystem::path{scene_path}.replace_extension(".png"));
+    }
+
     // simulate_projectile();
     // simulate_clock();
     // test();
     // simulate_sphere();
     simulate_material_sphere();
+    // simulate_poster_sphere();
+    // simulate_orbiting_light();
     return 0;
 }
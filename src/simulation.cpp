@@ -8,8 +8,14 @@
 #include "Vector.hpp"
 #include "simulation.hpp"
 #include "Canvas.hpp"
+#include "ScanlineWriter.hpp"
+#include "AsyncImageWriter.hpp"
+#include <format>
 #include <numbers>
+#include <cmath>
+#include <vector>
 
+#include "Camera.hpp"
 #include "Intersect.hpp"
 #include "MatrixImpl.hpp"
 
@@ -32,6 +38,15 @@ Projectile tick(const Environment &env, const Projectile &proj) {
     return {new_position, new_velocity};
 }
 
+// The view the sphere demos have always had: the eye 5 units in front of the unit sphere, looking through it at a wall
+// 7 units across, 10 units behind it
+raytracer::Camera sphere_camera(const uint32_t pixels) {
+    using namespace raytracer;
+    Camera camera{pixels, pixels, 2 * std::atan(3.5 / 15)};
+    camera.set_transform(view_transform(Point{0, 0, -5}, Point{0, 0, 0}, Vector{0, 1, 0}));
+    return camera;
+}
+
 void save_canvas(const raytracer::Canvas& canvas, const std::string& filename) {
     const auto& retval = raytracer::canvas_to_ppm(canvas, filename);
     if (retval.has_value()) {
@@ -105,9 +120,6 @@ void simulate_clock() {
 void simulate_sphere() {
     using namespace raytracer;
     constexpr auto canvas_pixels{256u};
-    constexpr auto wall_size{7.f};
-    constexpr auto pixel_size{wall_size/canvas_pixels};
-    constexpr auto half{wall_size / 2};
     Canvas canvas{canvas_pixels, canvas_pixels};
     constexpr Colour colour{.r=1.f};
     Sphere shape = Sphere::make_sphere();
@@ -119,18 +131,12 @@ void simulate_sphere() {
     shape.set_transform(multiply(rotation_z(std::numbers::pi/4),  scale<double>(0.5, 1, 1)));
     // shrink it, and skew it
     shape.set_transform(multiply(shearing(1, 0, 0, 0, 0, 0), scale<double>(0.5, 1, 1)));
-    constexpr auto wall_z{10.0f};
-    constexpr Point ray_origin{0, 0, -5};
-    // Convert canvas pixels to world coordinates:
-    // world_x: starts at -half (left edge) and increases with x
-    // world_y: starts at +half (top edge) and decreases with y (canvas y is inverted)
-    for (int y = 0; y < canvas.height; ++y) {
-        const auto world_y{half - pixel_size * static_cast<float>(y)};
-        for (int x = 0; x < canvas.width; ++x) {
-            const auto world_x{-half + pixel_size * static_cast<float>(x)};
-            Point position{.x = world_x, .y = world_y, .z = wall_z};
-            Ray r{ray_origin, Vector::normalize(Vector(position - ray_origin))};
-            auto xs{intersect(shape, r)};
+    const Camera camera{sphere_camera(canvas_pixels)};
+    std::vector<Ray> rays(canvas_pixels);
+    for (uint32_t y = 0; y < canvas.height; ++y) {
+        camera.rays_for_row(y, 0, rays);
+        for (uint32_t x = 0; x < canvas.width; ++x) {
+            auto xs{intersect(shape, rays[x])};
             if (hit(xs).has_value()) {
                 canvas.write_pixel(x, y, colour);
             }
@@ -142,26 +148,16 @@ void simulate_sphere() {
 void simulate_material_sphere() {
     using namespace raytracer;
     constexpr auto canvas_pixels{256u};
-    constexpr auto wall_size{7.f};
-    constexpr auto pixel_size{wall_size/canvas_pixels};
-    constexpr auto half{wall_size / 2};
     Canvas canvas{canvas_pixels, canvas_pixels};
     Sphere sphere = Sphere::make_sphere();
     sphere.material.colour = Colour(1, 0.2, 1);
-    constexpr auto wall_z{10.0f};
-
-    // camera(eye) is the origin of our rays
-    constexpr Point camera{0, 0, -5};
     constexpr PointLight point_light{{-10, 10, -10}, {1, 1, 1}};
-    // Convert canvas pixels to world coordinates:
-    // world_x: starts at -half (left edge) and increases with x
-    // world_y: starts at +half (top edge) and decreases with y (canvas y is inverted)
-    for (int y = 0; y < canvas.height; ++y) {
-        const auto world_y{half - pixel_size * static_cast<float>(y)};
-        for (int x = 0; x < canvas.width; ++x) {
-            const auto world_x{-half + pixel_size * static_cast<float>(x)};
-            Point p{.x = world_x, .y = world_y, .z = wall_z};
-            Ray r{camera, Vector::normalize(Vector(p - camera))};
+    const Camera camera{sphere_camera(canvas_pixels)};
+    std::vector<Ray> rays(canvas_pixels);
+    for (uint32_t y = 0; y < canvas.height; ++y) {
+        camera.rays_for_row(y, 0, rays);
+        for (uint32_t x = 0; x < canvas.width; ++x) {
+            const Ray &r{rays[x]};
             auto xs{intersect(sphere, r)};
             if (hit(xs).has_value()) {
                 auto [object, t] = hit(xs).value();
@@ -175,3 +171,71 @@ void simulate_material_sphere() {
     }
     save_canvas(canvas, "material_sphere.ppm");
 }
+
+void simulate_poster_sphere() {
+    using namespace raytracer;
+    // the material sphere at poster resolution, written out in bands of 16 rows so only width * 16 pixels are ever
+    // held in memory
+    constexpr auto canvas_pixels{8192u};
+    constexpr auto band_rows{16u};
+    Sphere sphere = Sphere::make_sphere();
+    sphere.material.colour = Colour(1, 0.2, 1);
+    constexpr PointLight point_light{{-10, 10, -10}, {1, 1, 1}};
+    const Camera camera{sphere_camera(canvas_pixels)};
+
+    const auto shade = [&](const uint32_t x, const uint32_t y) {
+        const Ray r{camera.ray_for_pixel(x, y)};
+        if (const auto xs{intersect(sphere, r)}; hit(xs).has_value()) {
+            auto [object, t] = hit(xs).value();
+            Point point = position(r, t);
+            return lighting(object.material, point_light, point, -r.direction, normal_at(object, point));
+        }
+        return Colour{0, 0, 0};
+    };
+    const std::string filename{"poster_sphere.ppm"};
+    if (stream_render(filename, canvas_pixels, canvas_pixels, band_rows, shade, PpmFormat::binary).has_value()) {
+        std::cout << "Data written to " << filename << "\n";
+    } else {
+        std::cout << "Cannot write file " << filename << "\n";
+    }
+}
+
+void simulate_orbiting_light() {
+    using namespace raytracer;
+    // a turntable of the material sphere with the light circling it; each frame is handed to the writer thread and
+    // encoded while the next one renders
+    constexpr auto frames{60u};
+    constexpr auto canvas_pixels{256u};
+    Sphere sphere = Sphere::make_sphere();
+    sphere.material.colour = Colour(1, 0.2, 1);
+    const Camera camera{sphere_camera(canvas_pixels)};
+    std::vector<Ray> rays(canvas_pixels);
+
+    AsyncImageWriter writer{canvas_pixels, canvas_pixels};
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        const auto angle{2 * std::numbers::pi_v<float> * static_cast<float>(frame) / frames};
+        const PointLight point_light{{-10 * std::cos(angle), 10, -10 * std::sin(angle)}, {1, 1, 1}};
+        // buffers come back from the pool with an earlier frame in them, so every pixel is written
+        Canvas canvas{writer.acquire()};
+        for (uint32_t y = 0; y < canvas.height; ++y) {
+            camera.rays_for_row(y, 0, rays);
+            for (uint32_t x = 0; x < canvas.width; ++x) {
+                const Ray &r{rays[x]};
+                Colour pixel_colour{0, 0, 0};
+                if (const auto xs{intersect(sphere, r)}; hit(xs).has_value()) {
+                    auto [object, t] = hit(xs).value();
+                    Point point = position(r, t);
+                    pixel_colour = lighting(object.material, point_light, point, -r.direction,
+                                            normal_at(object, point));
+                }
+                canvas.write_pixel(x, y, pixel_colour);
+            }
+        }
+        writer.submit(std::move(canvas), std::format("orbit_{:03}.png", frame));
+    }
+    if (writer.flush().has_value()) {
+        std::cout << writer.frames_written() << " frames written to orbit_*.png\n";
+    } else {
+        std::cout << "Cannot write some of the orbit_*.png frames\n";
+    }
+}
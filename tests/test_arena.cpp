@@ -0,0 +1,105 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Arena.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace raytracer;
+
+namespace {
+    // counts what reaches the global allocator through it
+    class CountingResource final : public std::pmr::memory_resource {
+    public:
+        size_t allocations{0};
+        size_t live{0};
+
+    private:
+        void *do_allocate(const size_t bytes, const size_t alignment) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, const size_t bytes, const size_t alignment) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override { return this == &other; }
+    };
+}
+
+SCENARIO("Allocating from an arena") {
+    CountingResource upstream;
+    GIVEN("An arena with small blocks") {
+        Arena arena{256, &upstream};
+        THEN("allocations are aligned and laid out one after another") {
+            void *a{arena.allocate(3, 1)};
+            void *b{arena.allocate(8, 8)};
+            void *c{arena.allocate(32, 32)};
+            REQUIRE(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+            REQUIRE(reinterpret_cast<uintptr_t>(c) % 32 == 0);
+            REQUIRE(static_cast<std::byte *>(b) > static_cast<std::byte *>(a));
+            REQUIRE(static_cast<std::byte *>(c) > static_cast<std::byte *>(b));
+            REQUIRE(upstream.allocations == 1);
+        }
+        THEN("requests bigger than a block get a block of their own") {
+            REQUIRE(arena.allocate(10000, 16) != nullptr);
+            REQUIRE(arena.capacity() >= 10000);
+            REQUIRE(arena.bytes_used() >= 10000);
+        }
+        WHEN("a frame's worth of data has been allocated once") {
+            const auto frame{[&arena] {
+                for (int ray = 0; ray < 100; ++ray) {
+                    std::pmr::vector<float> hits{&arena};
+                    for (int i = 0; i < 20; ++i) {
+                        hits.push_back(static_cast<float>(i));
+                    }
+                }
+            }};
+            frame();
+            const size_t warmed_up{upstream.allocations};
+            arena.reset();
+            REQUIRE(arena.bytes_used() == 0);
+            THEN("later frames reuse the blocks without going upstream") {
+                for (int i = 0; i < 10; ++i) {
+                    frame();
+                    arena.reset();
+                }
+                REQUIRE(upstream.allocations == warmed_up);
+            }
+            THEN("releasing hands every block back") {
+                arena.release();
+                REQUIRE(upstream.live == 0);
+                REQUIRE(arena.capacity() == 0);
+            }
+        }
+        THEN("a scope gives back what was allocated inside it") {
+            REQUIRE(arena.allocate(100, 8) != nullptr);
+            const size_t before{arena.bytes_used()};
+            {
+                const ArenaScope tile{arena};
+                for (int i = 0; i < 50; ++i) {
+                    REQUIRE(arena.allocate(64, 8) != nullptr);
+                }
+                {
+                    const ArenaScope ray{arena};
+                    REQUIRE(arena.allocate(1000, 8) != nullptr);
+                }
+                REQUIRE(arena.bytes_used() > before);
+            }
+            REQUIRE(arena.bytes_used() == before);
+        }
+    }
+    THEN("every thread has an arena of its own") {
+        Arena *other{nullptr};
+        std::jthread{[&other] { other = &thread_arena(); }}.join();
+        REQUIRE(other != &thread_arena());
+    }
+}
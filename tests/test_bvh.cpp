@@ -0,0 +1,367 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Bvh.hpp"
+#include "CompiledScene.hpp"
+#include "DynamicScene.hpp"
+#include "ImageDiff.hpp"
+#include "MatrixImpl.hpp"
+#include "ObjectRegistry.hpp"
+#include "Render.hpp"
+#include "SceneGenerator.hpp"
+#include "SceneGraph.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace raytracer;
+
+namespace {
+    bool contains(const Bounds &outer, const Bounds &inner) {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+               outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+    }
+
+    // how often each primitive is reached from the root, checking every node encloses its children on the way
+    void count_reached(const Bvh &bvh, const std::span<const Bounds> bounds, const uint32_t node,
+                       std::vector<uint32_t> &reached) {
+        const BvhNode &n{bvh.nodes[node]};
+        if (n.is_leaf()) {
+            for (uint32_t i = n.first; i < n.first + n.count; ++i) {
+                REQUIRE(contains(n.bounds, bounds[bvh.indices[i]]));
+                ++reached[bvh.indices[i]];
+            }
+            return;
+        }
+        REQUIRE(contains(n.bounds, bvh.nodes[n.first].bounds));
+        REQUIRE(contains(n.bounds, bvh.nodes[n.first + 1].bounds));
+        count_reached(bvh, bounds, n.first, reached);
+        count_reached(bvh, bounds, n.first + 1, reached);
+    }
+}
+
+SCENARIO("Building a BVH") {
+    GIVEN("The bounds of a few thousand clustered spheres and a few that cannot be hit") {
+        const CompiledScene compiled{CompiledScene::compile(generate_scene({
+            .count = 3000, .seed = 5, .distribution = Distribution::clustered
+        }).value())};
+        std::vector<Bounds> bounds(compiled.bounds().begin(), compiled.bounds().end());
+        bounds[10] = Bounds{};
+        bounds[2000] = Bounds{};
+        ThreadPool serial{{.threads = 0}};
+        ThreadPool pool{{.threads = 4}};
+        WHEN("it is built") {
+            const Bvh bvh{build_bvh(bounds, {.pool = &serial})};
+            THEN("every primitive that can be hit is in exactly one leaf, inside every box above it") {
+                std::vector<uint32_t> reached(bounds.size());
+                count_reached(bvh, bounds, 0, reached);
+                for (size_t i = 0; i < reached.size(); ++i) {
+                    REQUIRE(reached[i] == (bounds[i].empty() ? 0 : 1));
+                }
+                REQUIRE(bvh.indices.size() == bounds.size() - 2);
+            }
+            THEN("it reports its shape and cost") {
+                REQUIRE(bvh.stats.node_count == bvh.nodes.size());
+                REQUIRE(bvh.stats.leaf_count == (bvh.nodes.size() + 1) / 2);
+                REQUIRE(bvh.stats.max_leaf_size <= 4);
+                REQUIRE(bvh.stats.depth > 10);
+                REQUIRE(bvh.stats.depth < 40);
+                // far cheaper than testing every sphere, which is what a single leaf would cost
+                REQUIRE(bvh.stats.sah_cost < 100);
+                REQUIRE(bvh.stats.build_ms >= 0);
+            }
+            THEN("building in parallel gives the same tree") {
+                const Bvh parallel{build_bvh(bounds, {.pool = &pool, .parallel_threshold = 64})};
+                REQUIRE(parallel.stats.sah_cost == bvh.stats.sah_cost);
+                REQUIRE(parallel.stats.node_count == bvh.stats.node_count);
+                REQUIRE(parallel.stats.depth == bvh.stats.depth);
+                REQUIRE(parallel.stats.leaf_count == bvh.stats.leaf_count);
+            }
+        }
+        THEN("a depth limit is respected") {
+            const Bvh shallow{build_bvh(bounds, {.pool = &serial, .max_depth = 5})};
+            REQUIRE(shallow.stats.depth == 6);
+        }
+    }
+    GIVEN("Primitives that all sit in the same place") {
+        const std::vector<Bounds> bounds(100, Bounds{{-1, -1, -1}, {1, 1, 1}});
+        const Bvh bvh{build_bvh(bounds)};
+        THEN("they are still split into small leaves") {
+            REQUIRE(bvh.stats.max_leaf_size <= 4);
+            REQUIRE(bvh.indices.size() == 100);
+        }
+    }
+    GIVEN("Boxes spaced ever further apart along a line, which two bins peel off one at a time") {
+        std::vector<Bounds> bounds;
+        for (int i = 0; i < 200; ++i) {
+            const float x{std::ldexp(1.0f, i - 100)};
+            bounds.push_back(Bounds{{x, -1, -1}, {x, 1, 1}});
+        }
+        const Bvh bvh{build_bvh(bounds, {.bins = 2, .max_leaf_size = 1, .max_depth = 1000})};
+        THEN("the tree stops at the depth traversal can follow and a ray through all of them meets every one") {
+            REQUIRE(bvh.stats.depth == bvh_stack_depth + 1);
+            size_t met{0};
+            const float nearest_t{std::numeric_limits<float>::infinity()};
+            traverse_bvh(bvh.nodes, Ray{Point{-1, 0, 0}, Vector{1, 0, 0}}, nearest_t,
+                         [&met](uint32_t, const uint32_t count) { met += count; });
+            REQUIRE(met == bounds.size());
+        }
+    }
+    GIVEN("Nothing that can be hit") {
+        const std::vector<Bounds> bounds(3);
+        THEN("the tree is empty") {
+            REQUIRE(build_bvh(bounds).nodes.empty());
+            REQUIRE(build_bvh({}).nodes.empty());
+        }
+    }
+}
+
+SCENARIO("Rendering through a BVH") {
+    GIVEN("A generated scene of overlapping and scattered spheres") {
+        for (const auto distribution: {Distribution::uniform, Distribution::clustered, Distribution::overlapping}) {
+            const Scene scene{generate_scene({
+                .count = 400, .seed = 11, .distribution = distribution, .width = 64, .height = 48
+            }).value()};
+            THEN("every pixel matches testing every sphere") {
+                // a depth limit of 0 leaves everything in the root, which is a loop over every sphere
+                const CompiledScene linear{CompiledScene::compile(scene, {}, {.max_depth = 0})};
+                REQUIRE(linear.bvh_stats().node_count == 1);
+                REQUIRE(render(CompiledScene::compile(scene)).storage == render(linear).storage);
+            }
+        }
+    }
+    GIVEN("A cache whose tree points outside its own arrays") {
+        const auto cache_path{std::filesystem::temp_directory_path() / "raytracer_bvh.cache"};
+        const CompiledScene compiled{CompiledScene::compile(generate_scene({.count = 20}).value())};
+        const auto &header{compiled.header()};
+        // a link past the last node, and the root as its own child
+        for (const uint32_t first: {header.bvh_node_count, 0u}) {
+            std::vector<std::byte> bytes(compiled.bytes().begin(), compiled.bytes().end());
+            reinterpret_cast<BvhNode *>(bytes.data() + header.bvh_nodes_offset)->first = first;
+            std::ofstream(cache_path, std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()),
+                                                             static_cast<std::streamsize>(bytes.size()));
+            THEN("it is rejected") {
+                REQUIRE(CompiledScene::map(cache_path.string()).error() == SceneCacheError::malformed);
+            }
+        }
+        std::filesystem::remove(cache_path);
+    }
+}
+
+SCENARIO("Refitting a BVH") {
+    GIVEN("A tree over a few thousand spheres, some of which then move") {
+        const CompiledScene compiled{CompiledScene::compile(generate_scene({.count = 3000, .seed = 9}).value())};
+        std::vector<Bounds> bounds(compiled.bounds().begin(), compiled.bounds().end());
+        Bvh bvh{build_bvh(bounds)};
+        const BvhLinks links{bvh_links(bvh, bounds.size())};
+        std::vector<uint32_t> moved;
+        for (uint32_t i = 0; i < bounds.size(); i += 97) {
+            bounds[i].min.x += 3;
+            bounds[i].max.x += 3;
+            moved.push_back(i);
+        }
+        WHEN("only what is above them is refitted") {
+            const uint32_t refitted{refit_bvh(bvh, links, bounds, moved)};
+            THEN("every box is what refitting the whole tree gives") {
+                Bvh whole{bvh};
+                refit_bvh(whole, bounds);
+                for (size_t node = 0; node < bvh.nodes.size(); ++node) {
+                    REQUIRE(bvh.nodes[node].bounds == whole.nodes[node].bounds);
+                }
+                std::vector<uint32_t> reached(bounds.size());
+                count_reached(bvh, bounds, 0, reached);
+            }
+            THEN("far fewer boxes than the whole tree are recomputed") {
+                REQUIRE(refitted > moved.size());
+                REQUIRE(refitted < bvh.nodes.size() / 4);
+            }
+        }
+    }
+}
+
+SCENARIO("Rendering a scene whose objects move") {
+    GIVEN("A generated scene with one sphere that cannot be hit yet") {
+        Scene scene{generate_scene({.count = 400, .seed = 13, .width = 64, .height = 48}).value()};
+        scene.spheres[7].set_transform(scale(0.0, 0.0, 0.0));
+        DynamicScene dynamic{std::move(scene)};
+        THEN("it starts out with nothing to update") {
+            const SceneUpdate update{dynamic.update()};
+            REQUIRE(update.moved == 0);
+            REQUIRE(update.nodes_refit == 0);
+            REQUIRE_FALSE(update.rebuilt);
+        }
+        THEN("an object moved twice before an update is placed once") {
+            dynamic.set_transform(3, translation(1.0, 0.0, 0.0));
+            dynamic.set_transform(3, translation(2.0, 0.0, 0.0));
+            REQUIRE(dynamic.update().moved == 1);
+            REQUIRE(dynamic.update().moved == 0);
+        }
+        WHEN("some spheres are moved") {
+            for (size_t i = 0; i < dynamic.object_count(); i += 20) {
+                dynamic.set_transform(i, multiply(translation(0.5, -0.25, 0.0), dynamic.object(i).transform));
+            }
+            const SceneUpdate update{dynamic.update()};
+            THEN("the tree is refitted above them and the frame matches compiling the moved scene afresh") {
+                REQUIRE(update.moved == 20);
+                REQUIRE_FALSE(update.rebuilt);
+                REQUIRE(update.nodes_refit < dynamic.bvh_nodes().size());
+                REQUIRE(render(dynamic).storage == render(CompiledScene::compile(dynamic.scene())).storage);
+            }
+            THEN("rebuilding gives a tree no worse than the refitted one") {
+                const float refitted_cost{dynamic.bvh_stats().sah_cost};
+                dynamic.rebuild();
+                REQUIRE(dynamic.bvh_stats().sah_cost <= refitted_cost);
+                REQUIRE(render(dynamic).storage == render(CompiledScene::compile(dynamic.scene())).storage);
+            }
+        }
+        WHEN("two spheres are given the same material") {
+            const size_t before{dynamic.materials().size()};
+            dynamic.set_material(1, Material{.colour = Colour{0, 1, 0}});
+            dynamic.set_material(2, Material{.colour = Colour{0, 1, 0}});
+            THEN("it is stored once and both refer to it") {
+                REQUIRE(dynamic.materials().size() == before + 1);
+                REQUIRE(dynamic.object_materials()[1] == dynamic.object_materials()[2]);
+                REQUIRE(dynamic.shading_table().material_count() == before + 1);
+            }
+        }
+        WHEN("a sphere's material is changed") {
+            dynamic.set_material(3, Material{.colour = Colour{1, 0, 0}});
+            THEN("the next frame shows it without an update") {
+                REQUIRE(dynamic.material(3) == dynamic.scene().spheres[3].material);
+                REQUIRE(dynamic.materials()[dynamic.object_materials()[3]] == dynamic.material(3));
+                REQUIRE(render(dynamic).storage == render(CompiledScene::compile(dynamic.scene())).storage);
+            }
+        }
+        WHEN("the sphere that could not be hit is given a size") {
+            dynamic.set_transform(7, translation(0.0, 0.0, 2.0));
+            const SceneUpdate update{dynamic.update()};
+            THEN("the tree is rebuilt to take it in") {
+                REQUIRE(update.moved == 1);
+                REQUIRE(update.rebuilt);
+                REQUIRE(dynamic.bvh_indices().size() == dynamic.object_count());
+                REQUIRE(render(dynamic).storage == render(CompiledScene::compile(dynamic.scene())).storage);
+            }
+        }
+    }
+}
+
+SCENARIO("Moving groups of objects") {
+    GIVEN("A generated scene with every other sphere in a group and one in a group inside that") {
+        Scene scene{generate_scene({.count = 400, .seed = 13, .width = 64, .height = 48}).value()};
+        DynamicScene dynamic{scene};
+        const Canvas before{render(dynamic)};
+        SceneGraph &groups{dynamic.groups()};
+        const uint32_t group{groups.add_group(SceneGraph::root).value()};
+        const uint32_t inner{groups.add_group(group, Matrix4::from(translation(0.0, 1.0, 0.0))).value()};
+        for (size_t i = 0; i < dynamic.object_count(); i += 2) {
+            dynamic.attach(i, group);
+        }
+        dynamic.attach(1, inner);
+        THEN("an unmoved group leaves its objects where they were") {
+            dynamic.groups().set_transform(inner, Matrix4{});
+            const SceneUpdate update{dynamic.update()};
+            REQUIRE(update.groups_moved == 2);
+            REQUIRE(update.moved == 201);
+            REQUIRE(render(dynamic).storage == before.storage);
+        }
+        WHEN("the outer group is moved") {
+            groups.set_transform(group, Matrix4::from(translation(0.5, -0.25, 0.0)));
+            const SceneUpdate update{dynamic.update()};
+            THEN("its world transform and those below it are recomposed and its objects placed again") {
+                REQUIRE(update.groups_moved == 2);
+                REQUIRE(update.moved == 201);
+                REQUIRE(groups.world_transform(inner).m[7] == 0.75f);
+                REQUIRE(groups.inverse_world_transform(inner).m[3] == -0.5f);
+                REQUIRE(dynamic.update().moved == 0);
+            }
+            THEN("the frame matches moving each sphere by itself") {
+                for (size_t i = 0; i < scene.spheres.size(); ++i) {
+                    Sphere &sphere{scene.spheres[i]};
+                    if (i == 1) {
+                        sphere.set_transform(multiply(translation(0.5, 0.75, 0.0), sphere.transform));
+                    } else if (i % 2 == 0) {
+                        sphere.set_transform(multiply(translation(0.5, -0.25, 0.0), sphere.transform));
+                    }
+                }
+                // composed in float rather than in double, so only the odd pixel on an edge may differ
+                const auto diff{compare(render(CompiledScene::compile(scene)), render(dynamic))};
+                REQUIRE(diff.has_value());
+                REQUIRE(diff->differing_pixels < 64 * 48 / 100);
+                REQUIRE(diff->rmse < 2);
+            }
+        }
+        THEN("a group cannot be added under one that does not exist yet") {
+            REQUIRE(groups.add_group(inner + 1).error() == SceneGraphError::unknown_parent);
+            REQUIRE(groups.group_count() == 3);
+        }
+        WHEN("a group is given a singular transform") {
+            groups.set_transform(inner, Matrix4::from(scale(0.0, 0.0, 0.0)));
+            dynamic.update();
+            THEN("its objects can no longer be hit") {
+                REQUIRE(dynamic.bounds()[1].empty());
+                REQUIRE(dynamic.inverse_transforms()[1] == Matrix4{.m = {}});
+            }
+        }
+    }
+}
+
+SCENARIO("Registering scene objects") {
+    GIVEN("A registry with room for 1000 objects") {
+        ObjectRegistry registry{1000};
+        WHEN("ids are asked for from many tasks at once") {
+            std::vector<std::atomic<uint32_t>> handed_out(1000);
+            ThreadPool pool{{.threads = 4}};
+            pool.parallel_for(0, 500, 1, [&](const size_t first, const size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    const auto id{registry.add(i % 2 == 0 ? 1 : 3)};
+                    if (id.has_value()) {
+                        for (uint32_t j = 0; j < (i % 2 == 0 ? 1u : 3u); ++j) {
+                            ++handed_out[id.value() + j];
+                        }
+                    }
+                }
+            });
+            THEN("every id is handed out exactly once, with none past the room there is") {
+                REQUIRE(registry.size() <= 1000);
+                REQUIRE(registry.size() >= 998);
+                for (size_t id = 0; id < registry.size(); ++id) {
+                    REQUIRE(handed_out[id] == 1);
+                }
+                REQUIRE(registry.add(3).error() == RegistryError::full);
+            }
+        }
+        WHEN("objects are placed") {
+            const uint32_t first{registry.add(2).value()};
+            registry.place(first, translation(1.0, 2.0, 3.0));
+            registry.place(first + 1, scale(0.0, 1.0, 1.0));
+            registry.set_material(first, 5);
+            THEN("their data is found by id") {
+                REQUIRE(registry.inverse_transforms().size() == 2);
+                REQUIRE(registry.inverse_transforms()[first].transform_point(Point{1, 2, 3}) == Point{0, 0, 0});
+                REQUIRE(registry.bounds()[first].min == Point{0, 1, 2});
+                REQUIRE(registry.bounds()[first + 1].empty());
+                REQUIRE(registry.materials()[first] == 5);
+            }
+        }
+    }
+    GIVEN("Spheres made on several threads") {
+        std::vector<uint32_t> ids(2000);
+        ThreadPool pool{{.threads = 4}};
+        pool.parallel_for(0, ids.size(), 1, [&ids](const size_t first, const size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                ids[i] = Sphere::make_sphere().id;
+            }
+        });
+        THEN("no two share an id") {
+            std::ranges::sort(ids);
+            REQUIRE(std::ranges::adjacent_find(ids) == ids.end());
+        }
+    }
+}
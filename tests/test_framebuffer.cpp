@@ -0,0 +1,89 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "Framebuffer.hpp"
+#include "Colour.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <cmath>
+
+using namespace raytracer;
+
+SCENARIO("Writing pixels to a canvas") {
+    GIVEN("A 10x20 canvas") {
+        Canvas canvas{10, 20};
+        WHEN("a red pixel is written at (2, 3)") {
+            canvas.write_pixel(2, 3, Colour{1, 0, 0});
+            THEN("only that pixel changes") {
+                REQUIRE(canvas.pixel(2, 3)[0] == 255);
+                REQUIRE(canvas.pixel(2, 3)[1] == 0);
+                REQUIRE(canvas.pixel(2, 3)[2] == 0);
+                REQUIRE(canvas.pixel(3, 2)[0] == 0);
+                REQUIRE(canvas.row(3)[2 * Canvas::channels] == 255);
+            }
+        }
+    }
+}
+
+TEST_CASE("Accumulation buffer") {
+    AccumulationBuffer buffer{4, 2};
+    Canvas canvas{4, 2};
+
+    SECTION("Samples are averaged when resolved") {
+        buffer.add_sample(1, 1, Colour{1.0f, 0.5f, 0.0f});
+        buffer.add_sample(1, 1, Colour{0.0f, 0.5f, 1.0f});
+        REQUIRE(buffer.samples[5] == 2);
+        REQUIRE(resolve(buffer, ToneMap{.transfer = TransferFunction::linear}, canvas).has_value());
+        REQUIRE(canvas.pixel(1, 1)[0] == 127);
+        REQUIRE(canvas.pixel(1, 1)[1] == 127);
+        REQUIRE(canvas.pixel(1, 1)[2] == 127);
+        REQUIRE(canvas.pixel(0, 0)[0] == 0);
+    }
+
+    SECTION("The linear transfer matches write_pixel") {
+        const Colour colour{0.66f, 1.5f, -0.2f};
+        buffer.add_sample(3, 0, colour);
+        REQUIRE(resolve(buffer, ToneMap{.transfer = TransferFunction::linear}, canvas).has_value());
+        Canvas expected{4, 2};
+        expected.write_pixel(3, 0, colour);
+        REQUIRE(canvas.storage == expected.storage);
+    }
+
+    SECTION("The sRGB transfer is within one step of the exact curve") {
+        for (uint32_t x = 0; x < 4; ++x) {
+            buffer.add_sample(x, 0, Colour{0.001f * static_cast<float>(x), 0.2f, 0.8f});
+        }
+        REQUIRE(resolve(buffer, ToneMap{}, canvas).has_value());
+        const auto encode = [](const double linear) {
+            return 255.0 * (linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055);
+        };
+        for (uint32_t x = 0; x < 4; ++x) {
+            REQUIRE(std::abs(canvas.pixel(x, 0)[0] - encode(0.001 * x)) <= 1.0);
+            REQUIRE(std::abs(canvas.pixel(x, 0)[1] - encode(0.2)) <= 1.0);
+            REQUIRE(std::abs(canvas.pixel(x, 0)[2] - encode(0.8)) <= 1.0);
+        }
+    }
+
+    SECTION("Exposure scales radiance before quantisation") {
+        buffer.add_sample(0, 0, Colour{0.25f, 0.25f, 0.25f});
+        REQUIRE(resolve(buffer, ToneMap{.exposure = 4.0f, .transfer = TransferFunction::linear}, canvas).has_value());
+        REQUIRE(canvas.pixel(0, 0)[0] == 255);
+    }
+
+    SECTION("Clearing resets radiance and sample counts") {
+        buffer.add_sample(0, 0, Colour{1, 1, 1});
+        buffer.clear();
+        REQUIRE(buffer.samples[0] == 0);
+        REQUIRE(buffer.r[0] == 0.0f);
+    }
+
+    SECTION("Resolving into a canvas of a different size fails") {
+        Canvas wrong{2, 2};
+        const auto result{resolve(buffer, ToneMap{}, wrong)};
+        REQUIRE_FALSE(result.has_value());
+        REQUIRE(result.error() == CanvasError::dimension_mismatch);
+    }
+}
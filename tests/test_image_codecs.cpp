@@ -0,0 +1,210 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "Deflate.hpp"
+#include "ImageCodecs.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+using namespace raytracer;
+
+namespace {
+    std::span<const uint8_t> bytes_of(const std::string_view text) {
+        return {reinterpret_cast<const uint8_t *>(text.data()), text.size()};
+    }
+
+    // flat background, a gradient disc and some noise, so every encoder path gets exercised
+    Canvas test_image(const uint32_t width, const uint32_t height) {
+        Canvas canvas{width, height};
+        uint32_t noise{12345};
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                const float dx{(static_cast<float>(x) - width / 2.0f) / (width / 3.0f)};
+                const float dy{(static_cast<float>(y) - height / 2.0f) / (height / 3.0f)};
+                const float d{dx * dx + dy * dy};
+                noise = noise * 1103515245u + 12345u;
+                const float grain{y > height * 3 / 4 ? static_cast<float>(noise >> 24) / 255.0f : 0.0f};
+                canvas.write_pixel(x, y, d < 1 ? Colour{1 - d, 0.2f, d} : Colour{grain, 0.1f, 0.1f});
+            }
+        }
+        return canvas;
+    }
+}
+
+TEST_CASE("Checksums") {
+    SECTION("CRC-32 of the standard check string") {
+        REQUIRE(crc32(bytes_of("123456789")) == 0xCBF43926);
+    }
+
+    SECTION("Adler-32 of a known string") {
+        REQUIRE(adler32(bytes_of("Wikipedia")) == 0x11E60398);
+    }
+
+    SECTION("Combining Adler-32 checksums of two halves") {
+        const auto whole{bytes_of("The quick brown fox jumps over the lazy dog")};
+        const auto first{whole.first(17)};
+        const auto second{whole.subspan(17)};
+        REQUIRE(adler32_combine(adler32(first), adler32(second), second.size()) == adler32(whole));
+    }
+}
+
+SCENARIO("Deflating and inflating data") {
+    GIVEN("Repetitive input with some noise") {
+        std::vector<uint8_t> input;
+        uint32_t noise{7};
+        for (size_t i = 0; i < 200000; ++i) {
+            noise = noise * 1103515245u + 12345u;
+            input.push_back(i % 5 == 0 ? static_cast<uint8_t>(noise >> 24) : static_cast<uint8_t>(i / 300 % 13));
+        }
+        WHEN("it is compressed as a single segment") {
+            std::vector<uint8_t> compressed;
+            deflate(input, DeflateEnd::final, compressed);
+            THEN("it shrinks and inflates back unchanged") {
+                REQUIRE(compressed.size() < input.size() / 2);
+                REQUIRE(inflate(compressed).value() == input);
+            }
+        }
+        WHEN("it is compressed as independent segments that are concatenated") {
+            std::vector<uint8_t> compressed;
+            const std::span<const uint8_t> all{input};
+            deflate(all.first(70000), DeflateEnd::sync, compressed);
+            deflate(all.subspan(70000, 70000), DeflateEnd::sync, compressed);
+            deflate(all.subspan(140000), DeflateEnd::final, compressed);
+            THEN("the result is one valid stream") {
+                REQUIRE(inflate(compressed).value() == input);
+            }
+        }
+    }
+
+    GIVEN("Empty input") {
+        std::vector<uint8_t> compressed;
+        deflate({}, DeflateEnd::final, compressed);
+        THEN("the stream inflates to nothing") {
+            REQUIRE(inflate(compressed).value().empty());
+        }
+    }
+
+    GIVEN("A truncated stream") {
+        std::vector<uint8_t> compressed;
+        deflate(bytes_of("hello hello hello hello"), DeflateEnd::final, compressed);
+        compressed.resize(compressed.size() / 2);
+        THEN("inflating fails") {
+            REQUIRE_FALSE(inflate(compressed).has_value());
+        }
+    }
+}
+
+SCENARIO("Encoding PNG images") {
+    const Canvas canvas{test_image(97, 61)};
+
+    GIVEN("A canvas encoded on one thread") {
+        ThreadPool serial{{.threads = 0}};
+        const auto png{encode_png(canvas, {.pool = &serial})};
+        THEN("it starts with the PNG signature and IHDR") {
+            REQUIRE(png.size() > 33);
+            REQUIRE(png[0] == 0x89);
+            REQUIRE(std::string_view{reinterpret_cast<const char *>(png.data()) + 12, 4} == "IHDR");
+        }
+        THEN("it decodes to the same pixels") {
+            REQUIRE(decode_png(png).value().storage == canvas.storage);
+        }
+        THEN("it is a fraction of the size of the raw pixels") {
+            REQUIRE(png.size() < canvas.storage.size() / 2);
+        }
+    }
+
+    GIVEN("A canvas split into many chunks across threads") {
+        ThreadPool pool{{.threads = 4}};
+        const auto png{encode_png(canvas, {.pool = &pool, .chunk_bytes = 1000})};
+        THEN("the stitched stream decodes to the same pixels") {
+            const auto decoded{decode_png(png)};
+            REQUIRE(decoded.has_value());
+            REQUIRE(decoded->width == canvas.width);
+            REQUIRE(decoded->height == canvas.height);
+            REQUIRE(decoded->storage == canvas.storage);
+        }
+    }
+
+    GIVEN("A corrupted file") {
+        auto png{encode_png(canvas)};
+        png[40] ^= 0xFF;
+        THEN("decoding reports it") {
+            REQUIRE(decode_png(png).error() == CanvasError::malformed);
+        }
+    }
+}
+
+SCENARIO("Encoding QOI images") {
+    const Canvas canvas{test_image(97, 61)};
+
+    GIVEN("A canvas encoded as a single chunk") {
+        const auto qoi{encode_qoi(canvas, {.chunk_bytes = canvas.storage.size()})};
+        THEN("it has the QOI header and end marker") {
+            REQUIRE(std::string_view{reinterpret_cast<const char *>(qoi.data()), 4} == "qoif");
+            REQUIRE(qoi[12] == 3);
+            REQUIRE(qoi.back() == 1);
+        }
+        THEN("it decodes to the same pixels") {
+            REQUIRE(decode_qoi(qoi).value().storage == canvas.storage);
+        }
+    }
+
+    GIVEN("A canvas split into chunks that break runs and index state") {
+        ThreadPool pool{{.threads = 3}};
+        const auto qoi{encode_qoi(canvas, {.pool = &pool, .chunk_bytes = 3 * 37})};
+        THEN("the concatenated chunks decode to the same pixels") {
+            REQUIRE(decode_qoi(qoi).value().storage == canvas.storage);
+        }
+    }
+
+    GIVEN("A uniform canvas") {
+        const Canvas flat{64, 64};
+        THEN("runs longer than a single op are split correctly") {
+            const auto qoi{encode_qoi(flat, {.chunk_bytes = 3 * 1000})};
+            REQUIRE(qoi.size() < 200);
+            REQUIRE(decode_qoi(qoi).value().storage == flat.storage);
+        }
+    }
+
+    GIVEN("A canvas of two colours in long stripes, in chunks shorter than a stripe") {
+        Canvas stripes{64, 64};
+        for (uint32_t y = 0; y < stripes.height; ++y) {
+            for (uint32_t x = 0; x < stripes.width; ++x) {
+                stripes.write_pixel(x, y, y / 4 % 2 == 0 ? Colour{1, 0.5, 0} : Colour{0, 0.25, 1});
+            }
+        }
+        THEN("a colour from before a chunk's window is written out rather than referred to by index") {
+            const auto qoi{encode_qoi(stripes, {.chunk_bytes = 3 * 50})};
+            REQUIRE(decode_qoi(qoi).value().storage == stripes.storage);
+        }
+    }
+}
+
+SCENARIO("Saving images by file extension") {
+    const Canvas canvas{test_image(16, 9)};
+    const auto directory{std::filesystem::temp_directory_path()};
+
+    THEN("the format follows the extension") {
+        REQUIRE(image_format_for("render.png") == ImageFormat::png);
+        REQUIRE(image_format_for("render.QOI") == ImageFormat::qoi);
+        REQUIRE(image_format_for("render.ppm") == ImageFormat::ppm);
+        REQUIRE(image_format_for("render") == ImageFormat::ppm);
+    }
+
+    WHEN("a canvas is saved as PNG") {
+        const auto path{directory / "raytracer_saved.png"};
+        REQUIRE(save_image(canvas, path.string()).has_value());
+        THEN("the file holds the encoded image") {
+            std::ifstream in(path, std::ios::binary);
+            const std::vector<uint8_t> contents{std::istreambuf_iterator<char>(in), {}};
+            REQUIRE(decode_png(contents).value().storage == canvas.storage);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "ImageDiff.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <cmath>
+
+using namespace raytracer;
+
+SCENARIO("Comparing images") {
+    GIVEN("Two identical canvases") {
+        Canvas a{33, 17};
+        a.write_pixel(3, 4, Colour{0.5, 0.25, 1});
+        const Canvas b{a};
+        THEN("there is no error and the PSNR is infinite") {
+            const auto stats{compare(a, b).value()};
+            REQUIRE(stats.max_abs_error == 0);
+            REQUIRE(stats.rmse == 0.0);
+            REQUIRE(std::isinf(stats.psnr));
+            REQUIRE(stats.differing_pixels == 0);
+        }
+    }
+
+    GIVEN("Canvases that differ in two pixels") {
+        Canvas a{40, 40};
+        Canvas b{40, 40};
+        // 10 steps in one channel of one pixel and 20 in all channels of another, past the first block boundary
+        a.storage[0] = 10;
+        b.storage[3 * 1500] = 20;
+        b.storage[3 * 1500 + 1] = 20;
+        b.storage[3 * 1500 + 2] = 20;
+        WHEN("they are compared") {
+            const auto stats{compare(a, b).value()};
+            THEN("the statistics reflect both differences") {
+                const double mse{(10.0 * 10.0 + 3 * 20.0 * 20.0) / static_cast<double>(a.storage.size())};
+                REQUIRE(stats.max_abs_error == 20);
+                REQUIRE(stats.differing_pixels == 2);
+                REQUIRE(std::abs(stats.rmse - std::sqrt(mse)) < 1e-9);
+                REQUIRE(std::abs(stats.psnr - 10.0 * std::log10(255.0 * 255.0 / mse)) < 1e-9);
+            }
+        }
+        WHEN("a diff image is made with a gain") {
+            const auto diff{diff_image(a, b, 8).value()};
+            THEN("differences are amplified and clamped") {
+                REQUIRE(diff.storage[0] == 80);
+                REQUIRE(diff.storage[3 * 1500] == 160);
+                REQUIRE(diff.storage[1] == 0);
+            }
+        }
+    }
+
+    GIVEN("Canvases of different sizes") {
+        THEN("they cannot be compared") {
+            REQUIRE(compare(Canvas{2, 2}, Canvas{2, 3}).error() == CanvasError::dimension_mismatch);
+            REQUIRE(diff_image(Canvas{2, 2}, Canvas{3, 2}).error() == CanvasError::dimension_mismatch);
+        }
+    }
+}
@@ -0,0 +1,362 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Canvas.hpp"
+#include "ScanlineWriter.hpp"
+#include "MappedCanvas.hpp"
+#include "Framebuffer.hpp"
+#include "AsyncImageWriter.hpp"
+#include "ImageCodecs.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace raytracer;
+
+namespace {
+    std::string read_file(const std::filesystem::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    Colour gradient(const uint32_t x, const uint32_t y) {
+        return Colour{static_cast<float>(x) / 4.0f, static_cast<float>(y) / 8.0f, 0.5f};
+    }
+}
+
+SCENARIO("Writing a canvas as PPM") {
+    GIVEN("A 5x3 canvas with a few pixels set") {
+        Canvas canvas{5, 3};
+        canvas.write_pixel(0, 0, Colour{1.5, 0, 0});
+        canvas.write_pixel(2, 1, Colour{0, 0.5, 0});
+        canvas.write_pixel(4, 2, Colour{-0.5, 0, 1});
+        const auto path{std::filesystem::temp_directory_path() / "raytracer_canvas.ppm"};
+        WHEN("it is written in the ascii format") {
+            REQUIRE(canvas_to_ppm(canvas, path.string()).has_value());
+            THEN("the header is followed by one pixel per line") {
+                const std::string contents{read_file(path)};
+                REQUIRE(contents.starts_with("P3\n5 3\n255\n255 0 0\n0 0 0\n"));
+                REQUIRE(contents.find("\n0 127 0\n") != std::string::npos);
+                REQUIRE(contents.ends_with("\n0 0 255\n"));
+            }
+        }
+        WHEN("it is written in the binary format") {
+            REQUIRE(canvas_to_ppm(canvas, path.string(), PpmFormat::binary).has_value());
+            THEN("the header is followed by the packed pixel bytes") {
+                const std::string header{ppm_header(PpmFormat::binary, 5, 3)};
+                const std::string contents{read_file(path)};
+                REQUIRE(contents.size() == header.size() + canvas.storage.size());
+                REQUIRE(contents.starts_with("P6\n5 3\n255\n"));
+                REQUIRE(std::equal(canvas.storage.begin(), canvas.storage.end(),
+                                   reinterpret_cast<const uint8_t *>(contents.data() + header.size())));
+            }
+        }
+    }
+
+    GIVEN("A path that cannot be opened") {
+        const Canvas canvas{1, 1};
+        THEN("an error is reported") {
+            const auto result{canvas_to_ppm(canvas, "/nonexistent-directory/out.ppm")};
+            REQUIRE_FALSE(result.has_value());
+            REQUIRE(result.error() == CanvasError::invalid_path);
+        }
+    }
+}
+
+SCENARIO("Streaming scanlines to a PPM file") {
+    const auto streamed_path{std::filesystem::temp_directory_path() / "raytracer_streamed.ppm"};
+    const auto canvas_path{std::filesystem::temp_directory_path() / "raytracer_whole.ppm"};
+    Canvas whole{4, 7};
+    for (uint32_t y = 0; y < whole.height; ++y) {
+        for (uint32_t x = 0; x < whole.width; ++x) {
+            whole.write_pixel(x, y, gradient(x, y));
+        }
+    }
+
+    GIVEN("A band height that does not divide the image height") {
+        WHEN("the image is rendered through the stream") {
+            const auto result{stream_render(streamed_path.string(), 4, 7, 3, gradient, PpmFormat::binary)};
+            REQUIRE(result.has_value());
+            THEN("the file matches writing the whole canvas at once") {
+                REQUIRE(canvas_to_ppm(whole, canvas_path.string(), PpmFormat::binary).has_value());
+                REQUIRE(read_file(streamed_path) == read_file(canvas_path));
+            }
+        }
+        WHEN("the image is streamed in the ascii format") {
+            REQUIRE(stream_render(streamed_path.string(), 4, 7, 3, gradient).has_value());
+            THEN("the file matches writing the whole canvas at once") {
+                REQUIRE(canvas_to_ppm(whole, canvas_path.string()).has_value());
+                REQUIRE(read_file(streamed_path) == read_file(canvas_path));
+            }
+        }
+    }
+
+    GIVEN("A writer for a 4x7 image") {
+        auto writer{ScanlineWriter::open(streamed_path.string(), 4, 7)};
+        REQUIRE(writer.has_value());
+        WHEN("fewer rows than the image height are written") {
+            REQUIRE(writer->write_band(Canvas{4, 5}).has_value());
+            THEN("finishing reports the image as incomplete") {
+                REQUIRE(writer->rows_written() == 5);
+                REQUIRE(writer->finish().error() == CanvasError::incomplete);
+            }
+        }
+        WHEN("a band of the wrong width is written") {
+            THEN("it is rejected") {
+                REQUIRE(writer->write_band(Canvas{3, 1}).error() == CanvasError::dimension_mismatch);
+            }
+        }
+        WHEN("more rows than the image height are written") {
+            THEN("the overflowing band is rejected") {
+                REQUIRE(writer->write_band(Canvas{4, 8}).error() == CanvasError::dimension_mismatch);
+                REQUIRE(writer->rows_written() == 0);
+            }
+        }
+    }
+
+    GIVEN("An image with no columns") {
+        const auto nothing = [](uint32_t, uint32_t) { return Colour{0, 0, 0}; };
+        THEN("it streams to the same file as the canvas in either format") {
+            for (const PpmFormat format: {PpmFormat::ascii, PpmFormat::binary}) {
+                REQUIRE(stream_render(streamed_path.string(), 0, 7, 3, nothing, format).has_value());
+                REQUIRE(canvas_to_ppm(Canvas{0, 7}, canvas_path.string(), format).has_value());
+                REQUIRE(read_file(streamed_path) == read_file(canvas_path));
+            }
+        }
+        THEN("every row is written from the start and only empty bands fit") {
+            auto writer{ScanlineWriter::open(streamed_path.string(), 0, 7)};
+            REQUIRE(writer.has_value());
+            REQUIRE(writer->write_band(std::span<const uint8_t>{}).has_value());
+            REQUIRE(writer->write_band(Canvas{1, 1}).error() == CanvasError::dimension_mismatch);
+            REQUIRE(writer->finish().has_value());
+        }
+    }
+
+    GIVEN("A window of no rows") {
+        const auto nothing = [](uint32_t, uint32_t) { return Colour{0, 0, 0}; };
+        THEN("the render is refused rather than never getting past the first band") {
+            REQUIRE(stream_render(streamed_path.string(), 4, 7, 0, nothing).error() == CanvasError::dimension_mismatch);
+        }
+    }
+}
+
+SCENARIO("Rendering into a memory-mapped canvas") {
+    const auto mapped_path{std::filesystem::temp_directory_path() / "raytracer_mapped.ppm"};
+    const auto canvas_path{std::filesystem::temp_directory_path() / "raytracer_unmapped.ppm"};
+    Canvas expected{4, 7};
+    for (uint32_t y = 0; y < expected.height; ++y) {
+        for (uint32_t x = 0; x < expected.width; ++x) {
+            expected.write_pixel(x, y, gradient(x, y));
+        }
+    }
+    REQUIRE(canvas_to_ppm(expected, canvas_path.string(), PpmFormat::binary).has_value());
+
+    GIVEN("A mapped canvas") {
+        auto mapped{MappedCanvas::create(mapped_path.string(), 4, 7)};
+        REQUIRE(mapped.has_value());
+        WHEN("several threads write interleaved rows") {
+            std::vector<std::thread> workers;
+            for (uint32_t worker = 0; worker < 3; ++worker) {
+                workers.emplace_back([&mapped, worker] {
+                    for (uint32_t y = worker; y < mapped->height; y += 3) {
+                        for (uint32_t x = 0; x < mapped->width; ++x) {
+                            mapped->write_pixel(x, y, gradient(x, y));
+                        }
+                    }
+                });
+            }
+            for (auto &thread: workers) {
+                thread.join();
+            }
+            REQUIRE(mapped->flush().has_value());
+            THEN("the file is the same binary PPM canvas_to_ppm writes") {
+                REQUIRE(read_file(mapped_path) == read_file(canvas_path));
+            }
+        }
+        WHEN("an accumulation buffer is resolved into the mapping") {
+            AccumulationBuffer buffer{4, 7};
+            for (uint32_t y = 0; y < buffer.height; ++y) {
+                for (uint32_t x = 0; x < buffer.width; ++x) {
+                    buffer.add_sample(x, y, gradient(x, y));
+                }
+            }
+            REQUIRE(resolve(buffer, ToneMap{.transfer = TransferFunction::linear}, mapped->pixels()).has_value());
+            MappedCanvas moved{std::move(mapped.value())};
+            THEN("the file is complete once the canvas is released") {
+                moved = std::move(MappedCanvas::create((mapped_path.string() + ".other"), 1, 1).value());
+                REQUIRE(read_file(mapped_path) == read_file(canvas_path));
+            }
+        }
+    }
+
+    GIVEN("A path that cannot be created") {
+        THEN("an error is reported") {
+            REQUIRE(MappedCanvas::create("/nonexistent-directory/out.ppm", 1, 1).error() ==
+                    CanvasError::invalid_path);
+        }
+    }
+}
+
+SCENARIO("Reading PPM files") {
+    const auto path{std::filesystem::temp_directory_path() / "raytracer_read.ppm"};
+    Canvas canvas{6, 4};
+    for (uint32_t y = 0; y < canvas.height; ++y) {
+        for (uint32_t x = 0; x < canvas.width; ++x) {
+            canvas.write_pixel(x, y, gradient(x, y));
+        }
+    }
+
+    GIVEN("A canvas written in either format") {
+        THEN("reading it back gives the same pixels") {
+            REQUIRE(canvas_to_ppm(canvas, path.string()).has_value());
+            REQUIRE(ppm_to_canvas(path.string()).value().storage == canvas.storage);
+            REQUIRE(canvas_to_ppm(canvas, path.string(), PpmFormat::binary).has_value());
+            REQUIRE(ppm_to_canvas(path.string()).value().storage == canvas.storage);
+        }
+    }
+
+    GIVEN("A P3 file with comments, free-form whitespace and a smaller maximum value") {
+        const std::string text{"P3\n# written by hand\n2 1 # width height\n15\n15 0 0   7\n\n0 15\n"};
+        const auto parsed{parse_ppm({reinterpret_cast<const uint8_t *>(text.data()), text.size()})};
+        THEN("the values are rescaled to 8 bits") {
+            REQUIRE(parsed.has_value());
+            REQUIRE(parsed->width == 2);
+            REQUIRE(parsed->height == 1);
+            REQUIRE(parsed->storage == std::vector<uint8_t>{255, 0, 0, 119, 0, 255});
+        }
+    }
+
+    GIVEN("Malformed input") {
+        const auto parse = [](const std::string &text) {
+            return parse_ppm({reinterpret_cast<const uint8_t *>(text.data()), text.size()});
+        };
+        THEN("it is rejected") {
+            REQUIRE(parse("P5\n1 1\n255\n0").error() == CanvasError::malformed);
+            REQUIRE(parse("P3\n2 1\n255\n1 2 3 4 5").error() == CanvasError::malformed);
+            REQUIRE(parse("P3\n1 1\n255\n1 2 300").error() == CanvasError::malformed);
+            REQUIRE(parse("P6\n2 2\n255\nabc").error() == CanvasError::malformed);
+        }
+        THEN("a header asking for more pixels than the input holds is rejected before anything is allocated") {
+            REQUIRE(parse("P6 4000000000 4000000000 255 ").error() == CanvasError::malformed);
+            REQUIRE(parse("P3 4000000000 4000000000 255 1 2 3").error() == CanvasError::malformed);
+            REQUIRE(parse("P3\n2 1\n255\n1 2 3 4 5 6").has_value());
+        }
+    }
+
+    GIVEN("A missing file") {
+        THEN("it is reported as an invalid path") {
+            REQUIRE(ppm_to_canvas("/nonexistent-directory/in.ppm").error() == CanvasError::invalid_path);
+        }
+    }
+}
+
+SCENARIO("Writing frames on a background thread") {
+    GIVEN("A writer with two 4x8 buffers") {
+        AsyncImageWriter writer{4, 8, 2};
+        const auto directory{std::filesystem::temp_directory_path()};
+        WHEN("several frames are rendered and submitted") {
+            for (uint32_t frame = 0; frame < 5; ++frame) {
+                Canvas canvas{writer.acquire()};
+                for (uint32_t y = 0; y < canvas.height; ++y) {
+                    for (uint32_t x = 0; x < canvas.width; ++x) {
+                        canvas.write_pixel(x, y, Colour{static_cast<float>(frame) / 4.0f, 0, 0});
+                    }
+                }
+                writer.submit(std::move(canvas), (directory / ("raytracer_frame_" + std::to_string(frame) + ".png")).
+                              string());
+            }
+            THEN("every frame is on disk with its own contents once flushed") {
+                REQUIRE(writer.flush().has_value());
+                REQUIRE(writer.frames_written() == 5);
+                for (uint32_t frame = 0; frame < 5; ++frame) {
+                    const auto path{directory / ("raytracer_frame_" + std::to_string(frame) + ".png")};
+                    const auto loaded{load_image(path.string())};
+                    REQUIRE(loaded.has_value());
+                    REQUIRE(loaded->pixel(3, 7)[0] == to_byte(static_cast<float>(frame) / 4.0f));
+                    std::filesystem::remove(path);
+                }
+            }
+        }
+        WHEN("both buffers are held by the renderer") {
+            Canvas first{writer.acquire()};
+            Canvas second{writer.acquire()};
+            auto third{std::async(std::launch::async, [&writer] { return writer.acquire(); })};
+            THEN("acquiring another waits until one has been written") {
+                REQUIRE(third.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+                const auto path{directory / "raytracer_frame_held.ppm"};
+                writer.submit(std::move(first), path.string());
+                REQUIRE(third.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+                REQUIRE(third.get().width == 4);
+                REQUIRE(writer.flush().has_value());
+                std::filesystem::remove(path);
+            }
+        }
+        WHEN("a frame cannot be written") {
+            writer.submit(writer.acquire(), "/nonexistent-directory/frame.ppm");
+            THEN("flush reports it and the buffer is still returned to the pool") {
+                const auto flushed{writer.flush()};
+                REQUIRE_FALSE(flushed.has_value());
+                REQUIRE(flushed.error() == CanvasError::invalid_path);
+                REQUIRE(writer.frames_written() == 0);
+                REQUIRE(writer.acquire().height == 8);
+                REQUIRE(writer.flush().has_value());
+            }
+        }
+    }
+}
+
+SCENARIO("Tiled canvas layout") {
+    GIVEN("The same gradient drawn into a linear and a tiled 37x21 canvas") {
+        Canvas linear{37, 21};
+        Canvas tiled{37, 21, PixelLayout::tiled};
+        for (uint32_t y = 0; y < 21; ++y) {
+            for (uint32_t x = 0; x < 37; ++x) {
+                const Colour colour{static_cast<float>(x) / 37.0f, static_cast<float>(y) / 21.0f, 0.25f};
+                linear.write_pixel(x, y, colour);
+                tiled.write_pixel(x, y, colour);
+            }
+        }
+        THEN("storage is padded to whole tiles") {
+            REQUIRE(tiled.tiles_x() == 3);
+            REQUIRE(tiled.tiles_y() == 2);
+            REQUIRE(tiled.storage.size() == 3 * 2 * 16 * 16 * Canvas::channels);
+        }
+        THEN("every pixel reads back the same") {
+            for (uint32_t y = 0; y < 21; ++y) {
+                for (uint32_t x = 0; x < 37; ++x) {
+                    REQUIRE(std::ranges::equal(linear.pixel(x, y), tiled.pixel(x, y)));
+                }
+            }
+        }
+        THEN("a tile holds its pixels contiguously, row by row") {
+            const auto tile{tiled.tile(2, 1)};
+            REQUIRE(tile.size() == 16 * 16 * Canvas::channels);
+            // pixel (36, 20) is column 4, row 4 of tile (2, 1)
+            const auto expected{linear.pixel(36, 20)};
+            REQUIRE(std::ranges::equal(tile.subspan((4 * 16 + 4) * Canvas::channels, Canvas::channels), expected));
+        }
+        THEN("converting between layouts round trips") {
+            REQUIRE(convert_layout(tiled, PixelLayout::linear).storage == linear.storage);
+            REQUIRE(convert_layout(linear, PixelLayout::tiled).storage == tiled.storage);
+        }
+        THEN("the encoders write identical files") {
+            const auto path{std::filesystem::temp_directory_path() / "raytracer_tiled.ppm"};
+            REQUIRE(canvas_to_ppm(linear, path.string(), PpmFormat::binary).has_value());
+            const auto from_linear{read_file(path)};
+            REQUIRE(canvas_to_ppm(tiled, path.string(), PpmFormat::binary).has_value());
+            REQUIRE(read_file(path) == from_linear);
+            REQUIRE(encode_png(tiled) == encode_png(linear));
+            REQUIRE(encode_qoi(tiled) == encode_qoi(linear));
+            std::filesystem::remove(path);
+        }
+    }
+}
@@ -6,6 +6,8 @@
 #include "Point.hpp"
 #include "Colour.hpp"
 
+#include <vector>
+
 #include "catch2/catch_test_macros.hpp"
 
 using namespace raytracer;
@@ -23,3 +25,28 @@ SCENARIO("A point light has a position and intensity") {
         }
     }
 }
+
+SCENARIO("A set of lights is kept a column per component, brightest first") {
+    GIVEN("Three lights of different brightness") {
+        const std::vector<PointLight> lights{
+            {Point{1, 2, 3}, Colour{0.2, 0.1, 0.1}},
+            {Point{4, 5, 6}, Colour{0.1, 0.9, 0.3}},
+            {Point{7, 8, 9}, Colour{0.5, 0.5, 0.5}}
+        };
+        WHEN("they are put in a set") {
+            const LightSet set{LightSet::from(lights)};
+            THEN("they come out brightest channel first with their positions and intensities") {
+                REQUIRE(set.size() == 3);
+                REQUIRE(set.light(0).position == lights[1].position);
+                REQUIRE(set.light(0).intensity == lights[1].intensity);
+                REQUIRE(set.light(1).position == lights[2].position);
+                REQUIRE(set.light(2).position == lights[0].position);
+                REQUIRE(set.brightness[0] == 0.9f);
+                REQUIRE(set.brightness[2] == 0.2f);
+            }
+            THEN("their total intensity is kept for the ambient term") {
+                REQUIRE(areAlmostEqual(set.total_intensity, Colour{0.8, 1.5, 0.9}));
+            }
+        }
+    }
+}
@@ -10,7 +10,10 @@
 
 #include "catch2/catch_test_macros.hpp"
 
+#include <array>
+#include <cmath>
 #include <numbers>
+#include <vector>
 
 using namespace raytracer;
 
@@ -51,3 +54,129 @@ TEST_CASE("Materials") {
         REQUIRE(areAlmostEqual(result, Colour{0.1, 0.1, 0.1}));
     }
 }
+
+TEST_CASE("Batched lighting") {
+    const std::array<Material, 3> materials{
+        Material{}, Material{.colour = Colour{1, 0.2, 1}, .ambient = 0.2, .shininess = 1000},
+        Material{.colour = Colour{0.1, 0.5, 0.9}, .specular = 0.3, .shininess = 3}
+    };
+    const PointLight light{Point{-10, 10, -10}, Colour{1, 0.8, 0.6}};
+
+    SECTION("Every lane matches the scalar path to within the tolerance, and lanes past count are left alone") {
+        ShadingBatch batch;
+        std::array<Colour, ShadingBatch::width> expected{};
+        // points on a unit sphere around the origin seen from an eye at (0, 0, -5), turning away from the light
+        for (uint32_t i = 0; i + 3 < ShadingBatch::width; ++i) {
+            const float angle{static_cast<float>(i) * 0.45f};
+            const Point point{std::sin(angle), 0.3f, -std::cos(angle)};
+            const Vector normal{Vector::normalize(point - Point{0, 0, 0})};
+            const Vector eye{Vector::normalize(Point{0, 0, -5} - point)};
+            expected[i] = lighting(materials[i % 3], light, point, eye, normal);
+            batch.add(point, normal, eye, i % 3);
+        }
+        ColourBatch colours;
+        colours.r.back() = 7;
+        lighting(materials, light, batch, colours);
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            REQUIRE(std::abs(colours.r[i] - expected[i].r) < 1e-4f);
+            REQUIRE(std::abs(colours.g[i] - expected[i].g) < 1e-4f);
+            REQUIRE(std::abs(colours.b[i] - expected[i].b) < 1e-4f);
+        }
+        REQUIRE(colours.r.back() == 7);
+        REQUIRE(colours.g.back() == 0);
+    }
+
+    SECTION("The fast power stays within its relative error") {
+        for (const float shininess: {1.0f, 10.0f, 200.0f, 1000.0f}) {
+            for (float x = 0.001f; x <= 1; x += 0.0137f) {
+                const double exact{std::pow(static_cast<double>(x), static_cast<double>(shininess))};
+                if (exact > 1e-30) {
+                    REQUIRE(std::abs(fast_pow(x, shininess) - exact) <= 2e-5 * exact);
+                }
+            }
+            REQUIRE(fast_pow(1, shininess) == 1);
+        }
+    }
+}
+
+TEST_CASE("Lighting from many lights") {
+    const Material material{.colour = Colour{1, 0.5, 0.2}, .shininess = 20};
+    // around the point, some in front of the surface and some behind it, and a few far too dim to matter
+    std::vector<PointLight> lights;
+    for (uint32_t i = 0; i < 24; ++i) {
+        const float angle{static_cast<float>(i) * 0.7f};
+        const float brightness{i % 6 == 5 ? 1e-4f : 0.1f + 0.03f * static_cast<float>(i)};
+        lights.push_back({Point{5 * std::sin(angle), 2 * std::cos(angle), -5 * std::cos(angle)},
+                          Colour{brightness, brightness * 0.5f, brightness}});
+    }
+    const LightSet set{LightSet::from(lights)};
+    const Point point{0, 0, 0};
+    const Vector normal{0, 0, -1};
+    const Vector eye{Vector::normalize(Vector{0.3, 0.2, -1})};
+    Colour expected{0, 0, 0};
+    for (const auto &light: lights) {
+        expected = expected + lighting(material, light, point, eye, normal);
+    }
+
+    SECTION("With no cutoff it is the sum of every light's lighting()") {
+        const Colour colour{lighting(material, set, point, eye, normal)};
+        REQUIRE(std::abs(colour.r - expected.r) < 1e-5f);
+        REQUIRE(std::abs(colour.g - expected.g) < 1e-5f);
+        REQUIRE(std::abs(colour.b - expected.b) < 1e-5f);
+    }
+
+    SECTION("A cutoff leaves out no more than it bounds each light by") {
+        constexpr float cutoff{1e-3f};
+        const Colour colour{lighting(material, set, point, eye, normal, cutoff)};
+        // four dim lights, each below the cutoff
+        REQUIRE(colour.r <= expected.r);
+        REQUIRE(expected.r - colour.r < 4 * cutoff);
+        REQUIRE(expected.b - colour.b < 4 * cutoff);
+        const Colour none{lighting(material, set, point, eye, normal, 100)};
+        REQUIRE(areAlmostEqual(none, material.colour * set.total_intensity * material.ambient));
+    }
+
+    SECTION("The batched form matches it lane by lane") {
+        const std::array<Material, 2> materials{material, Material{}};
+        ShadingBatch batch;
+        std::array<Colour, ShadingBatch::width> scalar{};
+        for (uint32_t i = 0; i + 5 < ShadingBatch::width; ++i) {
+            const float angle{static_cast<float>(i) * 0.4f};
+            const Point lane_point{std::sin(angle), 0, -std::cos(angle)};
+            const Vector lane_normal{Vector::normalize(lane_point - Point{0, 0, 0})};
+            const Vector lane_eye{Vector::normalize(Point{0, 0, -5} - lane_point)};
+            scalar[i] = lighting(materials[i % 2], set, lane_point, lane_eye, lane_normal);
+            batch.add(lane_point, lane_normal, lane_eye, i % 2);
+        }
+        ColourBatch colours;
+        lighting(materials, set, batch, colours);
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            REQUIRE(std::abs(colours.r[i] - scalar[i].r) < 1e-3f);
+            REQUIRE(std::abs(colours.g[i] - scalar[i].g) < 1e-3f);
+            REQUIRE(std::abs(colours.b[i] - scalar[i].b) < 1e-3f);
+        }
+        REQUIRE(colours.r[batch.count] == 0);
+
+        const ShadingTable table{ShadingTable::build(materials, set)};
+        REQUIRE(table.material_count() == 2);
+        REQUIRE(table.diffuse_r.size() == 2 * lights.size());
+        ColourBatch from_table;
+        lighting(table, batch, from_table);
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            REQUIRE(std::abs(from_table.r[i] - colours.r[i]) < 1e-5f);
+            REQUIRE(std::abs(from_table.g[i] - colours.g[i]) < 1e-5f);
+            REQUIRE(std::abs(from_table.b[i] - colours.b[i]) < 1e-5f);
+        }
+        REQUIRE(from_table.r[batch.count] == 0);
+
+        // too many entries for per-light columns: the same products, multiplied per lane
+        const ShadingTable per_lane{ShadingTable::build(materials, set, 2 * lights.size() - 1)};
+        REQUIRE_FALSE(per_lane.per_light());
+        REQUIRE(per_lane.diffuse_r.empty());
+        ColourBatch from_per_lane;
+        lighting(per_lane, batch, from_per_lane);
+        REQUIRE(from_per_lane.r == from_table.r);
+        REQUIRE(from_per_lane.g == from_table.g);
+        REQUIRE(from_per_lane.b == from_table.b);
+    }
+}
@@ -0,0 +1,218 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "CompiledScene.hpp"
+#include "InstancedScene.hpp"
+#include "MatrixImpl.hpp"
+#include "Mesh.hpp"
+#include "ObjLoader.hpp"
+#include "Render.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <string>
+
+using namespace raytracer;
+
+namespace {
+    // a closed sphere of triangles around the origin: bands of latitude split into quads, two triangles each
+    Mesh tessellated_sphere(const uint32_t bands) {
+        Mesh mesh;
+        const auto pi{std::numbers::pi_v<float>};
+        for (uint32_t i = 0; i <= bands; ++i) {
+            for (uint32_t j = 0; j < 2 * bands; ++j) {
+                const float theta{pi * static_cast<float>(i) / static_cast<float>(bands)};
+                const float phi{pi * static_cast<float>(j) / static_cast<float>(bands)};
+                // exactly on the axis at the poles, so the last band closes
+                const float radius{i == 0 || i == bands ? 0.0f : std::sin(theta)};
+                mesh.add_vertex(Point{radius * std::cos(phi), std::cos(theta), radius * std::sin(phi)});
+            }
+        }
+        const auto at = [bands](const uint32_t i, const uint32_t j) { return i * 2 * bands + j % (2 * bands); };
+        for (uint32_t i = 0; i < bands; ++i) {
+            for (uint32_t j = 0; j < 2 * bands; ++j) {
+                mesh.add_triangle(at(i, j), at(i + 1, j), at(i + 1, j + 1));
+                mesh.add_triangle(at(i, j), at(i + 1, j + 1), at(i, j + 1));
+            }
+        }
+        return mesh;
+    }
+
+    // the same mesh written out as an OBJ, faces as quads with texture and normal numbers and negative corners
+    std::string quad_obj(const uint32_t size) {
+        std::string text{"# a grid\no grid\n"};
+        for (uint32_t y = 0; y <= size; ++y) {
+            for (uint32_t x = 0; x <= size; ++x) {
+                text += "v " + std::to_string(x) + " " + std::to_string(y) + " 0.5\n";
+            }
+            text += "vn 0 0 1\n";
+        }
+        const uint32_t row{size + 1};
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                const uint32_t corner{y * row + x + 1};
+                text += "f " + std::to_string(corner) + "/1/1 " + std::to_string(corner + 1) + "//1 " +
+                        std::to_string(corner + row + 1) + " " + std::to_string(corner + row) + "\n";
+            }
+        }
+        return text + "v 0 0 -1\nv 1 0 -1\nv 0 1 -1\nf -3 -2 -1\n";
+    }
+}
+
+SCENARIO("Intersecting a ray with triangles") {
+    GIVEN("A single triangle") {
+        Mesh mesh;
+        mesh.add_vertex(Point{0, 1, 0});
+        mesh.add_vertex(Point{-1, 0, 0});
+        mesh.add_vertex(Point{1, 0, 0});
+        mesh.add_triangle(0, 1, 2);
+        THEN("a ray through it hits it") {
+            const auto xs{intersect(mesh, Ray{Point{0, 0.5, -2}, Vector{0, 0, 1}})};
+            REQUIRE(xs.size() == 1);
+            REQUIRE(utils::equal(xs[0].t, 2.0f));
+            REQUIRE(hit(xs)->triangle == 0);
+        }
+        THEN("rays past each edge, parallel to it or from beyond it miss") {
+            REQUIRE(intersect(mesh, Ray{Point{1, 1, -2}, Vector{0, 0, 1}}).empty());
+            REQUIRE(intersect(mesh, Ray{Point{-1, 1, -2}, Vector{0, 0, 1}}).empty());
+            REQUIRE(intersect(mesh, Ray{Point{0, -1, -2}, Vector{0, 0, 1}}).empty());
+            REQUIRE(intersect(mesh, Ray{Point{0, -1, -2}, Vector{0, 1, 0}}).empty());
+            REQUIRE(intersect(mesh, Ray{Point{0, 0.5, 2}, Vector{0, 0, 1}}).empty());
+            REQUIRE_FALSE(hit(std::vector<TriangleIntersection>{}).has_value());
+        }
+        THEN("its normal follows the order of its corners") {
+            REQUIRE(normal_at(mesh, 0) == Vector{0, 0, 1});
+        }
+    }
+    GIVEN("A closed mesh") {
+        const Mesh mesh{tessellated_sphere(12)};
+        const MeshBvh bvh{build_mesh_bvh(mesh)};
+        THEN("rays from inside through vertices and along edges never slip between triangles") {
+            // every direction to a vertex passes exactly through the corners and edges shared by its triangles
+            for (uint32_t v = 0; v < mesh.vertex_count(); ++v) {
+                const Point target{mesh.vertex(v)};
+                const Ray ray{Point{0, 0, 0}, Vector{target.x, target.y, target.z}};
+                REQUIRE(hit(intersect(mesh, ray)).has_value());
+                REQUIRE(nearest_triangle(bvh.bvh.nodes, bvh.columns(), ray, INFINITY).t < INFINITY);
+            }
+        }
+        THEN("the tree finds the same nearest triangle as testing them all") {
+            for (int i = 0; i < 200; ++i) {
+                const float angle{static_cast<float>(i) * 0.31f};
+                const Ray ray{Point{3 * std::cos(angle), 0.01f * static_cast<float>(i) - 1, -3},
+                              Vector{-std::cos(angle), 0.2f, 1}};
+                const auto all{hit(intersect(mesh, ray))};
+                const TriangleIntersection nearest{nearest_triangle(bvh.bvh.nodes, bvh.columns(), ray, INFINITY)};
+                REQUIRE(all.has_value() == (nearest.t < INFINITY));
+                if (all.has_value()) {
+                    REQUIRE(nearest.t == all->t);
+                }
+            }
+        }
+        THEN("a shadow ray is blocked exactly when the nearest triangle is within its length") {
+            for (int i = 0; i < 200; ++i) {
+                const float angle{static_cast<float>(i) * 0.31f};
+                const Ray ray{Point{3 * std::cos(angle), 0.01f * static_cast<float>(i) - 1, -3},
+                              Vector{-std::cos(angle), 0.2f, 1}};
+                const float length{static_cast<float>(i % 5)};
+                const TriangleIntersection nearest{nearest_triangle(bvh.bvh.nodes, bvh.columns(), ray, INFINITY)};
+                REQUIRE(any_triangle(bvh.bvh.nodes, bvh.columns(), ray, length) == (nearest.t < length));
+            }
+        }
+    }
+}
+
+SCENARIO("Loading OBJ files") {
+    GIVEN("A grid of quads and a triangle with negative corners") {
+        const std::string text{quad_obj(30)};
+        const auto mesh{parse_obj(text)};
+        THEN("vertices and fan-split faces are read and everything else is skipped") {
+            REQUIRE(mesh.has_value());
+            REQUIRE(mesh->vertex_count() == 31 * 31 + 3);
+            REQUIRE(mesh->triangle_count() == 30 * 30 * 2 + 1);
+            REQUIRE(mesh->vertex(32) == Point{1, 1, 0.5});
+            REQUIRE(mesh->corner(0, 0) == Point{0, 0, 0.5});
+            REQUIRE(mesh->corner(0, 2) == Point{1, 1, 0.5});
+            REQUIRE(mesh->corner(1, 2) == Point{0, 1, 0.5});
+            const auto last{static_cast<uint32_t>(mesh->triangle_count() - 1)};
+            REQUIRE(mesh->corner(last, 0) == Point{0, 0, -1});
+            REQUIRE(mesh->corner(last, 2) == Point{0, 1, -1});
+        }
+        THEN("parsing in many small chunks gives the same mesh") {
+            ThreadPool pool{{.threads = 3}};
+            const auto chunked{parse_obj(text, {.pool = &pool, .chunk_bytes = 100})};
+            REQUIRE(chunked.has_value());
+            REQUIRE(chunked->x == mesh->x);
+            REQUIRE(chunked->y == mesh->y);
+            REQUIRE(chunked->z == mesh->z);
+            REQUIRE(chunked->triangles == mesh->triangles);
+        }
+        THEN("it loads from a file") {
+            const auto path{std::filesystem::temp_directory_path() / "raytracer_grid.obj"};
+            std::ofstream(path, std::ios::binary) << text;
+            const auto loaded{load_obj(path.string())};
+            REQUIRE(loaded.has_value());
+            REQUIRE(loaded->triangles == mesh->triangles);
+            std::filesystem::remove(path);
+            REQUIRE(load_obj(path.string()).error().error == ObjError::invalid_path);
+        }
+    }
+    GIVEN("Files with mistakes") {
+        const auto error = [](const std::string &text) {
+            return parse_obj(text, {.chunk_bytes = 8}).error();
+        };
+        THEN("the problem and its line are reported, whichever chunk it is in") {
+            const auto bad_number{error("v 0 0 0\nv 1 x 0\n")};
+            REQUIRE(bad_number.error == ObjError::invalid_number);
+            REQUIRE(bad_number.line == 2);
+            REQUIRE(error("v 0 0 0\nv 1 0 0\nf 1 2\n").line == 3);
+            REQUIRE(error("v 0 0 0\nv 1 0 0\nv 0 1 0\n\nf 1 2 4\n").line == 5);
+            REQUIRE(error("v 0 0 0\nv 1 0 0\nf -1 -2 -3\n").error == ObjError::invalid_face);
+            REQUIRE(error("v 0 0 0\nf 0 1 1\n").error == ObjError::invalid_face);
+        }
+    }
+}
+
+SCENARIO("Rendering meshes") {
+    GIVEN("Instances of a tessellated sphere among spheres") {
+        InstancedScene scene;
+        scene.camera = Camera{64, 48, std::numbers::pi / 3};
+        scene.camera.set_transform(view_transform(Point{0, 1, -6}, Point{0, 0, 0}, Vector{0, 1, 0}));
+        scene.lights.push_back(PointLight{Point{-10, 10, -10}, Colour{1, 1, 1}});
+        const uint32_t ball{scene.add_mesh(tessellated_sphere(16))};
+        for (int i = 0; i < 5; ++i) {
+            const auto x{static_cast<double>(i) * 1.2 - 2.4};
+            scene.add_instance(i % 2 == 0 ? ball : 0, scene.add_transform(Matrix4::from(
+                                   multiply(translation(x, 0.0, 0.0), scale(0.5, 0.5, 0.5)))),
+                               Material{.colour = Colour{0.2f * static_cast<float>(i), 1, 0.5}});
+        }
+        const CompiledScene compiled{CompiledScene::compile(scene)};
+        THEN("the meshes are drawn, lit like the spheres next to them") {
+            REQUIRE(compiled.header().triangle_count == 16 * 32 * 2);
+            const Canvas image{render(compiled)};
+            // the middle of the left hand ball and of the sphere next to it face the camera
+            const Colour ball_centre{colour_at(compiled, compiled.camera().ray_for_pixel(10, 24))};
+            const Colour sphere_centre{colour_at(compiled, compiled.camera().ray_for_pixel(21, 24))};
+            REQUIRE(ball_centre.g > 0.5f);
+            REQUIRE(sphere_centre.g > 0.5f);
+            REQUIRE(image.storage != Canvas{64, 48}.storage);
+        }
+        THEN("testing every triangle and object gives the same image") {
+            const CompiledScene linear{CompiledScene::compile(scene, {}, {.max_depth = 0})};
+            REQUIRE(render(linear).storage == render(compiled).storage);
+        }
+        THEN("a cache of it maps and renders the same") {
+            const auto cache_path{std::filesystem::temp_directory_path() / "raytracer_mesh.cache"};
+            REQUIRE(compiled.write(cache_path.string()).has_value());
+            const auto mapped{CompiledScene::map(cache_path.string())};
+            REQUIRE(mapped.has_value());
+            REQUIRE(render(mapped.value()).storage == render(compiled).storage);
+            std::filesystem::remove(cache_path);
+        }
+    }
+}
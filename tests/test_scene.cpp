@@ -0,0 +1,706 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "Bounds.hpp"
+#include "Camera.hpp"
+#include "CompiledScene.hpp"
+#include "ImageDiff.hpp"
+#include "InstancedScene.hpp"
+#include "MatrixImpl.hpp"
+#include "Render.hpp"
+#include "Scene.hpp"
+#include "SceneGenerator.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace raytracer;
+
+SCENARIO("Constructing a camera") {
+    GIVEN("A horizontal and a vertical canvas") {
+        const Camera horizontal{200, 125, std::numbers::pi / 2};
+        const Camera vertical{125, 200, std::numbers::pi / 2};
+        THEN("the pixel size covers the wider side") {
+            REQUIRE(utils::equal(static_cast<float>(horizontal.pixel_size), 0.01f));
+            REQUIRE(utils::equal(static_cast<float>(vertical.pixel_size), 0.01f));
+        }
+    }
+}
+
+SCENARIO("Casting rays from a camera") {
+    GIVEN("A 201x101 camera with a 90 degree field of view") {
+        Camera camera{201, 101, std::numbers::pi / 2};
+        THEN("the ray through the centre of the canvas points straight ahead") {
+            const Ray ray{camera.ray_for_pixel(100, 50)};
+            REQUIRE(ray.origin == Point(0, 0, 0));
+            REQUIRE(Vector::areAlmostEqual(ray.direction, Vector{0, 0, -1}));
+        }
+        THEN("the ray through a corner of the canvas points toward it") {
+            const Ray ray{camera.ray_for_pixel(0, 0)};
+            REQUIRE(utils::equal(ray.direction.x, 0.66519f, 1e-5f));
+            REQUIRE(utils::equal(ray.direction.y, 0.33259f, 1e-5f));
+            REQUIRE(utils::equal(ray.direction.z, -0.66851f, 1e-5f));
+        }
+        THEN("a ray through the corner of the first pixel points at the corner of the canvas") {
+            const Ray ray{camera.ray_for_pixel(0, 0, SubPixel{0, 0})};
+            const Vector corner{Vector::normalize(Vector{
+                static_cast<float>(camera.half_width), static_cast<float>(camera.half_height), -1
+            })};
+            REQUIRE(Vector::areAlmostEqual(ray.direction, corner));
+        }
+        WHEN("the camera is transformed") {
+            camera.set_transform(multiply(rotation_y(std::numbers::pi / 4), translation<double>(0, -2, 5)));
+            THEN("rays for a row, one at a time or in packets, are the rays for each of its pixels") {
+                std::vector<Ray> rays(150);
+                camera.rays_for_row(7, 40, rays);
+                RayPacket packet;
+                for (uint32_t x = 40; x < camera.hsize; x += RayPacket::width) {
+                    camera.packet_for_row(7, x, packet, SubPixel{0.25f, 0.75f});
+                    REQUIRE(packet.count == std::min(RayPacket::width, camera.hsize - x));
+                    for (uint32_t i = 0; i < packet.count; ++i) {
+                        const Ray expected{camera.ray_for_pixel(x + i, 7, SubPixel{0.25f, 0.75f})};
+                        REQUIRE(packet.ray(i).origin == expected.origin);
+                        REQUIRE(Vector::areAlmostEqual(packet.ray(i).direction, expected.direction));
+                    }
+                }
+                for (uint32_t i = 0; i < rays.size(); ++i) {
+                    const Ray expected{camera.ray_for_pixel(40 + i, 7)};
+                    REQUIRE(rays[i].origin == expected.origin);
+                    REQUIRE(Vector::areAlmostEqual(rays[i].direction, expected.direction));
+                }
+            }
+            THEN("rays start from the camera's position in the world") {
+                const Ray ray{camera.ray_for_pixel(100, 50)};
+                REQUIRE(utils::equal(ray.origin.y, 2, 1e-5f));
+                REQUIRE(utils::equal(ray.origin.z, -5, 1e-5f));
+                const float half_sqrt_2{std::numbers::sqrt2_v<float> / 2};
+                REQUIRE(Vector::areAlmostEqual(ray.direction, Vector{half_sqrt_2, 0, -half_sqrt_2}));
+            }
+            THEN("a transform that cannot be inverted is refused and the camera keeps the one it had") {
+                const Ray before{camera.ray_for_pixel(100, 50)};
+                REQUIRE_FALSE(camera.set_transform(scale(0.0, 1.0, 1.0)));
+                REQUIRE(camera.ray_for_pixel(100, 50).origin == before.origin);
+            }
+        }
+    }
+}
+
+SCENARIO("Jittering samples within a pixel") {
+    GIVEN("Sixteen samples of a pixel") {
+        std::array<uint32_t, 16> cells{};
+        for (uint32_t sample = 0; sample < 16; ++sample) {
+            const SubPixel offset{jitter(3, 5, sample)};
+            REQUIRE(offset.x >= 0);
+            REQUIRE(offset.x < 1);
+            REQUIRE(offset.y >= 0);
+            REQUIRE(offset.y < 1);
+            ++cells[static_cast<uint32_t>(offset.y * 4) * 4 + static_cast<uint32_t>(offset.x * 4)];
+        }
+        THEN("one falls in each cell of a 4x4 grid over the pixel, the same each time") {
+            REQUIRE(std::ranges::all_of(cells, [](const uint32_t count) { return count == 1; }));
+            REQUIRE(jitter(3, 5, 2).x == jitter(3, 5, 2).x);
+            REQUIRE(jitter(3, 5, 2).x != jitter(3, 5, 2, 1).x);
+            REQUIRE(jitter(3, 5, 2).x != jitter(4, 5, 2).x);
+        }
+    }
+}
+
+SCENARIO("The view transformation") {
+    THEN("looking down -z from the origin is the identity") {
+        REQUIRE(view_transform(Point(0, 0, 0), Point(0, 0, -1), Vector{0, 1, 0}) == Container<double>::identity(4));
+    }
+    THEN("looking down +z mirrors x and z") {
+        REQUIRE(view_transform(Point(0, 0, 0), Point(0, 0, 1), Vector{0, 1, 0}) == scale<double>(-1, 1, -1));
+    }
+    THEN("it moves the world, not the eye") {
+        REQUIRE(view_transform(Point(0, 0, 8), Point(0, 0, 0), Vector{0, 1, 0}) == translation<double>(0, 0, -8));
+    }
+}
+
+SCENARIO("Parsing scene files") {
+    GIVEN("A scene with every kind of entity") {
+        const std::string text{
+            "# comment on its own line\n"
+            "canvas 64 32\n"
+            "camera fov 1.5 from 0 0 -5 to 0 0 0 up 0 1 0 # trailing comment\n"
+            "light position -10 10 -10\n"
+            "light intensity 0.5 .25 1e-1 position 1 2 3\n"
+            "sphere\n"
+            "sphere scale 2 2 2 translation 0 1 0 rotation_z 1.5707963267948966\n"
+            "    colour 1 0.2 1 ambient 0.2 diffuse 0.7 specular 0.3 shininess 50\n"
+            "    reflective 0.5 transparency 0.25 refractive_index 1.5\n"
+            "sphere shearing 1 0 0 0 0 0 rotation_x 0.5 rotation_y -0.5\n"
+        };
+        WHEN("it is parsed") {
+            const auto scene{parse_scene(text)};
+            REQUIRE(scene.has_value());
+            THEN("the camera takes the canvas size and field of view") {
+                REQUIRE(scene->camera.hsize == 64);
+                REQUIRE(scene->camera.vsize == 32);
+                REQUIRE(scene->camera.field_of_view == 1.5);
+                REQUIRE(scene->camera.transform ==
+                        multiply(scale<double>(-1, 1, -1), translation<double>(0, 0, 5)));
+            }
+            THEN("lights default to white and attributes come in any order") {
+                REQUIRE(scene->lights.size() == 2);
+                REQUIRE(scene->lights[0].position == Point(-10, 10, -10));
+                REQUIRE(scene->lights[0].intensity == Colour(1, 1, 1));
+                REQUIRE(scene->lights[1].position == Point(1, 2, 3));
+                REQUIRE(areAlmostEqual(scene->lights[1].intensity, Colour(0.5, 0.25, 0.1)));
+            }
+            THEN("transforms compose in the order they are written") {
+                REQUIRE(scene->spheres.size() == 3);
+                REQUIRE(scene->spheres[0].transform == Container<double>::identity(4));
+                REQUIRE(scene->spheres[0].material == Material{});
+                REQUIRE(scene->spheres[1].transform ==
+                        multiply(rotation_z(std::numbers::pi / 2), multiply(translation<double>(0, 1, 0),
+                            scale<double>(2, 2, 2))));
+                REQUIRE(scene->spheres[2].transform ==
+                        multiply(rotation_y(-0.5), multiply(rotation_x(0.5), shearing(1, 0, 0, 0, 0, 0))));
+            }
+            THEN("material fields are read") {
+                const Material &material{scene->spheres[1].material};
+                REQUIRE(areAlmostEqual(material.colour, Colour(1, 0.2, 1)));
+                REQUIRE(material.ambient == 0.2f);
+                REQUIRE(material.diffuse == 0.7f);
+                REQUIRE(material.specular == 0.3f);
+                REQUIRE(material.shininess == 50.0f);
+                REQUIRE(material.reflective == 0.5f);
+                REQUIRE(material.transparency == 0.25f);
+                REQUIRE(material.refractive_index == 1.5f);
+            }
+        }
+    }
+    GIVEN("Scenes with mistakes") {
+        THEN("the error and its line are reported") {
+            const auto unknown{parse_scene("canvas 10 10\nsphere\n  radius 2\n")};
+            REQUIRE_FALSE(unknown.has_value());
+            REQUIRE(unknown.error().error == SceneError::unknown_keyword);
+            REQUIRE(unknown.error().line == 3);
+
+            const auto misplaced{parse_scene("light fov 1")};
+            REQUIRE_FALSE(misplaced.has_value());
+            REQUIRE(misplaced.error().error == SceneError::unknown_keyword);
+
+            const auto bad_number{parse_scene("sphere\ntranslation 1 2x 3")};
+            REQUIRE_FALSE(bad_number.has_value());
+            REQUIRE(bad_number.error().error == SceneError::invalid_number);
+            REQUIRE(bad_number.error().line == 2);
+
+            for (const char *const text: {"camera\ncanvas 1e10 1", "camera\ncanvas 5e9 5e9", "camera\ncanvas 10.5 10",
+                                          "camera\ncanvas 0 10", "camera\nfov 0", "camera\nfov 3.2",
+                                          "camera\nfov -1"}) {
+                const auto out_of_range{parse_scene(text)};
+                REQUIRE_FALSE(out_of_range.has_value());
+                REQUIRE(out_of_range.error().error == SceneError::invalid_number);
+                REQUIRE(out_of_range.error().line == 2);
+            }
+            REQUIRE(parse_scene("canvas 4294967295 1")->camera.hsize == 4294967295u);
+
+            for (const char *const text: {"canvas 10 10\ncamera from 1 2 3 to 1 2 3", "canvas 10 10\ncamera up 0 0 2",
+                                          "canvas 10 10\ncamera\nfrom 0 -5 0 to 0 0 0"}) {
+                const auto degenerate{parse_scene(text)};
+                REQUIRE_FALSE(degenerate.has_value());
+                REQUIRE(degenerate.error().error == SceneError::invalid_number);
+                REQUIRE(degenerate.error().line == 2);
+            }
+
+            const auto truncated{parse_scene("sphere colour 1 1")};
+            REQUIRE_FALSE(truncated.has_value());
+            REQUIRE(truncated.error().error == SceneError::unexpected_end);
+
+            REQUIRE(load_scene("/nonexistent-directory/scene.txt").error().error == SceneError::invalid_path);
+        }
+    }
+    GIVEN("Numbers in every form the parser accepts") {
+        const auto scene{parse_scene("sphere colour -0.5 +2.5e2 1.e-3 ambient 123456789012345678901234 "
+                                     "diffuse 3.14159265358979323846264338327950288")};
+        THEN("they read back as the nearest float") {
+            REQUIRE(scene.has_value());
+            const Material &material{scene->spheres[0].material};
+            REQUIRE(material.colour.r == -0.5f);
+            REQUIRE(material.colour.g == 250.0f);
+            REQUIRE(material.colour.b == 0.001f);
+            REQUIRE(material.ambient == 123456789012345678901234.0f);
+            REQUIRE(material.diffuse == std::numbers::pi_v<float>);
+        }
+    }
+}
+
+SCENARIO("Rendering a scene") {
+    GIVEN("The book's default world seen through an 11x11 camera") {
+        const auto scene{parse_scene(
+            "canvas 11 11 camera fov 1.5707963267948966 from 0 0 -5 to 0 0 0 up 0 1 0\n"
+            "light position -10 10 -10 intensity 1 1 1\n"
+            "sphere colour 0.8 1.0 0.6 diffuse 0.7 specular 0.2\n"
+            "sphere scale 0.5 0.5 0.5\n")};
+        REQUIRE(scene.has_value());
+        WHEN("it is rendered") {
+            ThreadPool pool{{.threads = 2}};
+            const Canvas image{render(scene.value(), RenderOptions{.pool = &pool, .tile_size = 4})};
+            THEN("the centre pixel matches the book") {
+                REQUIRE(image.width == 11);
+                REQUIRE(image.height == 11);
+                const auto centre{image.pixel(5, 5)};
+                REQUIRE(centre[0] == to_byte(0.38066f));
+                REQUIRE(centre[1] == to_byte(0.47583f));
+                REQUIRE(centre[2] == to_byte(0.2855f));
+            }
+            THEN("rays that miss everything are black") {
+                REQUIRE(image.pixel(0, 0)[0] == 0);
+                REQUIRE(colour_at(scene.value(), Ray{Point(0, 0, -5), Vector{0, 1, 0}}) == Colour(0, 0, 0));
+            }
+        }
+    }
+}
+
+SCENARIO("Inverting a fixed-size transform") {
+    GIVEN("A transform built from every kind of step") {
+        const Container<double> transform{
+            multiply(shearing(1, 0.5, 0, 0.25, 0, 0), multiply(rotation_x(0.7), multiply(translation<double>(1, -2, 3),
+                scale<double>(2, 3, 0.5))))
+        };
+        THEN("the closed form agrees with the general inverse") {
+            const auto inverted{invert(transform)};
+            REQUIRE(inverted.has_value());
+            const Matrix4 expected{Matrix4::from(inverse(transform).value())};
+            for (size_t i = 0; i < 16; ++i) {
+                REQUIRE(utils::equal(inverted->m[i], expected.m[i], 1e-5f));
+            }
+        }
+    }
+    THEN("a singular transform has no inverse") {
+        REQUIRE_FALSE(invert(scale<double>(1, 0, 1)).has_value());
+    }
+}
+
+SCENARIO("Bounds of a transformed sphere") {
+    THEN("the unit sphere fills the unit cube") {
+        REQUIRE(sphere_bounds(Matrix4{}) == Bounds{{-1, -1, -1}, {1, 1, 1}});
+    }
+    THEN("scaling and translation move the box") {
+        const Bounds bounds{sphere_bounds(Matrix4::from(multiply(translation<double>(1, 2, 3),
+                                                                 scale<double>(2, 1, 0.5))))};
+        REQUIRE(bounds == Bounds{{-1, 1, 2.5}, {3, 3, 3.5}});
+    }
+    THEN("rotation keeps the box tight") {
+        const Bounds bounds{sphere_bounds(Matrix4::from(multiply(rotation_z(std::numbers::pi / 4),
+                                                                 scale<double>(2, 1, 1))))};
+        // an ellipse with semi-axes 2 and 1 turned by 45 degrees reaches sqrt((4 + 1) / 2) along x and y
+        REQUIRE(utils::equal(bounds.max.x, std::sqrt(2.5f), 1e-5f));
+        REQUIRE(utils::equal(bounds.max.y, std::sqrt(2.5f), 1e-5f));
+        REQUIRE(utils::equal(bounds.max.z, 1, 1e-5f));
+    }
+}
+
+SCENARIO("Compiling and caching scenes") {
+    const auto directory{std::filesystem::temp_directory_path()};
+    const auto scene_path{directory / "raytracer_cached.scene"};
+    const auto cache_path{directory / "raytracer_cached.scene.cache"};
+    const std::string text{
+        "canvas 11 11 camera fov 1.5707963267948966 from 0 0 -5 to 0 0 0 up 0 1 0\n"
+        "light position -10 10 -10 intensity 1 1 1\n"
+        "sphere colour 0.8 1.0 0.6 diffuse 0.7 specular 0.2\n"
+        "sphere scale 0.5 0.5 0.5 translation 0 0 -1 shininess 20\n"
+        "sphere scale 0 1 1\n"
+    };
+    GIVEN("A compiled scene") {
+        const auto scene{parse_scene(text)};
+        REQUIRE(scene.has_value());
+        const CompiledScene compiled{CompiledScene::compile(scene.value())};
+        THEN("it holds inverse transforms, bounds and materials per object") {
+            REQUIRE(compiled.object_count() == 3);
+            REQUIRE(compiled.lights().size() == 1);
+            REQUIRE(compiled.lights()[0].position == Point(-10, 10, -10));
+            REQUIRE(compiled.inverse_transforms()[1] == Matrix4::from(inverse(scene->spheres[1].transform).value()));
+            REQUIRE(compiled.bounds()[1] == Bounds{{-0.5, -0.5, -1.5}, {0.5, 0.5, -0.5}});
+            REQUIRE(compiled.materials()[0] == scene->spheres[0].material);
+            REQUIRE(compiled.materials()[1].shininess == 20);
+            REQUIRE(compiled.header().scene_bounds == Bounds{{-1, -1, -1.5}, {1, 1, 1}});
+        }
+        THEN("a sphere with a singular transform has no extent") {
+            REQUIRE(compiled.bounds()[2].empty());
+        }
+        THEN("it renders like the scene it came from, to within the batched shading's tolerance") {
+            Canvas reference{scene->camera.hsize, scene->camera.vsize};
+            Canvas compiled_rays{scene->camera.hsize, scene->camera.vsize};
+            for (uint32_t y = 0; y < reference.height; ++y) {
+                for (uint32_t x = 0; x < reference.width; ++x) {
+                    const Ray ray{scene->camera.ray_for_pixel(x, y)};
+                    reference.write_pixel(x, y, colour_at(scene.value(), ray));
+                    compiled_rays.write_pixel(x, y, colour_at(compiled, ray));
+                }
+            }
+            const auto diff{compare(reference, render(compiled))};
+            REQUIRE(diff.has_value());
+            REQUIRE(diff->max_abs_error <= 1);
+            REQUIRE(render(compiled).storage == compiled_rays.storage);
+            REQUIRE(render(scene.value()).storage == render(compiled).storage);
+            REQUIRE(compiled.camera().inverse_transform == scene->camera.inverse_transform);
+        }
+        WHEN("it is written out and mapped back") {
+            REQUIRE(compiled.write(cache_path.string()).has_value());
+            const auto mapped{CompiledScene::map(cache_path.string())};
+            THEN("the mapped bytes are identical") {
+                REQUIRE(mapped.has_value());
+                REQUIRE(mapped->is_mapped());
+                REQUIRE(std::ranges::equal(mapped->bytes(), compiled.bytes()));
+                REQUIRE(mapped->materials()[0] == scene->spheres[0].material);
+            }
+            std::filesystem::remove(cache_path);
+        }
+        WHEN("several writers write it at the same time") {
+            std::vector<std::thread> writers;
+            std::atomic<int> failures{0};
+            for (int w = 0; w < 4; ++w) {
+                writers.emplace_back([&] {
+                    for (int i = 0; i < 10; ++i) {
+                        failures += compiled.write(cache_path.string()).has_value() ? 0 : 1;
+                    }
+                });
+            }
+            for (auto &writer: writers) {
+                writer.join();
+            }
+            THEN("every write succeeds, the cache is whole and no temporary file is left behind") {
+                REQUIRE(failures == 0);
+                const auto mapped{CompiledScene::map(cache_path.string())};
+                REQUIRE(mapped.has_value());
+                REQUIRE(std::ranges::equal(mapped->bytes(), compiled.bytes()));
+                const std::string prefix{cache_path.filename().string() + "."};
+                for (const auto &entry: std::filesystem::directory_iterator(cache_path.parent_path())) {
+                    REQUIRE_FALSE(entry.path().filename().string().starts_with(prefix));
+                }
+            }
+            std::filesystem::remove(cache_path);
+        }
+    }
+    GIVEN("Cache files that cannot be used") {
+        THEN("they are rejected") {
+            // long enough to hold a header, so it is the magic check that turns it away
+            std::ofstream(cache_path, std::ios::binary) << std::string(sizeof(CompiledSceneHeader) * 2, 'x');
+            REQUIRE(CompiledScene::map(cache_path.string()).error() == SceneCacheError::malformed);
+
+            const auto scene{parse_scene(text)};
+            const CompiledScene compiled{CompiledScene::compile(scene.value())};
+            std::vector<std::byte> bytes(compiled.bytes().begin(), compiled.bytes().end());
+            ++reinterpret_cast<CompiledSceneHeader *>(bytes.data())->version;
+            std::ofstream(cache_path, std::ios::binary).write(reinterpret_cast<const char *>(bytes.data()),
+                                                             static_cast<std::streamsize>(bytes.size()));
+            REQUIRE(CompiledScene::map(cache_path.string()).error() == SceneCacheError::version_mismatch);
+
+            std::ofstream(cache_path, std::ios::binary).write(reinterpret_cast<const char *>(compiled.bytes().data()),
+                                                             static_cast<std::streamsize>(bytes.size() - 4));
+            REQUIRE(CompiledScene::map(cache_path.string()).error() == SceneCacheError::malformed);
+            std::filesystem::remove(cache_path);
+        }
+    }
+    GIVEN("A scene file on disk") {
+        std::ofstream(scene_path) << text;
+        std::filesystem::remove(cache_path);
+        WHEN("it is loaded twice") {
+            const auto first{load_compiled_scene(scene_path.string(), cache_path.string())};
+            const auto second{load_compiled_scene(scene_path.string(), cache_path.string())};
+            THEN("the first compiles and writes the cache and the second maps it") {
+                REQUIRE(first.has_value());
+                REQUIRE_FALSE(first->is_mapped());
+                REQUIRE(std::filesystem::exists(cache_path));
+                REQUIRE(second.has_value());
+                REQUIRE(second->is_mapped());
+                REQUIRE(std::ranges::equal(first->bytes(), second->bytes()));
+            }
+        }
+        WHEN("the scene changes after it was cached") {
+            REQUIRE(load_compiled_scene(scene_path.string(), cache_path.string()).has_value());
+            std::ofstream(scene_path, std::ios::app) << "sphere translation 2 0 0\n";
+            const auto reloaded{load_compiled_scene(scene_path.string(), cache_path.string())};
+            THEN("the cache is rebuilt from the new contents") {
+                REQUIRE(reloaded.has_value());
+                REQUIRE_FALSE(reloaded->is_mapped());
+                REQUIRE(reloaded->object_count() == 4);
+                REQUIRE(load_compiled_scene(scene_path.string(), cache_path.string())->object_count() == 4);
+            }
+        }
+        WHEN("the scene has an error") {
+            std::ofstream(scene_path) << "sphere radius 1\n";
+            THEN("it is reported as usual") {
+                REQUIRE(load_compiled_scene(scene_path.string(), cache_path.string()).error().error ==
+                        SceneError::unknown_keyword);
+            }
+        }
+        std::filesystem::remove(cache_path);
+        std::filesystem::remove(scene_path);
+    }
+}
+
+SCENARIO("Casting shadows") {
+    // a small sphere between the light and the side of a larger one
+    const std::string text{
+        "canvas 21 21 camera fov 1.5707963267948966 from 0 0 -5 to 0 0 0 up 0 1 0\n"
+        "light position -10 0 0 intensity 1 1 1\n"
+        "sphere\n"
+        "sphere scale 0.8 0.8 0.8 translation -2.5 0 0\n"
+    };
+    GIVEN("A compiled scene") {
+        const auto scene{parse_scene(text)};
+        REQUIRE(scene.has_value());
+        const CompiledScene compiled{CompiledScene::compile(scene.value())};
+        const Point shadowed{-std::sqrt(0.5f), 0, -std::sqrt(0.5f)};
+        const Ray ray{Point{0, 0, -5}, Vector::normalize(shadowed - Point{0, 0, -5})};
+        THEN("a point in the shadow gets only the ambient light") {
+            const Colour colour{colour_at(compiled, ray, {.shadows = true})};
+            REQUIRE(utils::equal(colour.r, 0.1f));
+            REQUIRE(utils::equal(colour.g, 0.1f));
+            REQUIRE(utils::equal(colour.b, 0.1f));
+            REQUIRE(colour_at(compiled, ray).r > 0.5f);
+        }
+        THEN("the image with shadows is darker where they fall and exactly the same elsewhere") {
+            const Canvas lit{render(compiled)};
+            const Canvas shaded{render(compiled, {.tile_size = 4, .shadows = true})};
+            size_t darker{0};
+            for (uint32_t y = 0; y < lit.height; ++y) {
+                for (uint32_t x = 0; x < lit.width; ++x) {
+                    const auto with{shaded.pixel(x, y)};
+                    const auto without{lit.pixel(x, y)};
+                    REQUIRE(with[0] <= without[0]);
+                    darker += with[0] < without[0];
+                    const Colour expected{
+                        colour_at(compiled, compiled.camera().ray_for_pixel(x, y), {.shadows = true})
+                    };
+                    REQUIRE(with[0] == to_byte(expected.r));
+                }
+            }
+            REQUIRE(darker > 0);
+            REQUIRE(darker < lit.width * lit.height);
+        }
+    }
+}
+
+SCENARIO("Reflecting and refracting") {
+    // the centre of the image looks straight at a sphere at the origin
+    const std::string camera{
+        "canvas 11 11 camera fov 1.5707963267948966 from 0 0 -5 to 0 0 0 up 0 1 0\n"
+        "light position 0 0 -3 intensity 1 1 1\n"
+    };
+    // a sphere of nothing but the given attributes
+    const auto clear = [](const std::string &attributes) {
+        return "sphere colour 0 0 0 ambient 0 diffuse 0 specular 0 " + attributes + "\n";
+    };
+    const std::string red{"sphere colour 1 0 0 specular 0 translation 0 0 -10\n"};
+    const auto compile = [](const std::string &text) {
+        const auto scene{parse_scene(text)};
+        REQUIRE(scene.has_value());
+        return CompiledScene::compile(scene.value());
+    };
+    const Ray centre{Point{0, 0, -5}, Vector{0, 0, 1}};
+    GIVEN("A mirror with a red sphere behind the camera") {
+        const CompiledScene scene{compile(camera + clear("reflective 1") + red)};
+        THEN("the mirror shows the red sphere, with one bounce") {
+            RenderStats stats;
+            const Colour colour{colour_at(scene, centre, {.stats = &stats})};
+            REQUIRE(colour.r > 0.5f);
+            REQUIRE(colour.g == 0);
+            REQUIRE(stats.camera_rays == 1);
+            REQUIRE(stats.secondary_rays == 1);
+            REQUIRE(stats.average_depth() == 1);
+        }
+        THEN("without bounces it is black") {
+            REQUIRE(colour_at(scene, centre, {.max_depth = 0}) == Colour{0, 0, 0});
+        }
+    }
+    GIVEN("Glass that does not bend light in front of a red sphere") {
+        const CompiledScene glass{compile(camera + clear("transparency 1 refractive_index 1") +
+                                          "sphere colour 1 0 0 translation 0 0 3\n")};
+        const CompiledScene bare{compile(camera + "sphere colour 1 0 0 translation 0 0 3\n")};
+        THEN("the red sphere is seen through it as it is, two bounces on") {
+            RenderStats stats;
+            const Colour through{colour_at(glass, centre, {.stats = &stats})};
+            const Colour direct{colour_at(bare, centre)};
+            REQUIRE(utils::equal(through.r, direct.r, 1e-3f));
+            REQUIRE(stats.average_depth() == 2);
+        }
+    }
+    GIVEN("The camera inside a sphere that reflects half the light") {
+        const CompiledScene scene{compile(camera + clear("reflective 0.5 scale 10 10 10"))};
+        const auto average_depth = [&](const RenderOptions &options) {
+            RenderStats stats;
+            RenderOptions counted{options};
+            counted.stats = &stats;
+            static_cast<void>(render(scene, counted));
+            REQUIRE(stats.camera_rays == 121);
+            return stats.average_depth();
+        };
+        THEN("rays bounce until they reach the depth limit") {
+            REQUIRE(average_depth({.max_depth = 3}) == 3);
+        }
+        THEN("or until their weight is too low to show") {
+            // 0.5^9 is min_weight and 0.5^10 is below it
+            REQUIRE(average_depth({.max_depth = 20}) == 9);
+        }
+        THEN("Russian roulette lets some of them carry on") {
+            const double depth{average_depth({.max_depth = 20, .russian_roulette = true})};
+            REQUIRE(depth > 9);
+            REQUIRE(depth < 20);
+        }
+    }
+}
+
+SCENARIO("Anti-aliasing where it is needed") {
+    const std::string text{
+        "canvas 32 32 camera fov 1.0471975512 from 0 0 -5 to 0 0 0 up 0 1 0\n"
+        "light position -10 10 -10 intensity 1 1 1\n"
+        "sphere colour 1 0.2 1\n"
+    };
+    const auto scene{parse_scene(text)};
+    REQUIRE(scene.has_value());
+    const CompiledScene compiled{CompiledScene::compile(scene.value())};
+    const Canvas single{render(compiled)};
+    GIVEN("Up to sixteen samples a pixel") {
+        RenderStats stats;
+        const Canvas adaptive{render(compiled, {.max_samples = 16, .stats = &stats})};
+        THEN("only some pixels get more than one") {
+            REQUIRE(stats.pixels == 32 * 32);
+            REQUIRE(stats.average_samples() > 1);
+            REQUIRE(stats.average_samples() < 4);
+        }
+        THEN("pixels like their neighbours are as with one sample, and the edge of the sphere is softened") {
+            const auto same{[&](const uint32_t x, const uint32_t y, const uint32_t nx, const uint32_t ny) {
+                return nx >= 32 || ny >= 32 || std::ranges::equal(single.pixel(x, y), single.pixel(nx, ny));
+            }};
+            size_t softened{0};
+            for (uint32_t y = 0; y < 32; ++y) {
+                for (uint32_t x = 0; x < 32; ++x) {
+                    const bool changed{!std::ranges::equal(adaptive.pixel(x, y), single.pixel(x, y))};
+                    if (same(x, y, x - 1, y) && same(x, y, x + 1, y) && same(x, y, x, y - 1) &&
+                        same(x, y, x, y + 1)) {
+                        REQUIRE_FALSE(changed);
+                    }
+                    softened += changed;
+                }
+            }
+            REQUIRE(std::ranges::equal(adaptive.pixel(0, 0), single.pixel(0, 0)));
+            REQUIRE(softened > 0);
+            REQUIRE(render(compiled, {.max_samples = 16}).storage == adaptive.storage);
+        }
+    }
+    GIVEN("A contrast no two pixels reach") {
+        THEN("every pixel keeps its one sample") {
+            RenderStats stats;
+            REQUIRE(render(compiled, {.max_samples = 16, .contrast = 2, .stats = &stats}).storage == single.storage);
+            REQUIRE(stats.average_samples() == 1);
+        }
+    }
+}
+
+SCENARIO("Generating scenes") {
+    GIVEN("Generator options") {
+        const GeneratorOptions options{.count = 200, .seed = 42, .lights = 3};
+        THEN("the same seed always gives the same scene") {
+            REQUIRE(generate_scene_text(options) == generate_scene_text(options));
+        }
+        THEN("another seed gives another scene") {
+            GeneratorOptions reseeded{options};
+            reseeded.seed = 43;
+            REQUIRE(generate_scene_text(reseeded) != generate_scene_text(options));
+        }
+        THEN("the text parses into the requested number of spheres and lights") {
+            const Scene scene{generate_scene(options).value()};
+            REQUIRE(scene.spheres.size() == 200);
+            REQUIRE(scene.lights.size() == 3);
+            REQUIRE(scene.camera.hsize == options.width);
+            REQUIRE(scene.camera.vsize == options.height);
+        }
+        THEN("options that make no valid scene are reported rather than thrown") {
+            REQUIRE(generate_scene({.width = 0}).error().error == SceneError::invalid_number);
+            REQUIRE(generate_scene({.count = 10, .extent = 0}).error().error == SceneError::invalid_number);
+        }
+    }
+    GIVEN("Each distribution") {
+        const auto scene_bounds = [](const Distribution distribution) {
+            return CompiledScene::compile(generate_scene({.count = 500, .distribution = distribution}).value())
+                    .header().scene_bounds;
+        };
+        THEN("spheres stay near the cube they are placed in") {
+            for (const auto distribution: {Distribution::uniform, Distribution::clustered, Distribution::overlapping}) {
+                const Bounds bounds{scene_bounds(distribution)};
+                REQUIRE(bounds.min.x > -20);
+                REQUIRE(bounds.max.x < 20);
+                REQUIRE(bounds.min.z > -20);
+                REQUIRE(bounds.max.z < 20);
+            }
+        }
+        THEN("overlapping spheres all cover the origin") {
+            const CompiledScene compiled{CompiledScene::compile(generate_scene({
+                .count = 100, .distribution = Distribution::overlapping
+            }).value())};
+            for (const Bounds &bounds: compiled.bounds()) {
+                REQUIRE(bounds.min.x < 0);
+                REQUIRE(bounds.max.x > 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Instancing shared geometry") {
+    GIVEN("A table of materials") {
+        MaterialTable table;
+        const Material shiny{.shininess = 300};
+        THEN("equal materials share an entry") {
+            REQUIRE(table.add(Material{}) == 0);
+            REQUIRE(table.add(shiny) == 1);
+            REQUIRE(table.add(Material{}) == 0);
+            REQUIRE(table.add(Material{.ambient = -0.0f}) == table.add(Material{.ambient = 0.0f}));
+            REQUIRE(table.size() == 3);
+            REQUIRE(table[1] == shiny);
+        }
+    }
+    GIVEN("A generated scene whose spheres draw from a palette of five materials") {
+        const Scene scene{generate_scene({.count = 300, .seed = 4, .materials = 5, .width = 48, .height = 32}).value()};
+        const InstancedScene instanced{instance_scene(scene)};
+        THEN("every sphere is an instance of the one shared sphere with a material from the table") {
+            REQUIRE(instanced.instances.size() == 300);
+            REQUIRE(instanced.geometries.size() == 1);
+            REQUIRE(instanced.materials.size() == 5);
+            for (size_t i = 0; i < scene.spheres.size(); ++i) {
+                REQUIRE(instanced.instances[i].geometry == 0);
+                REQUIRE(instanced.materials[instanced.instances[i].material] == scene.spheres[i].material);
+            }
+        }
+        THEN("it compiles and renders like the same spheres with their transforms rounded to float") {
+            Scene rounded{.camera = scene.camera, .lights = scene.lights, .spheres = {}};
+            for (const Instance &instance: instanced.instances) {
+                const auto &m{instanced.transforms[instance.transform].m};
+                Sphere sphere{Sphere::make_sphere()};
+                sphere.set_transform(Container<double>{4, 4, std::vector<double>(m.begin(), m.end())});
+                sphere.material = instanced.materials[instance.material];
+                rounded.spheres.push_back(std::move(sphere));
+            }
+            const CompiledScene compiled{CompiledScene::compile(instanced)};
+            REQUIRE(compiled.header().material_count == 5);
+            REQUIRE(render(compiled).storage == render(CompiledScene::compile(rounded)).storage);
+        }
+    }
+    GIVEN("Two instances sharing one transform") {
+        InstancedScene instanced;
+        const uint32_t transform{instanced.add_transform(Matrix4::from(translation(0.0, 0.0, 5.0)))};
+        instanced.add_instance(0, transform, Material{});
+        instanced.add_instance(0, transform, Material{.colour = Colour{1, 0, 0}});
+        const CompiledScene compiled{CompiledScene::compile(instanced)};
+        THEN("each is its own object with its own material") {
+            REQUIRE(compiled.object_count() == 2);
+            REQUIRE(compiled.inverse_transforms()[0] == compiled.inverse_transforms()[1]);
+            REQUIRE(compiled.materials()[1].colour == Colour{1, 0, 0});
+        }
+    }
+}
@@ -0,0 +1,135 @@
+//
+// Created by chaku on 19/10/2026.
+//
+
+#include "ThreadPool.hpp"
+
+#include "catch2/catch_test_macros.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace raytracer;
+
+SCENARIO("A work-stealing deque") {
+    GIVEN("A deque owned by this thread") {
+        TaskDeque deque{2};
+        std::vector<Task> tasks(100);
+        WHEN("more tasks are pushed than it first has room for") {
+            for (auto &task: tasks) {
+                deque.push(&task);
+            }
+            THEN("the owner pops the newest and thieves steal the oldest") {
+                REQUIRE(deque.pop() == &tasks[99]);
+                REQUIRE(deque.steal() == &tasks[0]);
+                REQUIRE(deque.steal() == &tasks[1]);
+                REQUIRE(deque.pop() == &tasks[98]);
+            }
+        }
+        THEN("an empty deque gives nothing") {
+            REQUIRE(deque.empty());
+            REQUIRE(deque.pop() == nullptr);
+            REQUIRE(deque.steal() == nullptr);
+        }
+    }
+    GIVEN("An owner pushing and popping while other threads steal") {
+        constexpr size_t count{100000};
+        TaskDeque deque;
+        std::vector<Task> tasks(count);
+        std::vector<std::atomic<uint32_t>> taken(count);
+        std::atomic<bool> done{false};
+        const auto take = [&](const Task *task) {
+            taken[static_cast<size_t>(task - tasks.data())].fetch_add(1);
+        };
+        std::vector<std::jthread> thieves;
+        for (int i = 0; i < 3; ++i) {
+            thieves.emplace_back([&] {
+                while (!done.load()) {
+                    if (const Task *task{deque.steal()}) {
+                        take(task);
+                    }
+                }
+            });
+        }
+        for (size_t i = 0; i < count; ++i) {
+            deque.push(&tasks[i]);
+            if (i % 3 == 0) {
+                if (const Task *task{deque.pop()}) {
+                    take(task);
+                }
+            }
+        }
+        while (const Task *task{deque.pop()}) {
+            take(task);
+        }
+        done.store(true);
+        thieves.clear();
+        THEN("every task is taken exactly once") {
+            for (const auto &count_taken: taken) {
+                REQUIRE(count_taken.load() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Running work on a thread pool") {
+    for (const unsigned threads: {0u, 1u, 4u}) {
+        ThreadPool pool{{.threads = threads}};
+        GIVEN("A pool with " + std::to_string(threads) + " workers") {
+            THEN("parallel_for visits every index exactly once") {
+                std::vector<std::atomic<uint32_t>> visits(10007);
+                pool.parallel_for(0, visits.size(), 16, [&](const size_t begin, const size_t end) {
+                    REQUIRE(end - begin <= 16);
+                    for (size_t i = begin; i < end; ++i) {
+                        visits[i].fetch_add(1);
+                    }
+                });
+                for (const auto &visit: visits) {
+                    REQUIRE(visit.load() == 1);
+                }
+            }
+            THEN("a 2D range is covered by clipped tiles") {
+                std::vector<std::atomic<uint32_t>> cells(37 * 21);
+                pool.parallel_for(Range2D{0, 37, 0, 21}, 16, 8, [&](const Range2D &tile) {
+                    for (uint32_t y = tile.y_begin; y < tile.y_end; ++y) {
+                        for (uint32_t x = tile.x_begin; x < tile.x_end; ++x) {
+                            cells[y * 37 + x].fetch_add(1);
+                        }
+                    }
+                });
+                for (const auto &cell: cells) {
+                    REQUIRE(cell.load() == 1);
+                }
+            }
+            THEN("task groups nest and wait for everything they spawned") {
+                std::atomic<uint32_t> leaves{0};
+                TaskGroup outer{pool};
+                for (int i = 0; i < 8; ++i) {
+                    outer.run([&pool, &leaves] {
+                        pool.parallel_for(0, 100, 1, [&leaves](const size_t begin, const size_t end) {
+                            leaves.fetch_add(static_cast<uint32_t>(end - begin));
+                        });
+                    });
+                }
+                outer.wait();
+                REQUIRE(leaves.load() == 800);
+            }
+            THEN("an exception in a task is rethrown by wait") {
+                TaskGroup group{pool};
+                std::atomic<uint32_t> completed{0};
+                for (int i = 0; i < 10; ++i) {
+                    group.run([i, &completed] {
+                        if (i == 3) {
+                            throw std::runtime_error("task failed");
+                        }
+                        completed.fetch_add(1);
+                    });
+                }
+                REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+                REQUIRE(completed.load() == 9);
+            }
+        }
+    }
+}